@@ -0,0 +1,109 @@
+/*
+ *  contention.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Measures the throughput of one writer racing against a growing number of
+// reader threads all hammering the same channel, either acquiring samples or
+// copying them out.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t kPayloadSize{64U}; // NOLINT(*-magic-numbers)
+constexpr auto kDuration = 1s;
+
+void run(bool copy_out, std::size_t reader_count) {
+    const auto channel_name = std::format("contention-{}-{}", copy_out ? "copy" : "acquire", reader_count);
+
+    fastipc::Writer writer{channel_name, kPayloadSize};
+    std::vector<fastipc::Reader> readers;
+    readers.reserve(reader_count);
+    for (std::size_t i{0U}; i < reader_count; ++i)
+        readers.emplace_back(channel_name, kPayloadSize);
+
+    std::atomic_bool running{true};
+    std::atomic_uint64_t reads{0U};
+    std::uint64_t writes{0U};
+
+    std::vector<std::jthread> reader_threads;
+    reader_threads.reserve(reader_count);
+    for (auto& reader : readers) {
+        reader_threads.emplace_back([&] {
+            std::uint64_t local_reads{0U};
+            std::array<std::byte, kPayloadSize> copy{};
+            while (running.load(std::memory_order_relaxed)) {
+                if (copy_out) {
+                    static_cast<void>(reader.readLatest(copy.data(), copy.size()));
+                } else {
+                    const auto sample = reader.acquire();
+                    reader.release(sample);
+                }
+                ++local_reads;
+            }
+            reads.fetch_add(local_reads, std::memory_order_relaxed);
+        });
+    }
+
+    const std::jthread writer_thread{[&] {
+        while (running.load(std::memory_order_relaxed)) {
+            auto sample = writer.prepare();
+            *static_cast<std::uint64_t*>(sample.getPayload()) = writes;
+            writer.submit(sample);
+            ++writes;
+        }
+    }};
+
+    std::this_thread::sleep_for(kDuration);
+    running.store(false, std::memory_order_relaxed);
+    reader_threads.clear();
+
+    const auto seconds = std::chrono::duration<double>{kDuration}.count();
+    std::println("{:>7}: 1 writer, {:2} readers: {:.0f} writes/s, {:.0f} reads/s per reader",
+                 copy_out ? "copy" : "acquire", reader_count, static_cast<double>(writes) / seconds,
+                 static_cast<double>(reads.load()) / seconds / static_cast<double>(reader_count));
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::array<std::size_t, 3U> kReaderCounts{1U, 4U, 16U}; // NOLINT(*-magic-numbers)
+
+    for (const bool copy_out : {false, true}) {
+        for (const auto reader_count : kReaderCounts)
+            run(copy_out, reader_count);
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,341 @@
+/*
+ *  fastipc_bench.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// End-to-end benchmark suite, meant for catching regressions across runs.
+//
+// Starts an in-process tower, then forks one writer and several reader
+// processes per configuration, sweeping payload sizes, reader counts and CPU
+// placements. Every sample is acknowledged by all readers before the next is
+// submitted, measuring:
+//  - latency from right before submission until a reader acquired the sample,
+//  - the writer's cost of prepare() plus submit(), excluding the payload fill,
+//  - the readers' cost of acquire() plus release().
+//
+// Results are written as JSON to the file given as first argument, defaulting
+// to fastipc_bench.json, as the tower and clients log to stdout.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <new>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::array<std::size_t, 7U> kPayloadSizes{8U, 64U, 512U, 4096U, 65536U, 1048576U, 16777216U}; // NOLINT
+constexpr std::array<std::size_t, 3U> kReaderCounts{1U, 2U, 4U};                                       // NOLINT
+constexpr std::size_t kMaxIterations{5000U};                                                          // NOLINT
+constexpr std::size_t kMinIterations{64U};                                                            // NOLINT
+// Bytes written per configuration, bounding the iterations of large payloads
+constexpr std::size_t kBytesPerRun{std::size_t{256U} << 20U}; // NOLINT(*-magic-numbers)
+
+/// Log-linear histogram of durations in nanoseconds, in the spirit of HdrHistogram
+///
+/// Values are bucketed with a relative error below 1 / kSubBuckets.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Histogram final {
+    constexpr static std::size_t kSubBucketBits{5U};
+    constexpr static std::size_t kSubBuckets{std::size_t{1U} << kSubBucketBits};
+    constexpr static std::size_t kBucketCount{std::numeric_limits<std::uint64_t>::digits * kSubBuckets};
+
+    // Shared between processes, hence atomic
+    std::array<std::atomic_uint64_t, kBucketCount> counts{};
+
+    [[nodiscard]] constexpr static std::size_t indexOf(std::uint64_t value) noexcept {
+        if (value < kSubBuckets)
+            return value;
+        const auto shift = static_cast<std::size_t>(std::bit_width(value)) - 1U - kSubBucketBits;
+        return ((shift + 1U) * kSubBuckets) + ((value >> shift) - kSubBuckets);
+    }
+
+    /// Returns the highest value mapping to the given bucket
+    [[nodiscard]] constexpr static std::uint64_t valueOf(std::size_t index) noexcept {
+        if (index < kSubBuckets)
+            return index;
+        const auto shift = (index / kSubBuckets) - 1U;
+        const auto lowest = ((index % kSubBuckets) + kSubBuckets) << shift;
+        return lowest + (std::uint64_t{1U} << shift) - 1U;
+    }
+
+    void record(std::chrono::nanoseconds duration) noexcept {
+        const auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+        counts[indexOf(value)].fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept {
+        std::uint64_t total{0U};
+        for (const auto& count : counts)
+            total += count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /// Returns the value below which the given fraction of the recorded values lie
+    [[nodiscard]] std::uint64_t percentile(double fraction) const noexcept {
+        const auto total = count();
+        if (total == 0U)
+            return 0U;
+        const auto rank = std::min(static_cast<std::uint64_t>(fraction * static_cast<double>(total)), total - 1U);
+        std::uint64_t seen{0U};
+        for (std::size_t i{0U}; i < kBucketCount; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen > rank)
+                return valueOf(i);
+        }
+        return 0U;
+    }
+
+    [[nodiscard]] std::string toJson() const {
+        return std::format(R"({{"count": {}, "p50": {}, "p99": {}, "p99_9": {}, "max": {}}})", count(),
+                           percentile(0.5), percentile(0.99), percentile(0.999), // NOLINT(*-magic-numbers)
+                           percentile(1.0));
+    }
+};
+
+/// Coordination and results of one configuration, shared with the forked processes
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct SharedState final {
+    std::atomic_size_t ready_readers{0U};
+    std::atomic_size_t acks{0U};
+    Histogram latency;
+    Histogram writer_cost;
+    Histogram reader_cost;
+};
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Placement final {
+    std::string_view name;
+    int writer_cpu;
+    // Assigned to readers round-robin
+    std::vector<int> reader_cpus;
+};
+
+void pinTo(int cpu) {
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    static_cast<void>(::sched_setaffinity(0, sizeof(set), &set));
+}
+
+[[nodiscard]] std::optional<int> readTopology(int cpu, std::string_view attribute) {
+    std::ifstream file{std::format("/sys/devices/system/cpu/cpu{}/topology/{}", cpu, attribute)};
+    int value{0};
+    if (!(file >> value))
+        return std::nullopt;
+    return value;
+}
+
+/// Lists the placements this machine allows for, skipping those it lacks the CPUs for
+[[nodiscard]] std::vector<Placement> placements() {
+    ::cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    static_cast<void>(::sched_getaffinity(0, sizeof(allowed), &allowed));
+
+    std::vector<int> cpus;
+    for (int cpu{0}; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed))
+            cpus.push_back(cpu);
+    }
+
+    const auto writer_cpu = cpus.front();
+    const auto writer_core = readTopology(writer_cpu, "core_id");
+    const auto writer_package = readTopology(writer_cpu, "physical_package_id");
+
+    std::vector<int> other_cores;
+    std::vector<int> other_packages;
+    for (const auto cpu : cpus) {
+        const auto package = readTopology(cpu, "physical_package_id");
+        if (package != writer_package)
+            other_packages.push_back(cpu);
+        else if (readTopology(cpu, "core_id") != writer_core)
+            other_cores.push_back(cpu);
+    }
+
+    std::vector<Placement> result{{.name = "same-core", .writer_cpu = writer_cpu, .reader_cpus = {writer_cpu}}};
+    if (!other_cores.empty())
+        result.push_back({.name = "cross-core", .writer_cpu = writer_cpu, .reader_cpus = other_cores});
+    if (!other_packages.empty())
+        result.push_back({.name = "cross-socket", .writer_cpu = writer_cpu, .reader_cpus = other_packages});
+    return result;
+}
+
+[[nodiscard]] std::uint64_t nowNs() noexcept {
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+/// Waits until the predicate holds, leaving the CPU to others in case we share it
+void spinUntil(const std::function<bool()>& predicate) {
+    while (!predicate())
+        std::this_thread::yield();
+}
+
+/// Runs the given function in a child process pinned to the given CPU
+[[nodiscard]] ::pid_t spawn(int cpu, const std::function<void()>& function) {
+    const auto pid = ::fork();
+    if (pid != 0)
+        return pid;
+
+    pinTo(cpu);
+    function();
+    // Leave the parent's objects, tower included, alone.
+    ::_exit(0);
+}
+
+void runReader(SharedState& state, const std::string& channel_name, std::size_t payload_size, std::size_t iterations) {
+    fastipc::Reader reader{channel_name, payload_size};
+    state.ready_readers.fetch_add(1U, std::memory_order_release);
+
+    std::uint64_t last_sequence_id{0U};
+    for (std::size_t i{0U}; i < iterations; ++i) {
+        spinUntil([&] { return reader.hasNewData(last_sequence_id); });
+
+        const auto acquire_start = std::chrono::steady_clock::now();
+        const auto sample = reader.acquire();
+        const auto acquired = std::chrono::steady_clock::now();
+
+        std::uint64_t submitted{0U};
+        std::memcpy(&submitted, sample.getPayload(), sizeof(submitted));
+        last_sequence_id = sample.getSequenceId();
+
+        const auto release_start = std::chrono::steady_clock::now();
+        reader.release(sample);
+        const auto released = std::chrono::steady_clock::now();
+
+        state.latency.record(std::chrono::nanoseconds{
+            static_cast<std::int64_t>(static_cast<std::uint64_t>(acquired.time_since_epoch().count()) - submitted)});
+        state.reader_cost.record((acquired - acquire_start) + (released - release_start));
+        state.acks.fetch_add(1U, std::memory_order_release);
+    }
+}
+
+void runWriter(SharedState& state, const std::string& channel_name, std::size_t payload_size, std::size_t iterations,
+               std::size_t reader_count) {
+    fastipc::Writer writer{channel_name, payload_size, {.slot_count = kReaderCounts.back() + 4U}};
+    spinUntil([&] { return state.ready_readers.load(std::memory_order_acquire) == reader_count; });
+
+    for (std::size_t i{0U}; i < iterations; ++i) {
+        const auto prepare_start = std::chrono::steady_clock::now();
+        auto sample = writer.prepare();
+        const auto prepared = std::chrono::steady_clock::now();
+
+        std::memset(sample.getPayload(), static_cast<int>(i), payload_size);
+        const auto submitted = nowNs();
+        std::memcpy(sample.getPayload(), &submitted, sizeof(submitted));
+
+        const auto submit_start = std::chrono::steady_clock::now();
+        writer.submit(sample);
+        const auto submit_end = std::chrono::steady_clock::now();
+
+        state.writer_cost.record((prepared - prepare_start) + (submit_end - submit_start));
+        spinUntil([&] { return state.acks.load(std::memory_order_acquire) == reader_count * (i + 1U); });
+    }
+}
+
+[[nodiscard]] std::string runConfiguration(SharedState& state, const Placement& placement, std::size_t payload_size,
+                                           std::size_t reader_count) {
+    ::new (&state) SharedState{};
+
+    // Configurations of a payload size share a channel name, every one asking for the same settings: the tower frees
+    // the channel once the previous configuration is gone, and whichever configuration still finds it reuses it as is.
+    const auto channel_name = std::format("fastipc-bench-{}", payload_size);
+    const auto iterations = std::clamp(kBytesPerRun / payload_size, kMinIterations, kMaxIterations);
+
+    std::vector<::pid_t> children;
+    for (std::size_t i{0U}; i < reader_count; ++i) {
+        const auto cpu = placement.reader_cpus[i % placement.reader_cpus.size()];
+        children.push_back(spawn(cpu, [&] { runReader(state, channel_name, payload_size, iterations); }));
+    }
+    children.push_back(spawn(placement.writer_cpu,
+                             [&] { runWriter(state, channel_name, payload_size, iterations, reader_count); }));
+
+    bool succeeded{true};
+    for (const auto child : children) {
+        int status{0};
+        static_cast<void>(::waitpid(child, &status, 0));
+        succeeded = succeeded && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::println(stderr, "{:>12} {:>9}B x {} readers: latency p50 {}ns, p99 {}ns{}", placement.name, payload_size,
+                 reader_count, state.latency.percentile(0.5), state.latency.percentile(0.99), // NOLINT(*-magic-numbers)
+                 succeeded ? "" : " (FAILED)");
+
+    return std::format(R"({{"placement": "{}", "payload_size": {}, "readers": {}, "iterations": {}, "succeeded": {}, )"
+                       R"("latency_ns": {}, "writer_prepare_submit_ns": {}, "reader_acquire_release_ns": {}}})",
+                       placement.name, payload_size, reader_count, iterations, succeeded, state.latency.toJson(),
+                       state.writer_cost.toJson(), state.reader_cost.toJson());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    // NOLINTNEXTLINE(misc-const-correctness) placement-new requires non-const pointee type
+    void* const shared =
+        ::mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        std::println(stderr, "failed to map shared state: {}", std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    auto& state = *static_cast<SharedState*>(shared);
+
+    std::vector<std::string> runs;
+    for (const auto& placement : placements()) {
+        for (const auto payload_size : kPayloadSizes) {
+            for (const auto reader_count : kReaderCounts)
+                runs.push_back(runConfiguration(state, placement, payload_size, reader_count));
+        }
+    }
+
+    std::string json = std::format(R"({{"cpus": {}, "runs": [)", std::thread::hardware_concurrency());
+    for (std::size_t i{0U}; i < runs.size(); ++i)
+        json += std::format("{}\n  {}", i == 0U ? "" : ",", runs[i]);
+    json += "\n]}\n";
+
+    const auto* const output_path = argc > 1 ? argv[1] : "fastipc_bench.json"; // NOLINT(*-pointer-arithmetic)
+    std::ofstream{output_path} << json;
+    std::println(stderr, "results written to {}", output_path);
+
+    ::munmap(shared, sizeof(SharedState));
+    tower.shutdown();
+}
@@ -0,0 +1,122 @@
+/*
+ *  numa.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Measures the bandwidth of a writer filling multi-MiB samples of channels
+// bound to node 0, to the writer's own node, or left to first touch by the
+// tower, with the writer pinned to the CPUs of node 0. On multi-node machines,
+// channels bound to the last node show the cost of writing across sockets.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string>
+#include <thread>
+
+#include <sched.h>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t kPayloadSize{std::size_t{8U} << 20U}; // NOLINT(*-magic-numbers)
+constexpr auto kDuration = 1s;
+
+/// Highest NUMA node of the machine, zero on single-node ones
+[[nodiscard]] std::int32_t lastNode() {
+    std::int32_t last{0};
+    // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+    for (const auto& entry : std::filesystem::directory_iterator{"/sys/devices/system/node"}) {
+        const auto name = entry.path().filename().string();
+        if (name.starts_with("node"))
+            last = std::max(last, std::stoi(name.substr(4U)));
+    }
+    return last;
+}
+
+/// Pins the calling thread to the CPUs of node 0, for the writer to stay on a known node
+void pinToNodeZero() {
+    std::ifstream cpulist{"/sys/devices/system/node/node0/cpulist"};
+    std::string ranges;
+    std::getline(cpulist, ranges);
+
+    ::cpu_set_t cpus{};
+    CPU_ZERO(&cpus);
+    // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+    for (std::size_t begin{0U}; begin < ranges.size();) {
+        const auto end = std::min(ranges.find(',', begin), ranges.size());
+        const auto range = ranges.substr(begin, end - begin);
+        const auto dash = range.find('-');
+        const auto first = std::stoi(range.substr(0U, dash));
+        const auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1U));
+        // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+        for (auto cpu = first; cpu <= last; ++cpu)
+            CPU_SET(cpu, &cpus);
+        begin = end + 1U;
+    }
+    static_cast<void>(::sched_setaffinity(0, sizeof(cpus), &cpus));
+}
+
+void run(std::string_view label, std::int32_t numa_node) {
+    const auto channel_name = std::format("numa-{}", label);
+    fastipc::Writer writer{channel_name, kPayloadSize, {.prefault = true, .numa_node = numa_node}};
+
+    std::uint64_t bytes{0U};
+    const auto start = std::chrono::steady_clock::now();
+    // NOLINTNEXTLINE(altera-unroll-loops) Benchmark loop
+    while (std::chrono::steady_clock::now() - start < kDuration) {
+        auto sample = writer.prepare();
+        std::memset(sample.getPayload(), static_cast<int>(bytes & 0xFFU), kPayloadSize); // NOLINT(*-magic-numbers)
+        writer.submit(sample);
+        bytes += kPayloadSize;
+    }
+    const auto seconds = std::chrono::duration<double>{std::chrono::steady_clock::now() - start}.count();
+
+    std::string placement{"unknown"};
+    if (const auto snapshots = fastipc::inspectTower("fastipcd"); snapshots.has_value()) {
+        const auto channel = std::ranges::find(*snapshots, channel_name, &fastipc::ChannelSnapshot::name);
+        if (channel != snapshots->end())
+            placement = std::format("bound to {}, resident on {}", channel->numa_node, channel->resident_node);
+    }
+    std::println("{:>8}: {:.2f} GiB/s ({})", label, static_cast<double>(bytes) / seconds / (1U << 30U), placement);
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    pinToNodeZero();
+    run("unbound", fastipc::kNoNumaNode);
+    run("node 0", 0);
+    run("local", fastipc::kLocalNumaNode);
+    if (const auto last = lastNode(); last != 0)
+        run(std::format("node {}", last), last);
+
+    tower.shutdown();
+}
@@ -0,0 +1,130 @@
+/*
+ *  page_backing.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Compares channel memory backings on a large channel: the latency of the
+// first write to every slot right after connecting, then the steady-state
+// cost and data TLB misses of writing and copying out whole samples.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "io/fd.hxx"
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::size_t kPayloadSize{std::size_t{256U} << 10U}; // NOLINT(*-magic-numbers)
+constexpr std::size_t kSlotCount{16U};                         // NOLINT(*-magic-numbers)
+constexpr std::size_t kSteadyIterations{2000U};                // NOLINT(*-magic-numbers)
+
+/// Opens a counter of the calling thread's data TLB read misses, if the PMU is accessible at all
+[[nodiscard]] fastipc::io::Fd openTlbMissCounter() {
+    ::perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8U) | // NOLINT(*-magic-numbers)
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);                        // NOLINT(*-magic-numbers)
+    attr.disabled = 1U;
+    attr.exclude_kernel = 1U;
+    attr.exclude_hv = 1U;
+
+    return fastipc::io::Fd{static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0))};
+}
+
+void run(std::string_view name, const fastipc::ChannelOptions& options) {
+    const auto channel_name = std::string{"page-backing-"} + std::string{name};
+    auto channel_options = options;
+    channel_options.slot_count = kSlotCount;
+
+    fastipc::Writer writer{channel_name, kPayloadSize, channel_options};
+    fastipc::Reader reader{channel_name, kPayloadSize, channel_options};
+
+    // First touch of every slot but the initial latest one, as right after startup
+    std::chrono::nanoseconds first_touch_total{};
+    std::chrono::nanoseconds first_touch_max{};
+    for (std::size_t i{1U}; i < kSlotCount; ++i) {
+        auto sample = writer.prepare();
+        const auto start = std::chrono::steady_clock::now();
+        std::memset(sample.getPayload(), static_cast<int>(i), kPayloadSize);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        writer.submit(sample);
+
+        first_touch_total += elapsed;
+        first_touch_max = std::max<std::chrono::nanoseconds>(first_touch_max, elapsed);
+    }
+
+    const auto counter = openTlbMissCounter();
+    if (counter.fd() >= 0) {
+        static_cast<void>(::ioctl(counter.fd(), PERF_EVENT_IOC_RESET, 0));
+        static_cast<void>(::ioctl(counter.fd(), PERF_EVENT_IOC_ENABLE, 0));
+    }
+
+    std::vector<std::byte> copy(kPayloadSize);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i{0U}; i < kSteadyIterations; ++i) {
+        auto sample = writer.prepare();
+        std::memset(sample.getPayload(), static_cast<int>(i), kPayloadSize);
+        writer.submit(sample);
+        static_cast<void>(reader.readLatest(copy.data(), copy.size()));
+    }
+    const auto steady = (std::chrono::steady_clock::now() - start) / kSteadyIterations;
+
+    std::optional<std::uint64_t> tlb_misses;
+    if (counter.fd() >= 0) {
+        static_cast<void>(::ioctl(counter.fd(), PERF_EVENT_IOC_DISABLE, 0));
+        std::uint64_t count{0U};
+        if (::read(counter.fd(), &count, sizeof(count)) == sizeof(count))
+            tlb_misses = count / kSteadyIterations;
+    }
+
+    std::println(stderr, "{:>24}: first touch total {}us, max {}us; steady {}ns/sample, {} dTLB read misses/sample",
+                 name, std::chrono::duration_cast<std::chrono::microseconds>(first_touch_total).count(),
+                 std::chrono::duration_cast<std::chrono::microseconds>(first_touch_max).count(), steady.count(),
+                 tlb_misses.has_value() ? std::to_string(*tlb_misses) : std::string{"n/a"});
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    run("regular", {});
+    run("regular+prefault", {.prefault = true});
+    run("thp+prefault", {.page_backing = fastipc::PageBacking::TransparentHuge, .prefault = true});
+    run("hugetlb+prefault+lock",
+        {.page_backing = fastipc::PageBacking::HugeTlb, .prefault = true, .lock_memory = true});
+
+    tower.shutdown();
+}
@@ -0,0 +1,90 @@
+/*
+ *  rpc.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Measures the round-trip latency of RPC calls served by another thread, the
+// server either spinning on its requests or sleeping until some come in.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t kPayloadSize{64U};   // NOLINT(*-magic-numbers)
+constexpr std::size_t kCallCount{100000U}; // NOLINT(*-magic-numbers)
+
+void run(bool spinning) {
+    const auto channel_name = std::format("rpc-{}", spinning ? "spin" : "wait");
+
+    fastipc::RpcClient client{channel_name, kPayloadSize};
+    fastipc::RpcServer server{channel_name, kPayloadSize};
+
+    std::atomic_bool running{true};
+    const std::jthread server_thread{[&] {
+        while (running.load(std::memory_order_relaxed)) {
+            if (!spinning && !server.waitForRequests(10ms))
+                continue;
+            while (auto call = server.tryAccept())
+                server.reply(*call, call->getSize());
+        }
+    }};
+
+    std::vector<std::chrono::nanoseconds> round_trips;
+    round_trips.reserve(kCallCount);
+    for (std::size_t i{0U}; i < kCallCount; ++i) {
+        const auto call = client.prepare();
+        std::memcpy(call.getPayload(), &i, sizeof(i));
+
+        const auto start = std::chrono::steady_clock::now();
+        static_cast<void>(client.call(call, kPayloadSize, 1s));
+        round_trips.push_back(std::chrono::steady_clock::now() - start);
+        client.release(call);
+    }
+    running.store(false, std::memory_order_relaxed);
+
+    std::ranges::sort(round_trips);
+    const auto percentile = [&](std::size_t permille) {
+        return round_trips[(round_trips.size() - 1U) * permille / 1000U]; // NOLINT(*-magic-numbers)
+    };
+    std::println("{:>5} server: p50 {}, p99 {}, p99.9 {}, max {}", spinning ? "spin" : "wait", percentile(500U),
+                 percentile(990U), percentile(999U), round_trips.back()); // NOLINT(*-magic-numbers)
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    for (const bool spinning : {true, false})
+        run(spinning);
+
+    tower.shutdown();
+}
@@ -0,0 +1,105 @@
+/*
+ *  tower_startup.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Simulates a fleet booting at once: many clients concurrently opening
+// several channels each against a single tower.
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::size_t kClientCount{1000U};     // NOLINT(*-magic-numbers)
+constexpr std::size_t kChannelsPerClient{10U}; // NOLINT(*-magic-numbers)
+constexpr std::size_t kChannelCount{100U};     // NOLINT(*-magic-numbers)
+constexpr std::size_t kPayloadSize{64U};       // NOLINT(*-magic-numbers)
+
+/// Has every client open its channels at once, either one connection per
+/// channel or all through a single session
+void runFleet(bool batched) {
+    std::vector<std::chrono::nanoseconds> startup_times(kClientCount);
+    std::vector<std::vector<fastipc::Reader>> readers(kClientCount);
+    std::barrier start_line{kClientCount + 1U};
+
+    std::vector<std::jthread> clients;
+    clients.reserve(kClientCount);
+    for (std::size_t client{0U}; client < kClientCount; ++client) {
+        clients.emplace_back([&, client] {
+            std::vector<std::string> names;
+            std::vector<fastipc::ChannelRequest> requests;
+            names.reserve(kChannelsPerClient);
+            for (std::size_t i{0U}; i < kChannelsPerClient; ++i) {
+                names.push_back(std::format("startup-{}", ((client * kChannelsPerClient) + i) % kChannelCount));
+                requests.push_back({.channel_name = names.back(), .max_payload_size = kPayloadSize});
+            }
+            start_line.arrive_and_wait();
+
+            const auto start = std::chrono::steady_clock::now();
+            if (batched) {
+                fastipc::Session session;
+                readers[client] = session.openReaders(requests);
+            } else {
+                readers[client].reserve(kChannelsPerClient);
+                for (const auto& request : requests)
+                    readers[client].emplace_back(request.channel_name, request.max_payload_size);
+            }
+            startup_times[client] = std::chrono::steady_clock::now() - start;
+        });
+    }
+
+    start_line.arrive_and_wait();
+    const auto start = std::chrono::steady_clock::now();
+    clients.clear();
+    const auto total = std::chrono::steady_clock::now() - start;
+
+    std::ranges::sort(startup_times);
+
+    const auto percentile_us = [&](std::size_t p) {
+        const auto time = startup_times[(startup_times.size() - 1U) * p / 100U]; // NOLINT(*-magic-numbers)
+        return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    };
+    const auto p50 = percentile_us(50U); // NOLINT(*-magic-numbers)
+    const auto p99 = percentile_us(99U); // NOLINT(*-magic-numbers)
+    std::println(stderr, "{} clients x {} channels ({}): total {}us, client startup p50 {}us, p99 {}us, max {}us",
+                 kClientCount, kChannelsPerClient, (batched ? "session" : "one connection per channel"),
+                 std::chrono::duration_cast<std::chrono::microseconds>(total).count(), p50, p99,
+                 std::chrono::duration_cast<std::chrono::microseconds>(startup_times.back()).count());
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    runFleet(false);
+    runFleet(true);
+
+    tower.shutdown();
+}
@@ -0,0 +1,92 @@
+/*
+ *  writers.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Measures the submission throughput of 1 to 8 writers sharing a channel,
+// either all claiming slots from the same lane or each from a lane of its own.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t kPayloadSize{64U}; // NOLINT(*-magic-numbers)
+constexpr auto kDuration = 1s;
+
+void run(std::size_t writer_count, bool laned) {
+    const auto channel_name = std::format("writers-{}-{}", writer_count, laned ? "laned" : "shared");
+    const fastipc::ChannelOptions options{.writer_lanes = laned ? writer_count : 1U};
+
+    std::vector<fastipc::Writer> writers;
+    writers.reserve(writer_count);
+    for (std::size_t i{0U}; i < writer_count; ++i)
+        writers.emplace_back(channel_name, kPayloadSize, options);
+
+    std::atomic_bool running{true};
+    std::atomic_uint64_t submits{0U};
+    std::vector<std::jthread> writer_threads;
+    writer_threads.reserve(writer_count);
+    for (auto& writer : writers) {
+        writer_threads.emplace_back([&] {
+            std::uint64_t local_submits{0U};
+            while (running.load(std::memory_order_relaxed)) {
+                auto sample = writer.prepare();
+                *static_cast<std::uint64_t*>(sample.getPayload()) = local_submits;
+                writer.submit(sample);
+                ++local_submits;
+            }
+            submits.fetch_add(local_submits, std::memory_order_relaxed);
+        });
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    running.store(false, std::memory_order_relaxed);
+    writer_threads.clear();
+
+    const auto seconds = std::chrono::duration<double>{kDuration}.count();
+    std::println("{:>6}: {} writer(s): {:.0f} submits/s in total, {:.0f} per writer", laned ? "laned" : "shared",
+                 writer_count, static_cast<double>(submits.load()) / seconds,
+                 static_cast<double>(submits.load()) / seconds / static_cast<double>(writer_count));
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::array<std::size_t, 4U> kWriterCounts{1U, 2U, 4U, 8U}; // NOLINT(*-magic-numbers)
+
+    for (const bool laned : {false, true}) {
+        for (const auto writer_count : kWriterCounts)
+            run(writer_count, laned);
+    }
+
+    tower.shutdown();
+}
@@ -21,29 +21,169 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <optional>
 #include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace fastipc {
 
+/// Guaranteed alignment of sample payloads
+constexpr std::size_t kPayloadAlignment{64U};
+
+/// Granularity at which changes to payloads are tracked
+constexpr std::size_t kDirtyBlockSize{4096U};
+
+/// Range of payload bytes
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ByteRange final {
+    std::size_t offset;
+    std::size_t size;
+};
+
+/// Backing of channel memory
+enum class PageBacking : std::uint8_t {
+    /// Regular pages
+    Default = 0,
+    /// Transparent huge pages, only granted if enabled for shared memory by the system
+    /// (see /sys/kernel/mm/transparent_hugepage/shmem_enabled)
+    TransparentHuge = 1,
+    /// Huge pages from the hugetlb pool, falling back to regular pages if the pool is exhausted
+    HugeTlb = 2,
+};
+
+/// Clock timestamping the samples of a channel
+enum class ChannelClock : std::uint8_t {
+    /// Wall clock, comparable across hosts yet subject to adjustments
+    System = 0,
+    /// Monotonic clock, comparable with std::chrono::steady_clock
+    Steady = 1,
+    /// Time stamp counter, calibrated against the steady clock to be comparable with it at a fraction of the cost of
+    /// reading it; falls back to the steady clock unless the counter is invariant and the system's clock source
+    Tsc = 2,
+};
+
+/// NUMA node standing for no node in particular, leaving channel memory wherever it gets first touched
+constexpr std::int32_t kNoNumaNode{-1};
+
+/// NUMA node standing for the node of the CPU running the thread which opens a channel
+constexpr std::int32_t kLocalNumaNode{-2};
+
+/// Channel settings
+///
+/// @note Channel creation settings are only honored by whichever Reader or Writer ends up creating the channel.
+struct ChannelOptions final {
+    /// Number of sample slots backing the channel; it must cover the samples concurrently held by readers, plus the
+    /// latest sample and the one being prepared by each writer (creation setting)
+    std::size_t slot_count{64U}; // NOLINT(*-magic-numbers)
+
+    /// Whether a Writer keeps a slot in reserve for its next sample, making @a Writer::prepare O(1) and wait-free as
+    /// long as the channel has a free slot to refill the reserve with on submission; this costs one extra slot per
+    /// writer (writer setting)
+    bool reserve_spare_slot{false};
+
+    /// Number of newest samples kept from being recycled, for readers to acquire them together through
+    /// @a Reader::acquireHistory; all but the latest take up a slot on top of those counted by @a slot_count, and the
+    /// tower refuses depths beyond 2^24 - 1 (creation setting)
+    std::size_t history_depth{1U};
+
+    /// Backing of the channel memory; huge pages save TLB misses on large channels (creation setting)
+    PageBacking page_backing{PageBacking::Default};
+
+    /// Whether to fault in the whole channel memory when connecting, rather than on first touch of every page
+    /// (endpoint setting)
+    bool prefault{false};
+
+    /// Whether to lock the channel memory in RAM when connecting, which only warns if the memlock limit does not allow
+    /// it (endpoint setting)
+    bool lock_memory{false};
+
+    /// Clock timestamping samples on submission (creation setting)
+    ChannelClock clock{ChannelClock::System};
+
+    /// Number of newest sequence ids whose prepare, submit and first acquisition times get traced in a ring shared
+    /// by every endpoint, for inspection to report latency distributions from; zero disables tracing, and the tower
+    /// refuses depths beyond 65536 (creation setting)
+    std::size_t trace_depth{0U};
+
+    /// Whether to attach to the channel directly through its file in the registry of the default tower, creating it
+    /// there if needed, rather than asking the tower for it; this works without any tower running and along with
+    /// endpoints opened through one, but channels created this way use regular or transparent huge pages only, and
+    /// stay in the registry until a tower frees them; notification descriptors are only shared with endpoints of other
+    /// processes through a listening tower, or by taking them from those processes if allowed to trace them, failing
+    /// which notifications do not wake endpoints across processes and an error gets logged (endpoint setting,
+    /// ignored by sessions)
+    bool direct_attach{false};
+
+    /// NUMA node to preferably allocate the channel memory on, either a node number, @a kLocalNumaNode, or
+    /// @a kNoNumaNode; the first writer to ask for a node gets the channel bound to it, and what pages are already
+    /// allocated migrated as far as the kernel allows (writer setting)
+    std::int32_t numa_node{kNoNumaNode};
+
+    /// Number of lanes the slots get split into, each writer claiming slots from a lane of its own first, so that
+    /// concurrent writers do not contend on the same ones nor on their occupancy hints; lanes are capped to 64, and
+    /// lanes beyond the slot count are left empty (creation setting, ignored by queues)
+    std::size_t writer_lanes{1U};
+
+    /// Number of endpoints whose stats and held samples get tracked, each costing 4 bytes per slot; endpoints beyond
+    /// it go without stats, and what they hold is never given back should their process die; capped to 64 (creation
+    /// setting)
+    std::size_t endpoint_records{16U}; // NOLINT(*-magic-numbers)
+};
+
+/// Channel to open as part of a batch
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ChannelRequest final {
+    std::string_view channel_name;
+    std::size_t max_payload_size;
+    ChannelOptions options{};
+};
+
+/// Tower's answer to a request for a channel
+enum class OpenStatus : std::uint8_t {
+    Ok = 0,
+    /// The channel has a memory layout of another library version
+    LayoutMismatch = 1,
+    /// The channel has another maximum payload size
+    PayloadSizeMismatch = 2,
+    /// The tower speaks another protocol version
+    ProtocolMismatch = 3,
+    /// The channel is of another kind, such as a queue or an RPC channel
+    KindMismatch = 4,
+    /// The request is out of bounds, or beyond the memory or descriptors the tower can get
+    ResourceExhausted = 5,
+};
+
+class Session;
+
 /// Channel reader
 class Reader final {
   public:
     class Sample final {
       public:
         [[nodiscard]] auto getSequenceId() const -> std::uint64_t;
+        /// Submission time, converted from the channel clock unless it is the system clock
         [[nodiscard]] auto getTimestamp() const -> std::chrono::system_clock::time_point;
+        /// Submission time on the channel clock, as elapsed since its epoch
+        [[nodiscard]] auto getClockTimestamp() const -> std::chrono::nanoseconds;
         [[nodiscard]] auto getPayload() const -> const void*;
+        /// Number of payload bytes the writer submitted
+        [[nodiscard]] auto getSize() const -> std::size_t;
 
       private:
         friend class Reader;
-        explicit Sample(void* shadow) noexcept : m_shadow{shadow} {}
+        explicit Sample(void* shadow, std::size_t index, const void* channel) noexcept
+            : m_shadow{shadow}, m_index{index}, m_channel{channel} {}
         void* m_shadow;
+        std::size_t m_index;
+        const void* m_channel;
     };
 
     /// Creates a Reader for the given channel, validating the expected payload
     /// size
-    Reader(std::string_view channel_name, std::size_t max_payload_size);
+    Reader(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
 
     Reader(const Reader&) = delete;
     Reader(Reader&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
@@ -58,15 +198,77 @@ class Reader final {
     /// Indicates whether a sample with a greater sequence id is available
     [[nodiscard]] auto hasNewData(std::uint64_t sequence_id) const -> bool;
 
+    /// Returns a descriptor which writers signal on submission while
+    /// notifications are armed, for integration with event loops
+    ///
+    /// @attention The descriptor is shared by every reader of the channel and is
+    ///            never drained: watch it edge-triggered (e.g. EPOLLIN | EPOLLET),
+    ///            never read from it, and never close it.
+    [[nodiscard]] auto getNotificationFd() const -> int;
+
+    /// Asks writers to signal the notification descriptor, until as many calls
+    /// to @a disarmNotifications were made
+    ///
+    /// @note Check for new data once armed, to catch samples submitted before.
+    void armNotifications();
+
+    /// Reverts one call to @a armNotifications
+    void disarmNotifications();
+
+    /// Blocks until a sample with a greater sequence id is available, or until
+    /// the timeout expires
+    ///
+    /// @return Whether a sample with a greater sequence id is available
+    [[nodiscard]] auto waitForNewData(std::uint64_t sequence_id, std::chrono::nanoseconds timeout) const -> bool;
+
+    /// Current time on the channel clock, to compare sample clock timestamps with
+    [[nodiscard]] auto getClockTime() const -> std::chrono::nanoseconds;
+
+    /// Copies up to @a size bytes of the latest sample's payload into @a destination, leaving the bytes past the
+    /// submitted payload untouched
+    ///
+    /// Unlike @a acquire, this never writes to channel memory shared with other
+    /// endpoints, retrying instead whenever the copy was torn by a concurrent writer. This makes it
+    /// the better fit for small payloads read by many readers.
+    ///
+    /// @return The sequence id of the copied sample
+    [[nodiscard]] auto readLatest(void* destination, std::size_t size) const -> std::uint64_t;
+
+    /// @copydoc readLatest
+    ///
+    /// @param[out] payload_size The number of payload bytes the writer submitted, which may exceed @a size
+    [[nodiscard]] auto readLatest(void* destination, std::size_t size, std::size_t& payload_size) const
+        -> std::uint64_t;
+
     /// Acquires the latest available data sample
     [[nodiscard]] auto acquire() -> Sample;
 
+    /// Acquires up to @a count of the newest samples, no more than the channel's history depth, oldest first
+    ///
+    /// Samples submitted during the call may take the place of older ones.
+    ///
+    /// @param[out] samples Cleared, then filled with the acquired samples, each to be released
+    void acquireHistory(std::size_t count, std::vector<Sample>& samples);
+
+    /// Collects the payload ranges of a sample which may differ from the payload of the sample with the given
+    /// sequence id, in blocks of @a kDirtyBlockSize bytes
+    ///
+    /// Ranges are exact as long as every sample since was prepared from its predecessor by
+    /// @a Writer::prepareFromLatest, and cover the whole payload otherwise.
+    ///
+    /// @param[out] ranges Cleared, then filled with the changed ranges in ascending order
+    void getChangedRanges(const Sample& sample, std::uint64_t since_sequence_id,
+                          std::vector<ByteRange>& ranges) const;
+
     /// Release the provided sample
     ///
     /// @attention Must have been obtained by a call to @a acquire
     void release(Sample sample_handle);
 
   private:
+    friend class Session;
+    explicit Reader(void* shadow) noexcept : m_shadow{shadow} {}
+
     void* m_shadow;
 };
 
@@ -80,12 +282,13 @@ class Writer final {
 
       private:
         friend class Writer;
-        explicit Sample(void* shadow) noexcept : m_shadow{shadow} {}
+        explicit Sample(void* shadow, std::size_t index) noexcept : m_shadow{shadow}, m_index{index} {}
         void* m_shadow;
+        std::size_t m_index;
     };
 
     /// Creates a Writer for the given channel, setting the expected payload size
-    Writer(std::string_view channel_name, std::size_t max_payload_size);
+    Writer(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
 
     Writer(const Writer&) = delete;
     Writer(Writer&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
@@ -99,24 +302,600 @@ class Writer final {
 
     /// Prepares a new sample to fill
     ///
-    /// @note This method has undeterministic worst-case execution time.
+    /// @note This method has undeterministic worst-case execution time, unless
+    ///       the writer reserves a spare slot and its reserve got refilled.
     [[nodiscard]] auto prepare() -> Sample;
 
-    /// Submit the filled sample to the system
+    /// Prepares a new sample to fill, scanning the channel at most once
+    ///
+    /// @return The sample, or nothing if every slot is in use
+    [[nodiscard]] auto tryPrepare() -> std::optional<Sample>;
+
+    /// Prepares a new sample to fill, seeded with the payload of the latest sample
+    ///
+    /// Only the blocks of @a kDirtyBlockSize bytes which the prepared slot does not already share with the latest
+    /// sample get copied over.
+    ///
+    /// @attention Every range modified afterwards must be reported through @a markDirty, as both the seeding of
+    ///            later samples and @a Reader::getChangedRanges rely on it.
+    [[nodiscard]] auto prepareFromLatest() -> Sample;
+
+    /// Reports the given payload range of a prepared sample as modified
+    void markDirty(const Sample& sample_handle, std::size_t offset, std::size_t size);
+
+    /// Prepares a new sample to fill, busy-waiting for a slot to free up until
+    /// the deadline
+    ///
+    /// @return The sample, or nothing if every slot remained in use
+    [[nodiscard]] auto prepareFor(std::chrono::steady_clock::time_point deadline) -> std::optional<Sample>;
+
+    /// Submit the filled sample to the system, with a payload of the maximum size
     ///
     /// @attention Must have been obtained by a call to @a prepare
+    /// @note Samples only ever replace older ones as the latest, so that a sample prepared before another writer's
+    ///       but submitted after it gets dropped rather than shadowing it.
     void submit(Sample sample_handle);
 
+    /// Submit the filled sample to the system, with a payload of the given size
+    ///
+    /// @attention Must have been obtained by a call to @a prepare
+    /// @note Unless prefaulted, channel memory is only allocated once touched, so slots sized for the worst case
+    ///       only cost as much memory as the largest payloads actually written to them.
+    void submit(Sample sample_handle, std::size_t payload_size);
+
+  private:
+    friend class Session;
+    explicit Writer(void* shadow) noexcept : m_shadow{shadow} {}
+
+    void* m_shadow;
+};
+
+/// Writing end of a queue channel, delivering every sample to the queue's reader in submission order
+///
+/// Unlike a Writer, which lets readers skip over samples they are too slow for, a queue never drops samples: once
+/// all of its slots are taken, writers are pushed back until the reader releases some. Any number of writers may
+/// feed the same queue.
+class QueueWriter final {
+  public:
+    /// Consecutive samples prepared at once
+    class Batch final {
+      public:
+        /// Number of samples in the batch, zero if the queue was full
+        [[nodiscard]] auto size() const -> std::size_t { return m_size; }
+        [[nodiscard]] auto empty() const -> bool { return m_size == 0U; }
+
+        [[nodiscard]] auto getSequenceId(std::size_t index) const -> std::uint64_t;
+        [[nodiscard]] auto getPayload(std::size_t index) -> void*;
+        /// Sets the payload size of a sample, which defaults to the maximum
+        void setSize(std::size_t index, std::size_t payload_size);
+
+      private:
+        friend class QueueWriter;
+        explicit Batch(void* shadow, std::uint64_t position, std::size_t size) noexcept
+            : m_shadow{shadow}, m_position{position}, m_size{size} {}
+        void* m_shadow;
+        std::uint64_t m_position;
+        std::size_t m_size;
+    };
+
+    /// Creates a QueueWriter for the given queue channel, setting the expected payload size
+    ///
+    /// @note The channel's slot count bounds the number of samples queued at once.
+    QueueWriter(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
+
+    QueueWriter(const QueueWriter&) = delete;
+    QueueWriter(QueueWriter&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    QueueWriter& operator=(const QueueWriter&) = delete;
+    QueueWriter& operator=(QueueWriter&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~QueueWriter() noexcept;
+
+    /// Prepares up to @a max_count consecutive samples to fill, without waiting for any slot to free up
+    ///
+    /// @return The batch, which is empty if the queue is full
+    [[nodiscard]] auto tryPrepareBatch(std::size_t max_count) -> Batch;
+
+    /// Prepares up to @a max_count consecutive samples to fill, busy-waiting for
+    /// the reader to free a slot until the deadline
+    ///
+    /// @return The batch, which is empty if the queue remained full
+    [[nodiscard]] auto prepareBatchFor(std::size_t max_count, std::chrono::steady_clock::time_point deadline)
+        -> Batch;
+
+    /// Publishes every sample of the filled batch to the reader
+    ///
+    /// @attention Must have been obtained by a call to @a tryPrepareBatch or @a prepareBatchFor
+    /// @note The reader stops at samples still being prepared by other writers, so batches held for long delay
+    ///       the ones submitted after them.
+    void submit(Batch batch);
+
   private:
     void* m_shadow;
 };
 
+/// Reading end of a queue channel, receiving every sample in submission order
+///
+/// A queue has a single reader at a time.
+class QueueReader final {
+  public:
+    /// Consecutive samples acquired at once
+    class Batch final {
+      public:
+        /// Number of samples in the batch, zero if none was available
+        [[nodiscard]] auto size() const -> std::size_t { return m_size; }
+        [[nodiscard]] auto empty() const -> bool { return m_size == 0U; }
+
+        [[nodiscard]] auto getSequenceId(std::size_t index) const -> std::uint64_t;
+        /// @copydoc Reader::Sample::getTimestamp
+        [[nodiscard]] auto getTimestamp(std::size_t index) const -> std::chrono::system_clock::time_point;
+        /// @copydoc Reader::Sample::getClockTimestamp
+        [[nodiscard]] auto getClockTimestamp(std::size_t index) const -> std::chrono::nanoseconds;
+        [[nodiscard]] auto getPayload(std::size_t index) const -> const void*;
+        /// Number of payload bytes the writer submitted
+        [[nodiscard]] auto getSize(std::size_t index) const -> std::size_t;
+
+      private:
+        friend class QueueReader;
+        explicit Batch(void* shadow, std::uint64_t position, std::size_t size) noexcept
+            : m_shadow{shadow}, m_position{position}, m_size{size} {}
+        void* m_shadow;
+        std::uint64_t m_position;
+        std::size_t m_size;
+    };
+
+    /// Creates the QueueReader of the given queue channel, validating the expected payload size
+    ///
+    /// Samples acquired yet not released by a previous reader are delivered again.
+    ///
+    /// @attention Aborts if the queue already has a reader.
+    QueueReader(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
+
+    QueueReader(const QueueReader&) = delete;
+    QueueReader(QueueReader&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    QueueReader& operator=(const QueueReader&) = delete;
+    QueueReader& operator=(QueueReader&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~QueueReader() noexcept;
+
+    /// Indicates whether a sample awaits acquisition
+    [[nodiscard]] auto hasData() const -> bool;
+
+    /// Blocks until a sample awaits acquisition, or until the timeout expires
+    ///
+    /// @return Whether a sample awaits acquisition
+    [[nodiscard]] auto waitForData(std::chrono::nanoseconds timeout) const -> bool;
+
+    /// @copydoc Reader::getClockTime
+    [[nodiscard]] auto getClockTime() const -> std::chrono::nanoseconds;
+
+    /// Acquires up to @a max_count of the oldest samples not acquired yet
+    ///
+    /// @return The batch, which is empty if no sample was available
+    [[nodiscard]] auto acquireBatch(std::size_t max_count) -> Batch;
+
+    /// Hands the slots of the batch back to writers
+    ///
+    /// @attention Batches must be released in the order they were acquired in.
+    void releaseBatch(Batch batch);
+
+  private:
+    void* m_shadow;
+};
+
+/// Calling end of an RPC channel, whose requests servers reply to in place
+///
+/// Any number of clients may share a channel, each with any number of calls in flight, as long as the channel has a
+/// slot for every call.
+class RpcClient final {
+  public:
+    /// Request being prepared or awaiting its reply, which then takes its place in the same slot
+    class Call final {
+      public:
+        /// Identifies the call among every call of the channel
+        [[nodiscard]] auto getCorrelationId() const -> std::uint64_t;
+        /// The request while being prepared, then the reply once replied to
+        [[nodiscard]] auto getPayload() const -> void*;
+        /// Number of payload bytes of the reply, once replied to
+        [[nodiscard]] auto getSize() const -> std::size_t;
+        /// Whether the server serving the call went away without replying
+        [[nodiscard]] auto isDropped() const -> bool;
+
+      private:
+        friend class RpcClient;
+        explicit Call(void* shadow, std::size_t index) noexcept : m_shadow{shadow}, m_index{index} {}
+        void* m_shadow;
+        std::size_t m_index;
+    };
+
+    /// Creates an RpcClient for the given RPC channel, setting the expected payload size of both requests and replies
+    RpcClient(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
+
+    RpcClient(const RpcClient&) = delete;
+    RpcClient(RpcClient&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    RpcClient& operator=(const RpcClient&) = delete;
+    RpcClient& operator=(RpcClient&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~RpcClient() noexcept;
+
+    /// Takes a slot to write a request into, yielding until one is free
+    [[nodiscard]] auto prepare() -> Call;
+
+    /// Posts the prepared request, holding the given number of payload bytes, to whichever server takes it first
+    void post(const Call& call, std::size_t payload_size);
+
+    /// Blocks until the posted call is replied to or dropped, or until the timeout expires
+    ///
+    /// @return Whether the call is replied to or dropped
+    [[nodiscard]] auto waitForReply(const Call& call, std::chrono::nanoseconds timeout) const -> bool;
+
+    /// Posts the prepared request, then blocks until it is replied to or dropped, or until the timeout expires
+    ///
+    /// @return Whether the call is replied to or dropped
+    [[nodiscard]] auto call(const Call& call, std::size_t payload_size, std::chrono::nanoseconds timeout) -> bool;
+
+    /// Gives the slot of a call back, withdrawing its request unless a server took it already
+    ///
+    /// @attention Must be called for every prepared call, replied to or not.
+    void release(Call call);
+
+  private:
+    void* m_shadow;
+};
+
+/// Serving end of an RPC channel, replying to requests in place
+///
+/// Any number of servers may share the requests of a channel, each request being served by a single one.
+class RpcServer final {
+  public:
+    /// Request accepted for serving, whose payload the reply gets written over
+    class Call final {
+      public:
+        [[nodiscard]] auto getCorrelationId() const -> std::uint64_t;
+        /// The request, then the reply being written
+        [[nodiscard]] auto getPayload() const -> void*;
+        /// Number of payload bytes of the request
+        [[nodiscard]] auto getSize() const -> std::size_t;
+
+      private:
+        friend class RpcServer;
+        explicit Call(void* shadow, std::size_t index) noexcept : m_shadow{shadow}, m_index{index} {}
+        void* m_shadow;
+        std::size_t m_index;
+    };
+
+    /// Creates an RpcServer for the given RPC channel, validating the expected payload size
+    RpcServer(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options = {});
+
+    RpcServer(const RpcServer&) = delete;
+    RpcServer(RpcServer&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    RpcServer& operator=(const RpcServer&) = delete;
+    RpcServer& operator=(RpcServer&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~RpcServer() noexcept;
+
+    /// Indicates whether a request awaits a server
+    [[nodiscard]] auto hasRequests() const -> bool;
+
+    /// Blocks until a request awaits a server, or until the timeout expires
+    ///
+    /// @return Whether a request awaits a server
+    [[nodiscard]] auto waitForRequests(std::chrono::nanoseconds timeout) const -> bool;
+
+    /// Takes a posted request for serving, without waiting for one
+    ///
+    /// @note Requests are taken in no particular order, yet none is passed over for long.
+    [[nodiscard]] auto tryAccept() -> std::optional<Call>;
+
+    /// Replies to an accepted call with the given number of payload bytes, written in place over the request, and
+    /// wakes up its client
+    void reply(Call call, std::size_t payload_size);
+
+  private:
+    void* m_shadow;
+};
+
+/// Connection to the tower, opening many channels in a single round trip
+///
+/// Readers and Writers opened through a session do not depend on it, and may
+/// outlive it.
+class Session final {
+  public:
+    /// Connects to the tower
+    Session();
+
+    /// Connects to the tower listening at the given socket path
+    explicit Session(std::string_view tower_path);
+
+    Session(const Session&) = delete;
+    Session(Session&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    Session& operator=(const Session&) = delete;
+    Session& operator=(Session&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~Session() noexcept;
+
+    /// Opens a Reader for each of the given channels, in order
+    [[nodiscard]] auto openReaders(const std::vector<ChannelRequest>& requests) -> std::vector<Reader>;
+
+    /// Opens a Writer for each of the given channels, in order
+    [[nodiscard]] auto openWriters(const std::vector<ChannelRequest>& requests) -> std::vector<Writer>;
+
+    /// Opens a Reader for the given channel, reusing the session's connection
+    [[nodiscard]] auto openReader(std::string_view channel_name, std::size_t max_payload_size,
+                                  const ChannelOptions& options = {}) -> Reader;
+
+    /// Opens a Writer for the given channel, reusing the session's connection
+    [[nodiscard]] auto openWriter(std::string_view channel_name, std::size_t max_payload_size,
+                                  const ChannelOptions& options = {}) -> Writer;
+
+    /// Opens a Writer for the given channel unless the tower rejects it, rather than aborting
+    ///
+    /// @param status Set to the tower's answer
+    /// @return The writer, or nothing if rejected
+    [[nodiscard]] auto tryOpenWriter(std::string_view channel_name, std::size_t max_payload_size, OpenStatus& status,
+                                     const ChannelOptions& options = {}) -> std::optional<Writer>;
+
+  private:
+    void* m_shadow;
+};
+
+/// Waits for new data on many readers at once
+class WaitSet final {
+  public:
+    WaitSet();
+
+    WaitSet(const WaitSet&) = delete;
+    WaitSet(WaitSet&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    WaitSet& operator=(const WaitSet&) = delete;
+    WaitSet& operator=(WaitSet&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~WaitSet() noexcept;
+
+    /// Adds a reader to the set, arming its notifications for as long as the set lives
+    ///
+    /// @attention The reader must outlive the set.
+    /// @return The index identifying the reader within the set
+    auto add(Reader& reader) -> std::size_t;
+
+    /// Blocks until writers signal any reader of the set, or until the timeout expires
+    ///
+    /// @return The indices of the signalled readers, valid until the next call
+    [[nodiscard]] auto wait(std::chrono::nanoseconds timeout) -> const std::vector<std::size_t>&;
+
+  private:
+    void* m_shadow;
+};
+
+/// Channel reader for payloads of type @a T
+///
+/// @note The payload size is fixed at compile time, not the sample stride: slots are located by the library, which
+///       reads the stride off the channel, and sample handles reach their payload without it.
+template <typename T>
+class TypedReader final {
+    static_assert(std::is_trivially_copyable_v<T>, "payloads are shared as raw bytes");
+    static_assert(alignof(T) <= kPayloadAlignment, "payloads are only aligned to kPayloadAlignment");
+
+  public:
+    class Sample final {
+      public:
+        [[nodiscard]] auto getSequenceId() const -> std::uint64_t { return m_sample.getSequenceId(); }
+        [[nodiscard]] auto getTimestamp() const -> std::chrono::system_clock::time_point {
+            return m_sample.getTimestamp();
+        }
+        [[nodiscard]] auto getClockTimestamp() const -> std::chrono::nanoseconds {
+            return m_sample.getClockTimestamp();
+        }
+        [[nodiscard]] auto getPayload() const -> const T& { return *static_cast<const T*>(m_sample.getPayload()); }
+
+        [[nodiscard]] auto operator*() const -> const T& { return getPayload(); }
+        [[nodiscard]] auto operator->() const -> const T* { return &getPayload(); }
+
+      private:
+        friend class TypedReader;
+        explicit Sample(Reader::Sample sample) noexcept : m_sample{sample} {}
+        Reader::Sample m_sample;
+    };
+
+    /// Creates a TypedReader for the given channel, which must carry payloads of
+    /// exactly `sizeof(T)` bytes
+    explicit TypedReader(std::string_view channel_name, const ChannelOptions& options = {})
+        : m_reader{channel_name, sizeof(T), options} {}
+
+    /// @copydoc Reader::hasNewData
+    [[nodiscard]] auto hasNewData(std::uint64_t sequence_id) const -> bool { return m_reader.hasNewData(sequence_id); }
+
+    /// @copydoc Reader::waitForNewData
+    [[nodiscard]] auto waitForNewData(std::uint64_t sequence_id, std::chrono::nanoseconds timeout) const -> bool {
+        return m_reader.waitForNewData(sequence_id, timeout);
+    }
+
+    /// @copydoc Reader::getClockTime
+    [[nodiscard]] auto getClockTime() const -> std::chrono::nanoseconds { return m_reader.getClockTime(); }
+
+    /// @copydoc Reader::readLatest
+    [[nodiscard]] auto readLatest(T& destination) const -> std::uint64_t {
+        return m_reader.readLatest(&destination, sizeof(T));
+    }
+
+    /// @copydoc Reader::acquire
+    [[nodiscard]] auto acquire() -> Sample { return Sample{m_reader.acquire()}; }
+
+    /// @copydoc Reader::release
+    void release(Sample sample_handle) { m_reader.release(sample_handle.m_sample); }
+
+  private:
+    Reader m_reader;
+};
+
+/// Channel writer for payloads of type @a T
+///
+/// @note See @a TypedReader as for the sample stride.
+template <typename T>
+class TypedWriter final {
+    static_assert(std::is_trivially_copyable_v<T>, "payloads are shared as raw bytes");
+    static_assert(alignof(T) <= kPayloadAlignment, "payloads are only aligned to kPayloadAlignment");
+
+  public:
+    class Sample final {
+      public:
+        [[nodiscard]] auto getSequenceId() const -> std::uint64_t { return m_sample.getSequenceId(); }
+        [[nodiscard]] auto getPayload() -> T& { return *static_cast<T*>(m_sample.getPayload()); }
+
+        [[nodiscard]] auto operator*() -> T& { return getPayload(); }
+        [[nodiscard]] auto operator->() -> T* { return &getPayload(); }
+
+      private:
+        friend class TypedWriter;
+        explicit Sample(Writer::Sample sample) noexcept : m_sample{sample} {}
+        Writer::Sample m_sample;
+    };
+
+    /// Creates a TypedWriter for the given channel, which must carry payloads of
+    /// exactly `sizeof(T)` bytes
+    explicit TypedWriter(std::string_view channel_name, const ChannelOptions& options = {})
+        : m_writer{channel_name, sizeof(T), options} {}
+
+    /// @copydoc Writer::prepare
+    [[nodiscard]] auto prepare() -> Sample { return Sample{m_writer.prepare()}; }
+
+    /// @copydoc Writer::submit
+    void submit(Sample sample_handle) { m_writer.submit(sample_handle.m_sample); }
+
+  private:
+    Writer m_writer;
+};
+
+/// Severity of a log record
+enum class LogLevel : std::uint8_t {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+};
+
+namespace impl {
+
+/// Type of a log record argument, leading its encoding
+enum class LogArgType : std::uint8_t {
+    Bool = 0,
+    Char = 1,
+    Signed = 2,
+    Unsigned = 3,
+    Floating = 4,
+    String = 5,
+    Pointer = 6,
+};
+
+/// Number of bytes encoding a log record argument
+template <typename T>
+[[nodiscard]] std::size_t encodedLogArgSize(const T& value) noexcept {
+    if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        return sizeof(LogArgType) + sizeof(std::uint32_t) + std::string_view{value}.size();
+    else if constexpr (std::is_enum_v<T>)
+        return encodedLogArgSize(static_cast<std::underlying_type_t<T>>(value));
+    else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>)
+        return sizeof(LogArgType) + sizeof(T);
+    else
+        return sizeof(LogArgType) + sizeof(std::uint64_t);
+}
+
+template <typename T>
+[[nodiscard]] std::byte* encodeLogValue(std::byte* out, LogArgType type, const T& value) noexcept {
+    std::memcpy(out, &type, sizeof(type));
+    std::memcpy(out + sizeof(type), &value, sizeof(value));
+    return out + sizeof(type) + sizeof(value);
+}
+
+/// Encodes a log record argument, as its type followed by its value
+template <typename T>
+[[nodiscard]] std::byte* encodeLogArg(std::byte* out, const T& value) noexcept {
+    if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        const std::string_view text{value};
+        out = encodeLogValue(out, LogArgType::String, static_cast<std::uint32_t>(text.size()));
+        std::memcpy(out, text.data(), text.size());
+        return out + text.size();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return encodeLogValue(out, LogArgType::Bool, value);
+    } else if constexpr (std::is_same_v<T, char>) {
+        return encodeLogValue(out, LogArgType::Char, value);
+    } else if constexpr (std::is_enum_v<T>) {
+        return encodeLogArg(out, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return encodeLogValue(out, LogArgType::Signed, static_cast<std::int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        return encodeLogValue(out, LogArgType::Unsigned, static_cast<std::uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return encodeLogValue(out, LogArgType::Floating, static_cast<double>(value));
+    } else {
+        static_assert(std::is_pointer_v<T>, "unsupported log record argument");
+        return encodeLogValue(out, LogArgType::Pointer, reinterpret_cast<std::uint64_t>(value));
+    }
+}
+
+} // namespace impl
+
+/// Sets the least severe level of the records logged by the calling process, LogLevel::Info by default
+void setLogLevel(LogLevel level) noexcept;
+
+/// Logger writing binary records into a ring of the calling thread, in shared memory, for `fastipc-log` to format
+///
+/// Records carry the format string along with the arguments as they are, leaving all formatting to the reader, so that
+/// logging costs little more than copying them, and never blocks: records which find the ring full are dropped and
+/// counted instead. Rings outlive their thread until drained, so that records survive crashes. Threads only set up a
+/// ring once a collector runs, their records being dropped until then.
 class Logger final {
   public:
-    explicit Logger(int sock_fd);
+    /// Creates a logger tagging its records with the given source name, of up to 255 bytes
+    explicit Logger(std::string_view source);
+
+    Logger(const Logger&) = delete;
+    Logger(Logger&& from) noexcept : m_shadow{std::exchange(from.m_shadow, nullptr)} {}
+    Logger& operator=(const Logger&) = delete;
+    Logger& operator=(Logger&& from) & noexcept {
+        auto other = std::move(from);
+        std::swap(m_shadow, other.m_shadow);
+        return *this;
+    }
+    ~Logger() noexcept;
+
+    /// Logs a record, to be formatted as by `std::format` with automatically numbered fields
+    ///
+    /// Arguments may be booleans, characters, arithmetic values, enumerations, strings and pointers; strings are
+    /// copied, pointers are not followed.
+    template <typename... Args>
+    void log(LogLevel level, std::string_view format, const Args&... args) const noexcept {
+        auto* out = beginRecord(level, format, (std::size_t{0U} + ... + impl::encodedLogArgSize(args)));
+        if (out == nullptr)
+            return;
+        ((out = impl::encodeLogArg(out, args)), ...);
+        commitRecord();
+    }
 
   private:
-    // ...
+    /// Starts a record in the calling thread's ring, returning where its arguments go, or nothing if dropped
+    [[nodiscard]] auto beginRecord(LogLevel level, std::string_view format, std::size_t args_size) const noexcept
+        -> std::byte*;
+    /// Publishes the record started last by the calling thread
+    void commitRecord() const noexcept;
+
+    void* m_shadow;
 };
 
 } // namespace fastipc
@@ -0,0 +1,548 @@
+/*
+ *  bridge.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "bridge.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "io/addr.hxx"
+#include "io/fd.hxx"
+#include "io/result.hxx"
+#include "bridge_proto.hxx"
+
+namespace fastipc {
+namespace {
+
+/// Logger of the bridge
+[[nodiscard]] const Logger& bridgeLog() {
+    static const Logger logger{"fastipc-bridge"};
+    return logger;
+}
+
+[[nodiscard]] constexpr std::string_view statusName(OpenStatus status) noexcept {
+    switch (status) {
+    case OpenStatus::LayoutMismatch:
+        return "layout mismatch";
+    case OpenStatus::PayloadSizeMismatch:
+        return "payload size mismatch";
+    case OpenStatus::ProtocolMismatch:
+        return "protocol mismatch";
+    case OpenStatus::KindMismatch:
+        return "kind mismatch";
+    case OpenStatus::ResourceExhausted:
+        return "resources exhausted";
+    case OpenStatus::Ok:
+    default:
+        return "ok";
+    }
+}
+
+/// Bytes preceding each frame on the wire, holding its size over TCP
+[[nodiscard]] constexpr std::size_t framePrefixSize(BridgeTransport transport) noexcept {
+    return transport == BridgeTransport::Tcp ? sizeof(std::uint32_t) : 0U;
+}
+
+[[nodiscard]] io::expected<io::Fd> createSocket(const io::SocketAddr& addr, BridgeTransport transport) {
+    const auto family = std::holds_alternative<io::SocketAddrV4>(addr) ? AF_INET : AF_INET6;
+    const auto type = transport == BridgeTransport::Udp ? SOCK_DGRAM : SOCK_STREAM;
+    return io::adoptSysFd(::socket(family, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+}
+
+/// Calls the given socket function with the address in the form the socket API takes
+template <typename F>
+[[nodiscard]] int withSockaddr(const io::SocketAddr& addr, F&& func) {
+    return std::visit(
+        [&](const auto& socket_addr) {
+            const auto sockaddr = socket_addr.to();
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return func(reinterpret_cast<const ::sockaddr*>(&sockaddr), static_cast<::socklen_t>(sizeof(sockaddr)));
+        },
+        addr);
+}
+
+void watch(const io::Fd& epollfd, int fd, std::uint32_t events) {
+    ::epoll_event event{.events = events, .data = {.fd = fd}};
+    expect(io::sysCheck(::epoll_ctl(epollfd.fd(), EPOLL_CTL_ADD, fd, &event)), "failed to watch descriptor");
+}
+
+[[nodiscard]] std::uint64_t randomSenderId() {
+    std::random_device device;
+    return (std::uint64_t{device()} << 32U) | device(); // NOLINT(*-magic-numbers)
+}
+
+} // namespace
+
+BridgeSender BridgeSender::create(std::string_view tower_path, std::span<const BridgedChannel> channels,
+                                  const io::SocketAddr& remote, BridgeTransport transport) {
+    const auto max_frame_size =
+        transport == BridgeTransport::Udp ? kMaxBridgeDatagramSize : kMaxBridgeFrameSize - framePrefixSize(transport);
+
+    std::vector<BridgedChannel> bridged;
+    for (const auto& channel : channels) {
+        const auto is_duplicate = std::ranges::find(bridged, channel.name, &BridgedChannel::name) != bridged.end();
+        const auto sample_size = kBridgeSampleHeaderSize + channel.name.size() + channel.max_payload_size;
+        if (is_duplicate || kBridgeFrameHeaderSize + sample_size > max_frame_size) {
+            bridgeLog().log(LogLevel::Warning, "not bridging {}channel '{}', whose samples do not fit in a frame.",
+                            is_duplicate ? "duplicate " : "", channel.name);
+            continue;
+        }
+        bridged.push_back(channel);
+    }
+
+    std::vector<ChannelRequest> requests;
+    requests.reserve(bridged.size());
+    for (const auto& channel : bridged)
+        requests.push_back({.channel_name = channel.name, .max_payload_size = channel.max_payload_size});
+
+    Session session{tower_path};
+    auto readers = session.openReaders(requests);
+
+    auto epollfd = expect(io::adoptSysFd(::epoll_create1(EPOLL_CLOEXEC)), "failed to create bridge epoll instance");
+    auto shutdownfd =
+        expect(io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)), "failed to create bridge shutdown eventfd");
+    watch(epollfd, shutdownfd.fd(), EPOLLIN);
+
+    std::vector<Subscription> subscriptions;
+    subscriptions.reserve(readers.size());
+    // NOLINTNEXTLINE(altera-unroll-loops) Readers are set up one by one
+    for (std::size_t i{0U}; i < readers.size(); ++i) {
+        auto& subscription =
+            subscriptions.emplace_back(Subscription{.channel = std::move(bridged[i]), .reader = std::move(readers[i])});
+        watch(epollfd, subscription.reader.getNotificationFd(), EPOLLIN | EPOLLET);
+        subscription.reader.armNotifications();
+    }
+
+    return BridgeSender{std::move(subscriptions), std::move(epollfd), std::move(shutdownfd), remote, transport};
+}
+
+BridgeSender::BridgeSender(std::vector<Subscription> subscriptions, io::Fd epollfd, io::Fd shutdownfd,
+                           const io::SocketAddr& remote, BridgeTransport transport)
+    : m_subscriptions{std::move(subscriptions)}, m_epollfd{std::move(epollfd)}, m_shutdownfd{std::move(shutdownfd)},
+      m_remote{remote}, m_transport{transport}, m_sender_id{randomSenderId()} {
+    // Frames batch samples up to the size of a datagram, or of the largest sample.
+    std::size_t max_sample_size{0U};
+    for (const auto& subscription : m_subscriptions)
+        max_sample_size = std::max(max_sample_size, kBridgeSampleHeaderSize + subscription.channel.name.size() +
+                                                        subscription.channel.max_payload_size);
+    m_frame.resize(framePrefixSize(m_transport) +
+                   std::max(kMaxBridgeDatagramSize, kBridgeFrameHeaderSize + max_sample_size));
+    m_frame_size = framePrefixSize(m_transport) + kBridgeFrameHeaderSize;
+}
+
+void BridgeSender::run() {
+    constexpr std::size_t kMaxEvents{64U};
+    std::array<::epoll_event, kMaxEvents> events{};
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        if (!connect())
+            return;
+
+        // Catches up with whatever was submitted while disconnected, or before notifications got armed.
+        if (!forward()) {
+            const auto error = io::errnoCode();
+            if (!waitFor(-1, 0, std::chrono::milliseconds{0}))
+                return;
+            bridgeLog().log(LogLevel::Warning, "lost the link to bridge receiver {}: {}.", std::format("{}", m_remote),
+                            error.message());
+            m_sockfd = io::Fd{};
+            // Frames sent lately may have been lost along with the link, hence the newest samples get sent again.
+            // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the number of channels
+            for (auto& subscription : m_subscriptions)
+                subscription.last_sequence_id = 0U;
+            continue;
+        }
+
+        const auto count = ::epoll_wait(m_epollfd.fd(), events.data(), events.size(), -1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        expect(io::sysCheck(count), "failed to wait for bridge events");
+
+        for (const auto& event : std::span{events}.first(static_cast<std::size_t>(count))) {
+            if (event.data.fd == m_shutdownfd.fd())
+                return;
+        }
+    }
+}
+
+void BridgeSender::shutdown() {
+    expect(io::sysCheck(::eventfd_write(m_shutdownfd.fd(), 1U)), "failed to shut down bridge");
+}
+
+bool BridgeSender::connect() {
+    if (m_sockfd.fd() >= 0)
+        return true;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Retried until connected
+    for (bool reported{false};; reported = true) {
+        auto sockfd = expect(createSocket(m_remote, m_transport), "failed to create bridge socket");
+        auto connected = io::sysCheck(withSockaddr(m_remote, [&](const ::sockaddr* addr, ::socklen_t size) {
+            return ::connect(sockfd.fd(), addr, size);
+        }));
+
+        if (!connected.has_value() && connected.error() == std::errc::operation_in_progress) {
+            if (!waitFor(sockfd.fd(), POLLOUT, std::chrono::milliseconds{-1}))
+                return false;
+            int error{0};
+            ::socklen_t size{sizeof(error)};
+            static_cast<void>(::getsockopt(sockfd.fd(), SOL_SOCKET, SO_ERROR, &error, &size));
+            connected = error == 0 ? io::expected<void>{}
+                                   : io::expected<void>{io::unexpected{std::error_code{error, std::system_category()}}};
+        }
+
+        if (connected.has_value()) {
+            if (m_transport == BridgeTransport::Tcp) {
+                const int enabled{1};
+                static_cast<void>(::setsockopt(sockfd.fd(), IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled)));
+            }
+            bridgeLog().log(LogLevel::Info, "bridging {} channel(s) to {}.", m_subscriptions.size(),
+                            std::format("{}", m_remote));
+            m_sockfd = std::move(sockfd);
+            return true;
+        }
+
+        // Only report the first failure of a row.
+        if (!reported)
+            bridgeLog().log(LogLevel::Warning, "failed to connect to bridge receiver {}: {}, retrying.",
+                            std::format("{}", m_remote), connected.error().message());
+        if (!waitFor(-1, 0, kReconnectInterval))
+            return false;
+    }
+}
+
+bool BridgeSender::forward() {
+    const auto max_frame_size = m_transport == BridgeTransport::Udp ? kMaxBridgeDatagramSize : m_frame.size();
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the number of channels
+    for (auto& subscription : m_subscriptions) {
+        if (!subscription.reader.hasNewData(subscription.last_sequence_id))
+            continue;
+
+        const auto& name = subscription.channel.name;
+        const auto max_payload_size = subscription.channel.max_payload_size;
+        const auto sample_header_size = kBridgeSampleHeaderSize + name.size();
+        if ((m_frame_size + sample_header_size + max_payload_size > max_frame_size || m_frame_samples == UINT16_MAX) &&
+            !flush())
+            return false;
+
+        // Copy the payload straight into the frame.
+        std::size_t payload_size{0U};
+        auto* const payload = m_frame.data() + m_frame_size + sample_header_size;
+        subscription.last_sequence_id = subscription.reader.readLatest(payload, max_payload_size, payload_size);
+        payload_size = std::min(payload_size, max_payload_size);
+
+        std::span<std::byte> header{m_frame.data() + m_frame_size, sample_header_size};
+        putBe(header, subscription.last_sequence_id);
+        putBe(header, static_cast<std::uint32_t>(max_payload_size));
+        putBe(header, static_cast<std::uint32_t>(payload_size));
+        putBe(header, static_cast<std::uint8_t>(name.size()));
+        io::putBuf(header, std::as_bytes(std::span{name}));
+
+        m_frame_size += sample_header_size + payload_size;
+        ++m_frame_samples;
+    }
+
+    return flush();
+}
+
+bool BridgeSender::flush() {
+    if (m_frame_samples == 0U)
+        return true;
+
+    std::span<std::byte> header{m_frame};
+    if (m_transport == BridgeTransport::Tcp)
+        putBe(header, static_cast<std::uint32_t>(m_frame_size - framePrefixSize(m_transport)));
+    putBe(header, kBridgeMagic);
+    putBe(header, kBridgeVersion);
+    putBe(header, m_frame_samples);
+    putBe(header, m_sender_id);
+
+    auto unsent = std::span{m_frame}.first(m_frame_size);
+    m_frame_size = framePrefixSize(m_transport) + kBridgeFrameHeaderSize;
+    m_frame_samples = 0U;
+
+    // Waiting on the link holds newer samples back, so that only the newest get sent once it catches up.
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the frame size
+    while (!unsent.empty()) {
+        const auto sent = ::send(m_sockfd.fd(), unsent.data(), unsent.size(), MSG_NOSIGNAL);
+        if (sent >= 0) {
+            unsent = unsent.subspan(static_cast<std::size_t>(sent));
+            continue;
+        }
+
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!waitFor(m_sockfd.fd(), POLLOUT, std::chrono::milliseconds{-1}))
+                return false;
+            continue;
+        }
+        // Datagrams refused by a receiver yet to start are lost like any other.
+        if (m_transport == BridgeTransport::Udp && errno == ECONNREFUSED)
+            return true;
+        return false;
+    }
+
+    return true;
+}
+
+bool BridgeSender::waitFor(int fd, short events, std::chrono::milliseconds timeout) const {
+    std::array<::pollfd, 2U> fds{{{.fd = m_shutdownfd.fd(), .events = POLLIN, .revents = 0},
+                                  {.fd = fd, .events = events, .revents = 0}}};
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Retried until interrupted by something else than a signal
+    while (::poll(fds.data(), fds.size(), static_cast<int>(timeout.count())) < 0 && errno == EINTR) {}
+
+    return (fds[0].revents & POLLIN) == 0;
+}
+
+BridgeReceiver BridgeReceiver::create(std::string_view tower_path, std::span<const BridgedChannel> channels,
+                                      const io::SocketAddr& local, BridgeTransport transport) {
+    Session session{tower_path};
+
+    auto sockfd = expect(createSocket(local, transport), "failed to create bridge socket");
+    const int enabled{1};
+    static_cast<void>(::setsockopt(sockfd.fd(), SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled)));
+    expect(io::sysCheck(withSockaddr(local, [&](const ::sockaddr* addr, ::socklen_t size) {
+               return ::bind(sockfd.fd(), addr, size);
+           })),
+           "failed to bind bridge socket");
+    if (transport == BridgeTransport::Tcp) {
+        constexpr int kListenQueueSize{16};
+        expect(io::sysCheck(::listen(sockfd.fd(), kListenQueueSize)), "failed to listen to bridge socket");
+    }
+
+    auto epollfd = expect(io::adoptSysFd(::epoll_create1(EPOLL_CLOEXEC)), "failed to create bridge epoll instance");
+    auto shutdownfd =
+        expect(io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)), "failed to create bridge shutdown eventfd");
+    watch(epollfd, sockfd.fd(), EPOLLIN);
+    watch(epollfd, shutdownfd.fd(), EPOLLIN);
+
+    BridgeReceiver receiver{std::move(session), std::move(sockfd), std::move(epollfd), std::move(shutdownfd),
+                            transport};
+    receiver.m_datagram.resize(kMaxBridgeDatagramSize);
+    // NOLINTNEXTLINE(altera-unroll-loops) Channels are set up one by one
+    for (const auto& channel : channels)
+        receiver.m_channels.emplace(channel.name, Republished{.max_payload_size = channel.max_payload_size});
+    return receiver;
+}
+
+io::SocketAddr BridgeReceiver::getAddress() const {
+    return expect(io::getLocalAddress(m_sockfd.fd()), "failed to get bridge address");
+}
+
+void BridgeReceiver::run() {
+    constexpr std::size_t kMaxEvents{64U};
+    std::array<::epoll_event, kMaxEvents> events{};
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        const auto count = ::epoll_wait(m_epollfd.fd(), events.data(), events.size(), -1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        expect(io::sysCheck(count), "failed to wait for bridge events");
+
+        for (const auto& event : std::span{events}.first(static_cast<std::size_t>(count))) {
+            const auto fd = event.data.fd;
+
+            if (fd == m_shutdownfd.fd())
+                return;
+
+            if (fd == m_sockfd.fd()) {
+                if (m_transport == BridgeTransport::Udp)
+                    receiveDatagrams();
+                else
+                    accept();
+                continue;
+            }
+
+            const auto connection = m_connections.find(fd);
+            if (connection == m_connections.end())
+                continue;
+
+            if ((event.events & EPOLLIN) != 0U && receive(connection->second))
+                continue;
+
+            // Either hung up, errored, or misbehaved.
+            m_connections.erase(connection);
+        }
+    }
+}
+
+void BridgeReceiver::shutdown() {
+    expect(io::sysCheck(::eventfd_write(m_shutdownfd.fd(), 1U)), "failed to shut down bridge");
+}
+
+void BridgeReceiver::receiveDatagrams() {
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        const auto received = ::recv(m_sockfd.fd(), m_datagram.data(), m_datagram.size(), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0)
+            return;
+
+        if (!republish(std::span{m_datagram}.first(static_cast<std::size_t>(received))))
+            bridgeLog().log(LogLevel::Warning, "dropping malformed bridge datagram.");
+    }
+}
+
+void BridgeReceiver::accept() {
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        auto sockfd = io::adoptSysFd(::accept4(m_sockfd.fd(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC));
+        if (!sockfd.has_value()) {
+            if (sockfd.error() == std::errc::connection_aborted || sockfd.error() == std::errc::interrupted)
+                continue;
+            return;
+        }
+
+        watch(m_epollfd, sockfd->fd(), EPOLLIN);
+        const auto fd = sockfd->fd();
+        m_connections.emplace(fd, Connection{.sockfd = std::move(*sockfd), .pending = {}});
+    }
+}
+
+bool BridgeReceiver::receive(Connection& connection) {
+    constexpr std::size_t kChunkSize{std::size_t{64U} << 10U}; // NOLINT(*-magic-numbers)
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        const auto offset = connection.pending.size();
+        connection.pending.resize(offset + kChunkSize);
+        const auto received = ::recv(connection.sockfd.fd(), connection.pending.data() + offset, kChunkSize, 0);
+        connection.pending.resize(offset + static_cast<std::size_t>(std::max<::ssize_t>(received, 0)));
+        if (received == 0)
+            return false;
+        if (received < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        // Republish every whole frame, keeping the rest for later.
+        std::span<const std::byte> rest{connection.pending};
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the received bytes
+        while (rest.size() >= sizeof(std::uint32_t)) {
+            auto size_buf = rest;
+            const auto frame_size = getBe<std::uint32_t>(size_buf);
+            if (frame_size > kMaxBridgeFrameSize - sizeof(std::uint32_t)) {
+                bridgeLog().log(LogLevel::Warning, "dropping bridge connection sending an oversized frame.");
+                return false;
+            }
+            if (size_buf.size() < frame_size)
+                break;
+            if (!republish(size_buf.first(frame_size))) {
+                bridgeLog().log(LogLevel::Warning, "dropping bridge connection sending a malformed frame.");
+                return false;
+            }
+            rest = size_buf.subspan(frame_size);
+        }
+        connection.pending.erase(connection.pending.begin(),
+                                 connection.pending.begin() + static_cast<std::ptrdiff_t>(connection.pending.size() -
+                                                                                          rest.size()));
+    }
+}
+
+bool BridgeReceiver::republish(std::span<const std::byte> frame) {
+    if (frame.size() < kBridgeFrameHeaderSize)
+        return false;
+    if (getBe<std::uint32_t>(frame) != kBridgeMagic || getBe<std::uint16_t>(frame) != kBridgeVersion)
+        return false;
+    const auto sample_count = getBe<std::uint16_t>(frame);
+    const auto sender_id = getBe<std::uint64_t>(frame);
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the frame size
+    for (std::uint16_t i{0U}; i < sample_count; ++i) {
+        if (frame.size() < kBridgeSampleHeaderSize)
+            return false;
+        const auto sequence_id = getBe<std::uint64_t>(frame);
+        const std::size_t max_payload_size = getBe<std::uint32_t>(frame);
+        const std::size_t payload_size = getBe<std::uint32_t>(frame);
+        const std::size_t name_size = getBe<std::uint8_t>(frame);
+        if (name_size == 0U || payload_size > max_payload_size || max_payload_size > kMaxBridgeFrameSize ||
+            frame.size() < name_size + payload_size)
+            return false;
+        const auto name_bytes = io::takeBuf(frame, name_size);
+        const auto payload = io::takeBuf(frame, payload_size);
+
+        const std::string name{reinterpret_cast<const char*>(name_bytes.data()), name_bytes.size()};
+        const auto channel = m_channels.find(name);
+        if (channel == m_channels.end()) {
+            bridgeLog().log(LogLevel::Debug, "dropping sample of unlisted bridged channel '{}'.", name);
+            continue;
+        }
+        auto& republished = channel->second;
+        if (republished.max_payload_size != max_payload_size) {
+            bridgeLog().log(LogLevel::Warning,
+                            "dropping sample of bridged channel '{}' with max payload size of {} bytes, expected {}.",
+                            name, max_payload_size, republished.max_payload_size);
+            continue;
+        }
+        if (republished.rejected)
+            continue;
+        if (!republished.writer.has_value()) {
+            auto status = OpenStatus::Ok;
+            republished.writer = m_session.tryOpenWriter(name, max_payload_size, status);
+            if (!republished.writer.has_value()) {
+                bridgeLog().log(LogLevel::Error,
+                                "dropping samples of bridged channel '{}', rejected by the tower: {}.", name,
+                                statusName(status));
+                republished.rejected = true;
+                continue;
+            }
+            bridgeLog().log(LogLevel::Info, "republishing bridged channel '{}' with max payload size of {} bytes.",
+                            name, max_payload_size);
+        }
+
+        // Datagrams may arrive out of order.
+        if (republished.sender_id == sender_id && sequence_id <= republished.last_sequence_id)
+            continue;
+        republished.sender_id = sender_id;
+        republished.last_sequence_id = sequence_id;
+
+        auto sample = republished.writer->prepare();
+        std::memcpy(sample.getPayload(), payload.data(), payload.size());
+        republished.writer->submit(sample, payload.size());
+    }
+
+    return true;
+}
+
+} // namespace fastipc
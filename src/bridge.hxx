@@ -0,0 +1,183 @@
+/*
+ *  bridge.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "io/addr.hxx"
+#include "io/fd.hxx"
+
+namespace fastipc {
+
+/// Transport carrying bridge frames
+enum class BridgeTransport : std::uint8_t {
+    /// Datagrams, each holding as many samples as fit, lost whenever the link cannot keep up
+    Udp = 0,
+    /// Stream of size-prefixed frames, holding back newer samples until the link can take them
+    Tcp = 1,
+};
+
+/// Channel mirrored over a bridge
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct BridgedChannel final {
+    std::string name;
+    std::size_t max_payload_size;
+};
+
+/// Forwards the newest samples of local channels to a remote bridge receiver
+///
+/// Samples are read as they get submitted, yet only the newest sample of each channel is sent whenever the link is
+/// ready for more, skipping those submitted in between. Samples of every changed channel are batched into a frame.
+class BridgeSender final {
+  public:
+    /// Subscribes to the given channels of the tower listening at @a tower_path
+    [[nodiscard]] static BridgeSender create(std::string_view tower_path, std::span<const BridgedChannel> channels,
+                                             const io::SocketAddr& remote, BridgeTransport transport);
+
+    /// Forwards samples until shut down, reconnecting as needed over TCP
+    void run();
+
+    void shutdown();
+
+  private:
+    /// Delay between attempts at connecting to the remote receiver
+    constexpr static std::chrono::seconds kReconnectInterval{1};
+
+    // NOLINTNEXTLINE(altera-struct-pack-align)
+    struct Subscription final {
+        BridgedChannel channel;
+        Reader reader;
+        std::uint64_t last_sequence_id{0U};
+    };
+
+    BridgeSender(std::vector<Subscription> subscriptions, io::Fd epollfd, io::Fd shutdownfd,
+                 const io::SocketAddr& remote, BridgeTransport transport);
+
+    /// Connects to the remote receiver, unless connected already
+    ///
+    /// @return Whether connected, or false if shut down in the meantime
+    [[nodiscard]] bool connect();
+
+    /// Sends the newest sample of every channel which changed since last sent
+    ///
+    /// @return Whether the link is still up
+    [[nodiscard]] bool forward();
+
+    /// Sends the frame built up so far, if it holds any samples
+    ///
+    /// @return Whether the link is still up
+    [[nodiscard]] bool flush();
+
+    /// Waits for the given events on a descriptor, if any, or until the timeout expires
+    ///
+    /// @return Whether the sender is still running, rather than shut down in the meantime
+    [[nodiscard]] bool waitFor(int fd, short events, std::chrono::milliseconds timeout) const;
+
+    std::vector<Subscription> m_subscriptions;
+    io::Fd m_epollfd;
+    io::Fd m_shutdownfd;
+    io::SocketAddr m_remote;
+    BridgeTransport m_transport;
+    // Tells this sender's sequence ids apart from those of earlier ones
+    std::uint64_t m_sender_id;
+    // Invalid while disconnected
+    io::Fd m_sockfd;
+    // Frame being built up, preceded by room for its size over TCP
+    std::vector<std::byte> m_frame;
+    std::size_t m_frame_size{0U};
+    std::uint16_t m_frame_samples{0U};
+};
+
+/// Republishes the samples forwarded by bridge senders into local channels, creating them as needed
+///
+/// Only samples of the channels it was given get republished, and only while the tower accepts them; the others are
+/// dropped.
+class BridgeReceiver final {
+  public:
+    /// Listens at @a local, republishing the given channels into those of the tower listening at @a tower_path
+    [[nodiscard]] static BridgeReceiver create(std::string_view tower_path, std::span<const BridgedChannel> channels,
+                                               const io::SocketAddr& local, BridgeTransport transport);
+
+    /// Address the receiver listens at, with the port picked by the system if it was asked for port 0
+    [[nodiscard]] io::SocketAddr getAddress() const;
+
+    /// Republishes samples until shut down
+    void run();
+
+    void shutdown();
+
+  private:
+    // NOLINTNEXTLINE(altera-struct-pack-align)
+    struct Connection final {
+        io::Fd sockfd;
+        // Bytes received past the last whole frame
+        std::vector<std::byte> pending;
+    };
+
+    // NOLINTNEXTLINE(altera-struct-pack-align)
+    struct Republished final {
+        std::size_t max_payload_size;
+        // Opened on the first sample
+        std::optional<Writer> writer{};
+        // Set once the tower rejected the channel, whose samples then get dropped
+        bool rejected{false};
+        std::uint64_t sender_id{0U};
+        std::uint64_t last_sequence_id{0U};
+    };
+
+    BridgeReceiver(Session session, io::Fd sockfd, io::Fd epollfd, io::Fd shutdownfd, BridgeTransport transport)
+        : m_session{std::move(session)}, m_sockfd{std::move(sockfd)}, m_epollfd{std::move(epollfd)},
+          m_shutdownfd{std::move(shutdownfd)}, m_transport{transport} {}
+
+    /// Receives every pending datagram
+    void receiveDatagrams();
+
+    /// Accepts every pending TCP connection
+    void accept();
+
+    /// Receives whatever a TCP connection has pending, republishing every whole frame
+    ///
+    /// @return Whether to keep the connection
+    [[nodiscard]] bool receive(Connection& connection);
+
+    /// Republishes the samples of a frame which are newer than those republished already
+    ///
+    /// @return Whether the frame was well-formed
+    [[nodiscard]] bool republish(std::span<const std::byte> frame);
+
+    Session m_session;
+    io::Fd m_sockfd;
+    io::Fd m_epollfd;
+    io::Fd m_shutdownfd;
+    BridgeTransport m_transport;
+    std::unordered_map<int, Connection> m_connections;
+    std::unordered_map<std::string, Republished> m_channels;
+    std::vector<std::byte> m_datagram;
+};
+
+} // namespace fastipc
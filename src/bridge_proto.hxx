@@ -0,0 +1,68 @@
+/*
+ *  bridge_proto.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "io/cursor.hxx"
+#include "io/endian.hxx"
+
+namespace fastipc {
+
+/// Leads every bridge frame
+constexpr std::uint32_t kBridgeMagic{0x46494252U}; // "FIBR" NOLINT(*-magic-numbers)
+
+/// Version of the bridge frame format
+///
+/// 1: initial version
+constexpr std::uint16_t kBridgeVersion{1U};
+
+/// Size of a frame header: magic, version, sample count and sender id
+///
+/// The sender id tells apart the sequence ids of successive senders of a channel.
+constexpr std::size_t kBridgeFrameHeaderSize{sizeof(std::uint32_t) + sizeof(std::uint16_t) + sizeof(std::uint16_t) +
+                                             sizeof(std::uint64_t)};
+
+/// Size of a sample header: sequence id, channel max payload size, payload size and channel name size
+///
+/// Every sample header is followed by the channel name, then by the payload.
+constexpr std::size_t kBridgeSampleHeaderSize{sizeof(std::uint64_t) + sizeof(std::uint32_t) + sizeof(std::uint32_t) +
+                                              sizeof(std::uint8_t)};
+
+/// Maximum size of a frame sent over UDP, as fits in a single datagram
+constexpr std::size_t kMaxBridgeDatagramSize{65507U}; // NOLINT(*-magic-numbers)
+
+/// Maximum size of a frame sent over TCP, where frames are preceded by their size
+constexpr std::size_t kMaxBridgeFrameSize{std::size_t{64U} << 20U}; // NOLINT(*-magic-numbers)
+
+/// Writes a value to the wire, in network byte order
+template <typename T, std::size_t extent>
+constexpr void putBe(std::span<std::byte, extent>& buf, T value) noexcept {
+    io::putBuf(buf, io::toBe(value));
+}
+
+/// Reads a value off the wire, in network byte order
+template <typename T, std::size_t extent>
+[[nodiscard]] constexpr T getBe(std::span<const std::byte, extent>& buf) noexcept {
+    return io::fromBe(io::getBuf<T>(buf));
+}
+
+} // namespace fastipc
@@ -0,0 +1,284 @@
+/*
+ *  channel.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "channel.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "io/futex.hxx"
+#include "io/numa.hxx"
+
+namespace fastipc::impl {
+namespace {
+
+/// Publishes the queue positions reserved by the owner of a record as empty samples, so that the queue moves past them
+void abandonReservations(ChannelPage& channel_page, std::uint32_t record) noexcept {
+    const auto tail = channel_page.queue_tail.load(std::memory_order_acquire);
+    const auto head = channel_page.queue_head.load(std::memory_order_acquire);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (auto position = tail; position < head; ++position) {
+        auto& sample = channel_page.queue_slot(position);
+        if (sample.reservation.load(std::memory_order_acquire) != ChannelPage::reservation_of(position, record) ||
+            sample.turn.load(std::memory_order_acquire) != position)
+            continue;
+
+        sample.size = 0U;
+        sample.timestamp = channel_page.read_clock();
+        sample.turn.store(position + 1U, std::memory_order_release);
+    }
+}
+
+} // namespace
+
+void abandonCall(ChannelSample& sample, bool is_client) noexcept {
+    const auto abandoned = is_client ? RpcState::Requested : RpcState::Serving;
+    const auto settled = is_client ? RpcState::Idle : RpcState::Dropped;
+
+    auto state = sample.rpc_state.load(std::memory_order_acquire);
+    // NOLINTNEXTLINE(altera-unroll-loops) Only retried on races with the other end of the call
+    while (rpcStateOf(state) == abandoned) {
+        if (!sample.rpc_state.compare_exchange_weak(state, static_cast<std::uint32_t>(settled),
+                                                    std::memory_order_acq_rel))
+            continue;
+        if ((state & kRpcCallerWaiting) != 0U)
+            io::futexWake(sample.rpc_state);
+        return;
+    }
+}
+
+void releaseRecord(ChannelPage& channel_page, std::size_t record) noexcept {
+    auto& stats = channel_page.stats(record);
+    const auto owner_pid = stats.owner_pid.load(std::memory_order_acquire);
+    const bool is_writer = stats.role == RequesterType::Writer;
+
+    auto* const holdings = channel_page.holdings(record);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t index{0U}; index < channel_page.slot_count; ++index) {
+        const auto count = holdings[index].exchange(0U, std::memory_order_relaxed);
+        if (count == 0U)
+            continue;
+
+        // Samples abandoned mid-write are left with an odd sequence lock, which the next writer would flip even.
+        auto& seqlock = channel_page[index].seqlock;
+        if (const auto sequence = seqlock.load(std::memory_order_relaxed); is_writer && (sequence & 1U) != 0U)
+            seqlock.store(sequence + 1U, std::memory_order_release);
+        if (channel_page.kind == ChannelKind::Rpc)
+            abandonCall(channel_page[index], is_writer);
+
+        releaseSample(channel_page, index, count);
+    }
+
+    if (const auto armed = stats.armed.exchange(0U, std::memory_order_relaxed); armed != 0U)
+        channel_page.armed_count.fetch_sub(armed, std::memory_order_relaxed);
+    if (const auto waiting = stats.waiting.exchange(0U, std::memory_order_relaxed); waiting != 0U)
+        channel_page.waiter_count.fetch_sub(waiting, std::memory_order_relaxed);
+
+    if (channel_page.kind == ChannelKind::Queue) {
+        if (is_writer) {
+            abandonReservations(channel_page, static_cast<std::uint32_t>(record));
+        } else {
+            auto reader_pid = owner_pid;
+            static_cast<void>(
+                channel_page.queue_reader_pid.compare_exchange_strong(reader_pid, 0, std::memory_order_release));
+        }
+    }
+
+    // Claimed again, a record is taken for foreign until its claimant records its own namespace.
+    stats.owner_pid_namespace.store(0U, std::memory_order_relaxed);
+    stats.owner_pid.store(0, std::memory_order_release);
+}
+
+bool isUnused(const ChannelPage& channel_page) noexcept {
+    if (channel_page.untracked_endpoints.load(std::memory_order_acquire) != 0U)
+        return false;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the record count
+    for (std::size_t record{0U}; record < channel_page.record_count; ++record) {
+        if (channel_page.stats(record).owner_pid.load(std::memory_order_acquire) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+std::size_t historyDepthFor(const ClientRequest& request) noexcept {
+    return request.kind != ChannelKind::Mailbox
+               ? 1U
+               : std::clamp<std::size_t>(request.history_depth, 1U, ChannelPage::kMaxHistoryDepth);
+}
+
+std::size_t traceDepthFor(const ClientRequest& request) noexcept {
+    return std::min<std::size_t>(request.trace_depth, ChannelPage::kMaxTraceDepth);
+}
+
+std::size_t writerLanesFor(const ClientRequest& request) noexcept {
+    // Queue writers take turns rather than slots.
+    return request.kind == ChannelKind::Queue ? 1U
+                                              : std::clamp<std::size_t>(request.writer_lanes, 1U, kMaxWriterLanes);
+}
+
+std::size_t recordCountFor(const ClientRequest& request) noexcept {
+    return std::clamp<std::size_t>(request.endpoint_records, 1U, ChannelPage::kMaxRecordCount);
+}
+
+std::size_t slotCountFor(const ClientRequest& request) noexcept {
+    // The latest sample is accounted for by the requested slot count.
+    const auto slot_count =
+        std::max<std::size_t>(request.slot_count, ChannelPage::kMinSlotCount) + historyDepthFor(request) - 1U;
+    return std::min(slot_count, ChannelPage::kMaxSlotCount);
+}
+
+std::size_t pageSizeFor(const ClientRequest& request) noexcept {
+    return ChannelPage::total_size(request.max_payload_size, slotCountFor(request), writerLanesFor(request),
+                                   historyDepthFor(request), traceDepthFor(request), recordCountFor(request));
+}
+
+ChannelPage& initChannelPage(void* memory, const ClientRequest& request, PageBacking backing) noexcept {
+    const auto history_depth = historyDepthFor(request);
+    const auto slot_count = slotCountFor(request);
+    const auto trace_depth = traceDepthFor(request);
+    const auto writer_lanes = writerLanesFor(request);
+    const auto record_count = recordCountFor(request);
+
+    auto& channel_page = *::new (memory) ChannelPage;
+    channel_page.page_backing = backing;
+    channel_page.kind = request.kind;
+    channel_page.max_payload_size = request.max_payload_size;
+    channel_page.slot_count = slot_count;
+    channel_page.history_depth = history_depth;
+    channel_page.writer_lanes = writer_lanes;
+    channel_page.lane_slot_count = ChannelPage::lane_slot_count_for(slot_count, writer_lanes);
+    channel_page.lane_word_stride = ChannelPage::lane_word_stride_for(slot_count, writer_lanes);
+    channel_page.trace_depth = trace_depth;
+    channel_page.record_count = record_count;
+    channel_page.clock = request.clock;
+    channel_page.sample_stride = ChannelPage::sample_stride_for(request.max_payload_size);
+    const auto occupancy_word_count = channel_page.occupancy_word_count();
+    channel_page.history_offset = ChannelPage::history_offset_for(occupancy_word_count);
+    channel_page.stats_offset = ChannelPage::stats_offset_for(occupancy_word_count, history_depth);
+    channel_page.holdings_offset = ChannelPage::holdings_offset_for(occupancy_word_count, history_depth, record_count);
+    channel_page.holdings_stride = ChannelPage::holdings_stride_for(slot_count);
+    channel_page.trace_offset =
+        ChannelPage::trace_offset_for(slot_count, occupancy_word_count, history_depth, record_count);
+    channel_page.samples_offset =
+        ChannelPage::samples_offset_for(slot_count, occupancy_word_count, history_depth, trace_depth, record_count);
+    channel_page.next_seq_id.store(1U, std::memory_order_relaxed);
+
+    // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+    for (std::size_t word{0U}; word < channel_page.occupancy_word_count(); ++word) {
+        // Permanently mark the padding bits past the end of every lane as occupied
+        const auto lane = word / channel_page.lane_word_stride;
+        const auto first_slot = (lane * channel_page.lane_slot_count) +
+                                ((word % channel_page.lane_word_stride) * ChannelPage::kOccupancyWordBits);
+        const auto lane_end = std::min((lane + 1U) * channel_page.lane_slot_count, slot_count);
+        const auto valid_bits =
+            first_slot >= lane_end ? 0U : std::min(lane_end - first_slot, ChannelPage::kOccupancyWordBits);
+        const auto padding =
+            valid_bits == ChannelPage::kOccupancyWordBits ? std::uint64_t{0U} : ~std::uint64_t{0U} << valid_bits;
+        ::new (&channel_page.occupancy(word)) std::atomic_uint64_t{padding};
+    }
+
+    // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+    for (std::size_t position{0U}; position < history_depth; ++position)
+        ::new (&channel_page.history(position)) std::atomic_size_t{ChannelPage::kNoSample};
+
+    // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+    for (std::size_t record{0U}; record < channel_page.record_count; ++record)
+        ::new (&channel_page.stats(record)) EndpointStats;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+    for (std::size_t position{0U}; position < trace_depth; ++position)
+        ::new (&channel_page.trace(position)) TraceEntry;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+    for (std::size_t i{0U}; i < slot_count; ++i)
+        ::new (&channel_page[i]) ChannelSample;
+
+    if (request.kind == ChannelKind::Queue) {
+        // Every slot awaits the first lap of queue positions.
+        // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
+        for (std::size_t i{0U}; i < slot_count; ++i)
+            channel_page[i].turn.store(i, std::memory_order_relaxed);
+    } else if (request.kind == ChannelKind::Mailbox) {
+        // Reserve the first sample as default latest, the reference being held by the channel itself
+        channel_page[0U].ref_count.store(1U, std::memory_order_relaxed);
+        occupancyWord(channel_page, 0U).fetch_or(occupancyBit(channel_page, 0U), std::memory_order_relaxed);
+
+        if (history_depth > 1U) {
+            // The history holds a reference of its own.
+            channel_page[0U].ref_count.fetch_add(1U, std::memory_order_relaxed);
+            channel_page.history(0U).store(0U, std::memory_order_relaxed);
+            channel_page.history_head.store(1U, std::memory_order_relaxed);
+        }
+    }
+
+    return channel_page;
+}
+
+io::expected<bool> bindChannel(ChannelPage& channel_page, std::size_t mapped_size, std::int32_t node) noexcept {
+    auto unbound = kNoNumaNode;
+    if (node < 0 || !channel_page.numa_node.compare_exchange_strong(unbound, node, std::memory_order_acq_rel))
+        return false;
+
+    if (auto res = io::preferNumaNode(&channel_page, mapped_size, node); !res.has_value()) {
+        channel_page.numa_node.store(kNoNumaNode, std::memory_order_release);
+        return io::unexpected{res.error()};
+    }
+    return true;
+}
+
+std::uint32_t claimRecord(ChannelPage& channel_page, std::int32_t pid, std::uint64_t pid_namespace,
+                          RequesterType role) noexcept {
+    // NOLINTNEXTLINE(altera-unroll-loops) Only done when opening channels
+    for (std::size_t record{0U}; pid != 0 && record < channel_page.record_count; ++record) {
+        auto& stats = channel_page.stats(record);
+        std::int32_t free_pid{0};
+        if (stats.owner_pid.load(std::memory_order_relaxed) != 0 ||
+            !stats.owner_pid.compare_exchange_strong(free_pid, pid, std::memory_order_acquire))
+            continue;
+
+        // Only the owner and inspection touch a claimed record, the latter being fine with it settling in.
+        stats.role = role;
+        for (auto* const counter :
+             {&stats.prepares, &stats.submits, &stats.prepare_retries, &stats.prepare_yields, &stats.racy_hints,
+              &stats.acquires, &stats.releases, &stats.acquire_retries, &stats.copy_retries,
+              &stats.skipped_sequence_ids})
+            counter->store(0U, std::memory_order_relaxed);
+        stats.armed.store(0U, std::memory_order_relaxed);
+        stats.waiting.store(0U, std::memory_order_relaxed);
+        stats.notify_fd.store(-1, std::memory_order_relaxed);
+        stats.owner_start_time.store(0U, std::memory_order_relaxed);
+        stats.owner_pid_namespace.store(pid_namespace, std::memory_order_relaxed);
+
+        auto* const holdings = channel_page.holdings(record);
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+        for (std::size_t index{0U}; index < channel_page.slot_count; ++index)
+            holdings[index].store(0U, std::memory_order_relaxed);
+
+        return static_cast<std::uint32_t>(record);
+    }
+
+    channel_page.untracked_endpoints.fetch_add(1U, std::memory_order_relaxed);
+    return ChannelPage::kNoRecord;
+}
+
+} // namespace fastipc::impl
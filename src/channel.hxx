@@ -21,48 +21,529 @@
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "fastipc.hxx"
+#include "io/result.hxx"
+#include "local_proto.hxx"
 
 namespace fastipc::impl {
 
+/// Version of the shared memory layout below, bumped on every incompatible change
+constexpr std::uint32_t kLayoutVersion{20U};
+
+/// Assumed size of a cache line, used to keep independently written words apart
+constexpr std::size_t kCacheLineSize{64U};
+
+/// Size of the huge pages backing channels, the default one on x86-64 and arm64 with 4 KiB base pages
+constexpr std::size_t kHugePageSize{std::size_t{2U} << 20U}; // NOLINT(*-magic-numbers)
+
+[[nodiscard]] constexpr std::size_t alignUp(std::size_t value, std::size_t alignment) noexcept {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+
+__extension__ using WideUint = unsigned __int128;
+
+/// Low bits of the latest word holding the index of the latest sample, the others holding its sequence id
+constexpr unsigned kLatestIndexBits{24U};
+constexpr std::uint64_t kLatestIndexMask{(std::uint64_t{1U} << kLatestIndexBits) - 1U};
+
+/// Packs the index and sequence id of a sample into a latest word, wrapping the sequence id around
+[[nodiscard]] constexpr std::uint64_t latestWordOf(std::size_t index, std::uint64_t sequence_id) noexcept {
+    return (sequence_id << kLatestIndexBits) | index;
+}
+
+[[nodiscard]] constexpr std::size_t latestIndexOf(std::uint64_t word) noexcept { return word & kLatestIndexMask; }
+
+/// Whether a sequence id is newer than the one packed in a latest word
+///
+/// Sequence ids get compared modulo the bits they are packed into, which is exact as long as concurrent writers are
+/// less than half that range apart.
+[[nodiscard]] constexpr bool isNewerThan(std::uint64_t sequence_id, std::uint64_t word) noexcept {
+    return static_cast<std::int64_t>((sequence_id << kLatestIndexBits) - (word & ~kLatestIndexMask)) > 0;
+}
+
+/// Largest payload channels may carry, keeping their size far from overflowing
+constexpr std::size_t kMaxPayloadSize{std::size_t{1U} << 30U}; // NOLINT(*-magic-numbers)
+
+/// Largest channel page created on request, however its settings add up
+constexpr std::size_t kMaxChannelSize{std::size_t{1U} << 36U}; // NOLINT(*-magic-numbers)
+
+/// Most lanes a channel may be split into for its writers
+constexpr std::size_t kMaxWriterLanes{64U};
+
+/// Fractional bits of the time stamp counter's fixed-point rate
+constexpr unsigned kTscScaleBits{32U};
+
+/// Reads the time stamp counter, which only ever backs channels on ChannelClock::Tsc where available
+[[nodiscard]] inline std::uint64_t readTsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+/// Nanoseconds elapsed since the epoch of a clock
+template <typename Clock>
+[[nodiscard]] std::uint64_t nanosecondsOf(typename Clock::time_point time) noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+/// Progress of the call held in a slot of an RPC channel
+enum class RpcState : std::uint32_t {
+    // Being prepared by the client, or withdrawn
+    Idle = 0,
+    // Posted, awaiting a server
+    Requested = 1,
+    // Accepted by a server, which holds a reference of its own until replying
+    Serving = 2,
+    // Replied to in place
+    Replied = 3,
+    // Abandoned by a server gone while serving it
+    Dropped = 4,
+};
+
+/// Set along the RPC state while the client sleeps on it, for the server to only pay for a wake-up when needed
+constexpr std::uint32_t kRpcCallerWaiting{1U << 31U};
+
+[[nodiscard]] constexpr RpcState rpcStateOf(std::uint32_t word) noexcept {
+    return static_cast<RpcState>(word & ~kRpcCallerWaiting);
+}
+
 // NOLINTNEXTLINE(altera-struct-pack-align)
 struct ChannelSample final {
-    std::atomic_size_t ref_count{0U};
+    // Reader-owned control words
+    alignas(kCacheLineSize) std::atomic_size_t ref_count{0U};
+    // Queue-only: queue position the slot may next be written at, plus one once the sample written there is
+    // published, reaching the position one lap later once the reader is done with it
+    std::atomic_uint64_t turn{0U};
+    // Rpc-only: RpcState of the call, possibly along kRpcCallerWaiting
+    std::atomic_uint32_t rpc_state{0U};
+
+    // Writer-owned header, only written while the sample is exclusively held
+    // Sequence lock guarding copy-out reads, odd while the sample is being written
+    alignas(kCacheLineSize) std::atomic_uint64_t seqlock{0U};
     std::size_t sequence_id{0U};
+    // Number of payload bytes submitted
     std::size_t size{0U};
-    std::chrono::system_clock::time_point timestamp;
+    // Submission time, as read from the channel clock
+    std::uint64_t timestamp{0U};
+    // Version of every payload block not found newer in the trailing block versions, that is the sequence id of the
+    // sample which last wrote them
+    std::uint64_t base_version{0U};
+    // Lowest sequence id from which the block versions tell changes apart, each sample since having been prepared
+    // from its predecessor
+    std::uint64_t chain_start{0U};
+    // Queue-only: stamp of the writer holding the slot's current queue position, see ChannelPage::reservation_of()
+    std::atomic_uint64_t reservation{0U};
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
-    std::byte payload[0]; // NOLINT(*-c-arrays)
+    alignas(kCacheLineSize) std::byte payload[0]; // NOLINT(*-c-arrays)
 #pragma GCC diagnostic pop
+    // Trailing storage: payload, followed by the version of every payload block
+};
+
+/// Counters of a single Reader or Writer
+///
+/// Records sit on their own cache lines and are only ever written by the
+/// endpoint owning them, hence keeping them costs no contended writes.
+/// Along with the slot holdings of the endpoint, they tell the tower what to
+/// give back once the owning process is gone.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct EndpointStats final {
+    // Process owning the record, zero while free; claimed by the tower on behalf of its clients
+    alignas(kCacheLineSize) std::atomic_int32_t owner_pid{0};
+    RequesterType role{RequesterType::Reader};
+    // Contributions to the channel's armed and waiting reader counts
+    std::atomic_uint32_t armed{0U};
+    std::atomic_uint32_t waiting{0U};
+    // Number of the channel's notification descriptor within the owning process, for a restarted tower to recover
+    std::atomic_int32_t notify_fd{-1};
+    // Start time of the owning process, telling it apart from any later one reusing its id; zero if unknown
+    std::atomic_uint64_t owner_start_time{0U};
+    // PID namespace the owner's process id belongs to, as the inode of its /proc entry; zero until known
+    std::atomic_uint64_t owner_pid_namespace{0U};
+
+    // Writer counters
+    std::atomic_uint64_t prepares{0U};
+    std::atomic_uint64_t submits{0U};
+    // Scans of the channel coming out without a free slot
+    std::atomic_uint64_t prepare_retries{0U};
+    std::atomic_uint64_t prepare_yields{0U};
+    // Slots hinted as free, yet claimed by the time we got to them
+    std::atomic_uint64_t racy_hints{0U};
+
+    // Reader counters
+    std::atomic_uint64_t acquires{0U};
+    std::atomic_uint64_t releases{0U};
+    // Acquisitions of a sample which got recycled under our feet
+    std::atomic_uint64_t acquire_retries{0U};
+    // Copies torn by a concurrent writer
+    std::atomic_uint64_t copy_retries{0U};
+    // Sequence ids never observed, being overwritten before we got to them
+    std::atomic_uint64_t skipped_sequence_ids{0U};
+};
+
+/// Timeline of a traced sample, as read from the channel clock
+///
+/// Entries are reused every trace depth sequence ids, each on its own cache line so that tracing a sample never
+/// contends with tracing its neighbours.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct TraceEntry final {
+    // Sequence id traced, zero while the entry is being reset
+    alignas(kCacheLineSize) std::atomic_uint64_t sequence_id{0U};
+    std::atomic_uint64_t prepared{0U};
+    // Zero until submitted
+    std::atomic_uint64_t submitted{0U};
+    // First acquisition by any reader, zero until then
+    std::atomic_uint64_t acquired{0U};
 };
 
 // NOLINTNEXTLINE(altera-struct-pack-align)
 struct ChannelPage final {
+    constexpr static std::size_t kOccupancyWordBits = std::numeric_limits<std::uint64_t>::digits;
+    // The latest sample, plus one being prepared
+    constexpr static std::size_t kMinSlotCount = 2U;
+    // Slots addressable by the latest word
+    constexpr static std::size_t kMaxSlotCount = std::size_t{1U} << kLatestIndexBits;
+    // History entries pinning all but the slot being prepared
+    constexpr static std::size_t kMaxHistoryDepth = kMaxSlotCount - kMinSlotCount + 1U;
+    // Trace entries, a few MiB at most
+    constexpr static std::size_t kMaxTraceDepth = std::size_t{1U} << 16U; // NOLINT(*-magic-numbers)
+    // Endpoints beyond this many go untracked, however many records are asked for
+    constexpr static std::size_t kMaxRecordCount = 64U;
+    // Record of untracked endpoints
+    constexpr static std::uint32_t kNoRecord = std::numeric_limits<std::uint32_t>::max();
+    // Empty history entry
+    constexpr static std::size_t kNoSample = std::numeric_limits<std::size_t>::max();
+
+    // Immutable after creation
+    alignas(kCacheLineSize) std::uint32_t layout_version{kLayoutVersion};
     std::size_t max_payload_size{0U};
-    std::atomic_size_t next_seq_id{0U};
-    std::atomic_uint64_t occupancy{0U};
-    std::atomic_size_t latest_sample_index{0U};
+    std::size_t slot_count{0U};
+    std::size_t sample_stride{0U};
+    // Effective backing, after falling back from huge pages
+    PageBacking page_backing{PageBacking::Default};
+    ChannelKind kind{ChannelKind::Mailbox};
+    // Number of newest samples referenced by the history
+    std::size_t history_depth{1U};
+    // Number of lanes the slots are split into, each with occupancy words on cache lines of their own
+    std::size_t writer_lanes{1U};
+    // Slots per lane, the last lanes holding fewer or none if the slot count does not split evenly
+    std::size_t lane_slot_count{0U};
+    // Occupancy words per lane, padded to whole cache lines
+    std::size_t lane_word_stride{0U};
+    // Effective clock, after falling back from the time stamp counter
+    ChannelClock clock{ChannelClock::System};
+    // Number of sequence ids traced at once, zero if tracing is disabled
+    std::size_t trace_depth{0U};
+    // Number of endpoint stats records, each with its holdings
+    std::size_t record_count{0U};
+    // Offsets of the trailing storage regions, as derived from the settings above, sparing every access the sums
+    std::size_t history_offset{0U};
+    std::size_t stats_offset{0U};
+    std::size_t holdings_offset{0U};
+    std::size_t holdings_stride{0U};
+    std::size_t trace_offset{0U};
+    std::size_t samples_offset{0U};
+    // Time stamp counter reading taken along with a steady clock one, from which on counter ticks get converted
+    std::uint64_t tsc_base_ticks{0U};
+    std::uint64_t tsc_base_ns{0U};
+
+    // Tower-owned: steady clock nanoseconds per time stamp counter tick, in fixed point with kTscScaleBits fractional
+    // bits, refined periodically as the span since the base readings grows
+    alignas(kCacheLineSize) std::atomic_uint64_t tsc_scale{0U};
+    // Node the channel memory is preferably allocated on, set once by whoever binds it first
+    std::atomic_int32_t numa_node{kNoNumaNode};
+
+    // Writer-owned, only read by readers
+    alignas(kCacheLineSize) std::atomic_size_t next_seq_id{0U};
+    // Index and sequence id of the latest sample, as packed by latestWordOf
+    std::atomic_uint64_t latest{0U};
+    std::atomic_uint32_t notify_epoch{0U};
+    // Lane to hand out to the next writer
+    std::atomic_uint32_t next_lane{0U};
+    // Queue-only: next queue position to hand out to writers
+    std::atomic_uint64_t queue_head{0U};
+    // Number of samples ever pushed into the history
+    std::atomic_uint64_t history_head{0U};
+
+    // Reader-owned
+    alignas(kCacheLineSize) std::atomic_uint32_t waiter_count{0U};
+    std::atomic_uint32_t armed_count{0U};
+    // Queue-only: process owning the reading end, zero while free
+    std::atomic_int32_t queue_reader_pid{0};
+    // Queue-only: oldest queue position not yet released by the reader
+    std::atomic_uint64_t queue_tail{0U};
+    // Endpoints left without a stats record, which keep the channel in use until they are gone
+    std::atomic_uint32_t untracked_endpoints{0U};
+
+    // Trailing storage: occupancy hint bitmap, followed by the history ring of sample indices, followed by the endpoint
+    // stats records, followed by the references every record holds per slot, followed by the trace ring, followed by
+    // the samples, each on their own cache lines
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
-    alignas(ChannelSample) std::byte samples_storage[0]; // NOLINT(*-c-arrays)
+    alignas(kCacheLineSize) std::byte storage[0]; // NOLINT(*-c-arrays)
 #pragma GCC diagnostic pop
 
-    [[nodiscard]] std::size_t sample_size() const { return sizeof(ChannelSample) + max_payload_size; }
-    [[nodiscard]] std::size_t index_of(const ChannelSample& sample) const {
-        return (reinterpret_cast<const std::byte*>(&sample) - samples_storage) / sample_size();
+    [[nodiscard]] constexpr static std::size_t lane_slot_count_for(std::size_t slot_count,
+                                                                   std::size_t writer_lanes) noexcept {
+        return (slot_count + writer_lanes - 1U) / writer_lanes;
+    }
+    [[nodiscard]] constexpr static std::size_t lane_word_stride_for(std::size_t slot_count,
+                                                                    std::size_t writer_lanes) noexcept {
+        const auto lane_word_count = (lane_slot_count_for(slot_count, writer_lanes) + kOccupancyWordBits - 1U) /
+                                     kOccupancyWordBits;
+        return alignUp(lane_word_count, kCacheLineSize / sizeof(std::atomic_uint64_t));
+    }
+    [[nodiscard]] constexpr static std::size_t occupancy_word_count(std::size_t slot_count,
+                                                                    std::size_t writer_lanes) noexcept {
+        return writer_lanes * lane_word_stride_for(slot_count, writer_lanes);
+    }
+    [[nodiscard]] constexpr static std::size_t history_offset_for(std::size_t occupancy_word_count) noexcept {
+        return occupancy_word_count * sizeof(std::atomic_uint64_t);
+    }
+    [[nodiscard]] constexpr static std::size_t stats_offset_for(std::size_t occupancy_word_count,
+                                                                std::size_t history_depth) noexcept {
+        return history_offset_for(occupancy_word_count) +
+               alignUp(history_depth * sizeof(std::atomic_size_t), kCacheLineSize);
+    }
+    [[nodiscard]] constexpr static std::size_t holdings_offset_for(std::size_t occupancy_word_count,
+                                                                   std::size_t history_depth,
+                                                                   std::size_t record_count) noexcept {
+        return stats_offset_for(occupancy_word_count, history_depth) + (record_count * sizeof(EndpointStats));
+    }
+    [[nodiscard]] constexpr static std::size_t holdings_stride_for(std::size_t slot_count) noexcept {
+        return alignUp(slot_count * sizeof(std::atomic_uint32_t), kCacheLineSize);
+    }
+    [[nodiscard]] constexpr static std::size_t trace_offset_for(std::size_t slot_count,
+                                                                std::size_t occupancy_word_count,
+                                                                std::size_t history_depth,
+                                                                std::size_t record_count) noexcept {
+        return holdings_offset_for(occupancy_word_count, history_depth, record_count) +
+               (record_count * holdings_stride_for(slot_count));
+    }
+    [[nodiscard]] constexpr static std::size_t samples_offset_for(std::size_t slot_count,
+                                                                  std::size_t occupancy_word_count,
+                                                                  std::size_t history_depth, std::size_t trace_depth,
+                                                                  std::size_t record_count) noexcept {
+        return trace_offset_for(slot_count, occupancy_word_count, history_depth, record_count) +
+               (trace_depth * sizeof(TraceEntry));
+    }
+    [[nodiscard]] constexpr static std::size_t block_count_for(std::size_t max_payload_size) noexcept {
+        return (max_payload_size + kDirtyBlockSize - 1U) / kDirtyBlockSize;
+    }
+    [[nodiscard]] constexpr static std::size_t block_versions_offset(std::size_t max_payload_size) noexcept {
+        return alignUp(max_payload_size, alignof(std::uint64_t));
+    }
+    [[nodiscard]] constexpr static std::size_t sample_stride_for(std::size_t max_payload_size) noexcept {
+        return alignUp(sizeof(ChannelSample) + block_versions_offset(max_payload_size) +
+                           (block_count_for(max_payload_size) * sizeof(std::uint64_t)),
+                       kCacheLineSize);
+    }
+
+    [[nodiscard]] std::size_t occupancy_word_count() const { return writer_lanes * lane_word_stride; }
+    [[nodiscard]] std::size_t block_count() const { return block_count_for(max_payload_size); }
+
+    [[nodiscard]] std::atomic_uint64_t& occupancy(std::size_t word) {
+        return reinterpret_cast<std::atomic_uint64_t*>(storage)[word];
+    }
+
+    /// Entry of the history ring holding the sample pushed at the given position
+    [[nodiscard]] std::atomic_size_t& history(std::uint64_t position) {
+        return reinterpret_cast<std::atomic_size_t*>(
+            &storage[history_offset])[static_cast<std::size_t>(position % history_depth)];
+    }
+
+    [[nodiscard]] EndpointStats& stats(std::size_t record) {
+        return reinterpret_cast<EndpointStats*>(&storage[stats_offset])[record];
+    }
+    [[nodiscard]] const EndpointStats& stats(std::size_t record) const {
+        return reinterpret_cast<const EndpointStats*>(&storage[stats_offset])[record];
+    }
+
+    /// References held by the endpoint owning a record, per slot
+    ///
+    /// Endpoints count a reference only once they have taken it, and uncount it before giving it
+    /// up or away, so that a crash in between can only ever leak it rather than release it twice.
+    [[nodiscard]] std::atomic_uint32_t* holdings(std::size_t record) {
+        return reinterpret_cast<std::atomic_uint32_t*>(&storage[holdings_offset + (record * holdings_stride)]);
+    }
+
+    /// Entry of the trace ring tracing the given sequence id
+    [[nodiscard]] TraceEntry& trace(std::uint64_t sequence_id) {
+        return reinterpret_cast<TraceEntry*>(
+            &storage[trace_offset])[static_cast<std::size_t>(sequence_id % trace_depth)];
+    }
+    [[nodiscard]] const TraceEntry& trace(std::uint64_t sequence_id) const {
+        return reinterpret_cast<const TraceEntry*>(
+            &storage[trace_offset])[static_cast<std::size_t>(sequence_id % trace_depth)];
     }
 
     [[nodiscard]] const ChannelSample& operator[](std::size_t index) const {
-        return *reinterpret_cast<const ChannelSample*>(&samples_storage[index * sample_size()]);
+        return *reinterpret_cast<const ChannelSample*>(&storage[samples_offset + (index * sample_stride)]);
     }
     [[nodiscard]] ChannelSample& operator[](std::size_t index) {
-        return *reinterpret_cast<ChannelSample*>(&samples_storage[index * sample_size()]);
+        return *reinterpret_cast<ChannelSample*>(&storage[samples_offset + (index * sample_stride)]);
+    }
+
+    /// Versions of the payload blocks of a sample
+    [[nodiscard]] std::uint64_t* block_versions(ChannelSample& sample) const {
+        return reinterpret_cast<std::uint64_t*>(&sample.payload[block_versions_offset(max_payload_size)]);
+    }
+    [[nodiscard]] const std::uint64_t* block_versions(const ChannelSample& sample) const {
+        return reinterpret_cast<const std::uint64_t*>(&sample.payload[block_versions_offset(max_payload_size)]);
+    }
+
+    /// Slot backing the given queue position
+    [[nodiscard]] ChannelSample& queue_slot(std::uint64_t position) {
+        return (*this)[static_cast<std::size_t>(position % slot_count)];
+    }
+    [[nodiscard]] const ChannelSample& queue_slot(std::uint64_t position) const {
+        return (*this)[static_cast<std::size_t>(position % slot_count)];
+    }
+
+    /// Stamp left by the writer reserving a queue position, which previous laps cannot collide with
+    [[nodiscard]] constexpr static std::uint64_t reservation_of(std::uint64_t position, std::uint32_t record) noexcept {
+        constexpr unsigned kRecordBits = 8U;
+        static_assert(kMaxRecordCount < (1U << kRecordBits));
+        return ((position + 1U) << kRecordBits) | (record & ((1U << kRecordBits) - 1U));
+    }
+
+    /// Reads the channel clock, in time stamp counter ticks or nanoseconds
+    [[nodiscard]] std::uint64_t read_clock() const noexcept {
+        switch (clock) {
+        case ChannelClock::Tsc:
+            return readTsc();
+        case ChannelClock::Steady:
+            return nanosecondsOf<std::chrono::steady_clock>(std::chrono::steady_clock::now());
+        case ChannelClock::System:
+        default:
+            return nanosecondsOf<std::chrono::system_clock>(std::chrono::system_clock::now());
+        }
+    }
+
+    /// Nanoseconds elapsed between two readings of the channel clock
+    [[nodiscard]] std::uint64_t clock_span(std::uint64_t from, std::uint64_t to) const noexcept {
+        if (clock != ChannelClock::Tsc)
+            return to - from;
+        return static_cast<std::uint64_t>((WideUint{to - from} * tsc_scale.load(std::memory_order_relaxed)) >>
+                                          kTscScaleBits);
     }
 
-    [[nodiscard]] constexpr static std::size_t total_size(std::size_t max_payload_size) noexcept {
+    /// Nanoseconds since the epoch of the channel clock, the steady clock's for the time stamp counter, of a reading
+    [[nodiscard]] std::uint64_t clock_time(std::uint64_t reading) const noexcept {
+        if (clock != ChannelClock::Tsc)
+            return reading;
+        // Counters of distinct cores may lag slightly behind the base reading.
+        return reading >= tsc_base_ticks ? tsc_base_ns + clock_span(tsc_base_ticks, reading)
+                                         : tsc_base_ns - clock_span(reading, tsc_base_ticks);
+    }
+
+    [[nodiscard]] constexpr static std::size_t total_size(std::size_t max_payload_size, std::size_t slot_count,
+                                                          std::size_t writer_lanes, std::size_t history_depth,
+                                                          std::size_t trace_depth, std::size_t record_count) noexcept {
         return sizeof(ChannelPage) +
-               (std::numeric_limits<std::uint64_t>::digits * (sizeof(ChannelSample) + max_payload_size));
+               samples_offset_for(slot_count, occupancy_word_count(slot_count, writer_lanes), history_depth,
+                                  trace_depth, record_count) +
+               (slot_count * sample_stride_for(max_payload_size));
     }
 };
 
+/// Writer lane a sample belongs to
+[[nodiscard]] inline std::size_t laneOf(const ChannelPage& channel_page, std::size_t index) noexcept {
+    // Spares single-lane channels the division.
+    return channel_page.writer_lanes == 1U ? 0U : index / channel_page.lane_slot_count;
+}
+
+[[nodiscard]] inline std::uint64_t occupancyBit(const ChannelPage& channel_page, std::size_t index) noexcept {
+    const auto lane_index = index - (laneOf(channel_page, index) * channel_page.lane_slot_count);
+    return std::uint64_t{1U} << (lane_index % ChannelPage::kOccupancyWordBits);
+}
+
+[[nodiscard]] inline std::atomic_uint64_t& occupancyWord(ChannelPage& channel_page, std::size_t index) noexcept {
+    const auto lane = laneOf(channel_page, index);
+    const auto lane_index = index - (lane * channel_page.lane_slot_count);
+    return channel_page.occupancy((lane * channel_page.lane_word_stride) +
+                                  (lane_index / ChannelPage::kOccupancyWordBits));
+}
+
+/// Drops references to a sample, clearing its occupancy hint when they were the last
+///
+/// @return Whether the references were the last ones
+inline bool releaseSample(ChannelPage& channel_page, std::size_t index, std::size_t count = 1U) noexcept {
+    const auto previous_count = channel_page[index].ref_count.fetch_sub(count, std::memory_order_acq_rel);
+    if (previous_count != count)
+        return false;
+
+    occupancyWord(channel_page, index).fetch_and(~occupancyBit(channel_page, index), std::memory_order_relaxed);
+    return true;
+}
+
+/// Settles the call held in a slot of an RPC channel on behalf of an endpoint letting go of its reference
+///
+/// Requests still posted are withdrawn, for servers never to pick them up from a slot about to be freed, and calls
+/// being served are dropped, waking up their client.
+void abandonCall(ChannelSample& sample, bool is_client) noexcept;
+
+/// Gives back everything the endpoint owning a record still holds on to, then frees the record
+///
+/// Run by endpoints on destruction, and by the tower on behalf of those whose process is gone.
+void releaseRecord(ChannelPage& channel_page, std::size_t record) noexcept;
+
+/// Whether no endpoint has the channel open, tracked or not
+[[nodiscard]] bool isUnused(const ChannelPage& channel_page) noexcept;
+
+/// Number of history entries of a channel created on request; only mailboxes have more than the latest sample, and
+/// never so many that writers run out of slots to prepare in
+[[nodiscard]] std::size_t historyDepthFor(const ClientRequest& request) noexcept;
+
+/// Number of trace entries of a channel created on request
+[[nodiscard]] std::size_t traceDepthFor(const ClientRequest& request) noexcept;
+
+/// Number of writer lanes of a channel created on request
+[[nodiscard]] std::size_t writerLanesFor(const ClientRequest& request) noexcept;
+
+/// Number of endpoint stats records of a channel created on request
+[[nodiscard]] std::size_t recordCountFor(const ClientRequest& request) noexcept;
+
+/// Number of slots of a channel created on request, every history entry but the latest taking one of its own
+[[nodiscard]] std::size_t slotCountFor(const ClientRequest& request) noexcept;
+
+/// Size of the page of a channel created on request
+[[nodiscard]] std::size_t pageSizeFor(const ClientRequest& request) noexcept;
+
+/// Sets up a channel page as requested in zeroed memory, on the requested clock whether or not it is usable yet
+ChannelPage& initChannelPage(void* memory, const ClientRequest& request, PageBacking backing) noexcept;
+
+/// Has the memory of a channel preferably allocated on the given node, unless it is bound to some node already or
+/// none is given
+///
+/// Endpoints may map the channel already, in which case its pages are only migrated as far as the kernel allows.
+///
+/// @return Whether the channel got bound
+[[nodiscard]] io::expected<bool> bindChannel(ChannelPage& channel_page, std::size_t mapped_size,
+                                             std::int32_t node) noexcept;
+
+/// Takes a free stats record of the channel on behalf of a process, counting the endpoint as untracked if none is
+/// left
+///
+/// Records are claimed by compare-and-swap, as both the tower and directly attached endpoints claim them. The process
+/// id is taken as seen from @a pid_namespace.
+[[nodiscard]] std::uint32_t claimRecord(ChannelPage& channel_page, std::int32_t pid, std::uint64_t pid_namespace,
+                                        RequesterType role) noexcept;
+
+static_assert(offsetof(ChannelSample, payload) % kCacheLineSize == 0U);
+static_assert(sizeof(ChannelPage) % kCacheLineSize == 0U);
+static_assert(sizeof(EndpointStats) % kCacheLineSize == 0U);
+static_assert(sizeof(TraceEntry) % kCacheLineSize == 0U);
+
 } // namespace fastipc::impl
@@ -18,99 +18,835 @@
 
 #include "fastipc.hxx"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <bit>
 #include <cassert>
+#include <cerrno>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <format>
 #include <limits>
-#include <print>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string_view>
+#include <system_error>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
 #include <unistd.h>
 
 #include "io/cursor.hxx"
 #include "io/fd.hxx"
+#include "io/futex.hxx"
+#include "io/numa.hxx"
 #include "io/result.hxx"
 #include "channel.hxx"
 #include "local_proto.hxx"
+#include "registry.hxx"
 
 namespace fastipc {
 
 using namespace impl;
 
+static_assert(kCacheLineSize % kPayloadAlignment == 0U);
+
 namespace {
 
+/// Logger of the library itself
+[[nodiscard]] const Logger& libraryLog() {
+    static const Logger logger{"fastipc"};
+    return logger;
+}
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Endpoint final {
+    constexpr static std::size_t kNoSlot = std::numeric_limits<std::size_t>::max();
+
+    ChannelPage* page;
+    std::size_t mapped_size;
+    // Signalled by writers on submission while readers are armed
+    io::Fd notify_fd;
+    // Registry file of the channel, share-locked for the tower not to free it, if directly attached
+    io::Fd channel_fd{};
+    // Reader-only: number of parties having armed notifications
+    std::size_t arm_count{0U};
+    // Writer-only: slot held in reserve for the next prepared sample
+    bool reserve_spare_slot{false};
+    std::size_t spare_index{kNoSlot};
+    // Writer-only: lane the writer claims slots from first
+    std::size_t lane{0U};
+    // Record claimed by the tower on our behalf, or ChannelPage::kNoRecord
+    std::uint32_t record{ChannelPage::kNoRecord};
+    // Record in the channel page, or the untracked counters below
+    EndpointStats* stats{nullptr};
+    // Counters of our own while untracked, which nobody inspects but spare the hot path any shared write
+    std::unique_ptr<EndpointStats> untracked_stats{};
+    // References held per slot, null while untracked
+    std::atomic_uint32_t* holdings{nullptr};
+    // Reader-only: greatest sequence id observed
+    std::uint64_t last_sequence_id{0U};
+    // Queue reader-only: next queue position to acquire; RPC server-only: slot to resume looking for requests from
+    std::uint64_t queue_position{0U};
+};
+
+/// Counts events on a counter owned by the calling endpoint, which spares an atomic read-modify-write
+void bump(std::atomic_uint64_t& counter, std::uint64_t count = 1U) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+/// Points the endpoint at the stats record claimed on its behalf
+void adoptRecord(Endpoint& endpoint, std::uint32_t record) noexcept {
+    endpoint.record = record;
+    if (record == ChannelPage::kNoRecord) {
+        endpoint.untracked_stats = std::make_unique<EndpointStats>();
+        endpoint.stats = endpoint.untracked_stats.get();
+        return;
+    }
+
+    endpoint.stats = &endpoint.page->stats(record);
+    endpoint.holdings = endpoint.page->holdings(record);
+    endpoint.stats->owner_start_time.store(processStartTime(::getpid()).value_or(0U), std::memory_order_relaxed);
+    endpoint.stats->notify_fd.store(endpoint.notify_fd.fd(), std::memory_order_release);
+}
+
+/// Gives back the endpoint's record, along with whatever it still holds on to
+void releaseEndpoint(const Endpoint& endpoint) noexcept {
+    if (endpoint.record == ChannelPage::kNoRecord)
+        endpoint.page->untracked_endpoints.fetch_sub(1U, std::memory_order_release);
+    else
+        releaseRecord(*endpoint.page, endpoint.record);
+}
+
+/// Accounts for a reference to a sample having been taken by the endpoint
+void hold(const Endpoint& endpoint, std::size_t index) noexcept {
+    if (endpoint.holdings != nullptr)
+        endpoint.holdings[index].store(endpoint.holdings[index].load(std::memory_order_relaxed) + 1U,
+                                       std::memory_order_relaxed);
+}
+
+/// Accounts for a reference to a sample about to be given up or away by the endpoint
+void unhold(const Endpoint& endpoint, std::size_t index) noexcept {
+    if (endpoint.holdings != nullptr)
+        endpoint.holdings[index].store(endpoint.holdings[index].load(std::memory_order_relaxed) - 1U,
+                                       std::memory_order_relaxed);
+}
+
 void writeClientRequest(std::span<std::byte>& buf, const ClientRequest& request) noexcept {
     const auto topic_name_buf = std::span<const std::byte>{
         reinterpret_cast<const std::byte*>(request.topic_name.data()), request.topic_name.size()};
 
+    io::putBuf(buf, request.layout_version);
     io::putBuf(buf, request.type);
     io::putBuf(buf, request.max_payload_size);
+    io::putBuf(buf, request.slot_count);
+    io::putBuf(buf, request.page_backing);
+    io::putBuf(buf, request.kind);
+    io::putBuf(buf, request.history_depth);
+    io::putBuf(buf, request.clock);
+    io::putBuf(buf, request.trace_depth);
+    io::putBuf(buf, request.numa_node);
+    io::putBuf(buf, request.writer_lanes);
+    io::putBuf(buf, request.endpoint_records);
     io::putBuf(buf, static_cast<std::uint8_t>(topic_name_buf.size()));
     io::putBuf(buf, topic_name_buf);
 }
 
-[[nodiscard]] ChannelPage& connect(const ClientRequest& request) {
-    const auto sockfd =
-        expect(io::adoptSysFd(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)), "failed to create client socket");
+[[nodiscard]] io::expected<io::Fd> tryConnectTower(std::string_view path = kDefaultTowerPath) {
+    auto sockfd = io::adoptSysFd(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+    if (!sockfd.has_value())
+        return sockfd;
 
     ::sockaddr_un addr{};
     addr.sun_family = AF_UNIX;
-    constexpr char kPath[] = "fastipcd"; // NOLINT(*-c-arrays)
-    static_assert(sizeof(kPath) <= sizeof(addr.sun_path));
-    std::memcpy(addr.sun_path, kPath, sizeof(kPath));
+    assert(path.size() < sizeof(addr.sun_path));
+    std::memcpy(addr.sun_path, path.data(), path.size());
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-    expect(io::sysCheck(::connect(sockfd.fd(), reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr))),
-           "failed to connect to tower");
+    if (auto res = io::sysCheck(::connect(sockfd->fd(), reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)));
+        !res.has_value())
+        return io::unexpected{res.error()};
+
+    return sockfd;
+}
+
+[[nodiscard]] io::Fd connectTower(std::string_view path = kDefaultTowerPath) {
+    return expect(tryConnectTower(path), "failed to connect to tower");
+}
 
-    std::array<std::byte, 128u> buf{}; // NOLINT(*-magic-numbers)
+/// Opens up to kMaxBatchSize channels in a single round trip to the tower
+///
+/// Rejected channels abort, unless @a tolerate_rejection is set, in which case they get skipped instead.
+///
+/// @return The status of the first rejected channel, or ReplyStatus::Ok
+ReplyStatus openBatch(const io::Fd& sockfd, std::span<const ClientRequest> requests, std::vector<Endpoint>& endpoints,
+                      bool tolerate_rejection = false) {
+    assert(!requests.empty() && requests.size() <= kMaxBatchSize);
+
+    std::array<std::byte, kMaxClientMessageSize> buf{};
 
     std::span<std::byte> sndbuf{buf};
-    writeClientRequest(sndbuf, request);
+    io::putBuf(sndbuf, kProtocolMagic);
+    io::putBuf(sndbuf, kProtocolVersion);
+    io::putBuf(sndbuf, MessageKind::Open);
+    io::putBuf(sndbuf, static_cast<std::uint16_t>(requests.size()));
+    for (const auto& request : requests)
+        writeClientRequest(sndbuf, request);
 
     const auto bytes_written =
         expect(io::sysVal(::write(sockfd.fd(), buf.data(), buf.size() - sndbuf.size())), "failed to write to tower");
     static_cast<void>(bytes_written); // seq packet
 
-    std::size_t total_size{0U};
-    int memfd{-1};
+    std::array<TowerReply, kMaxBatchSize> replies{};
     ::msghdr msg{};
 
-    ::iovec iov{.iov_base = &total_size, .iov_len = sizeof(total_size)};
+    ::iovec iov{.iov_base = replies.data(), .iov_len = requests.size() * sizeof(TowerReply)};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * kMaxBatchSize * kFdsPerChannel)> data{};
+    msg.msg_control = data.data();
+    msg.msg_controllen = data.size();
+
+    const auto bytes_read =
+        expect(io::sysVal(::recvmsg(sockfd.fd(), &msg, 0)), "failed to receive reply from tower");
+
+    // Adopt the descriptors first, so that none leaks whatever happens next.
+    std::vector<io::Fd> fds;
+    if (const auto* const cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr) {
+        const auto fd_count = (cmsg->cmsg_len - CMSG_LEN(0U)) / sizeof(int);
+        fds.reserve(fd_count);
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kMaxBatchSize
+        for (std::size_t i{0U}; i < fd_count; ++i) {
+            int fd{-1};
+            std::memcpy(&fd, CMSG_DATA(cmsg) + (i * sizeof(int)), sizeof(int));
+            fds.emplace_back(fd);
+        }
+    }
+    // Descriptors beyond our limit get dropped by the kernel, truncating the control message.
+    if ((msg.msg_flags & MSG_CTRUNC) != 0)
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::too_many_files_open)}},
+               "failed to receive channel descriptors from tower");
+
+    // The tower hangs up on requests it cannot make sense of, such as out of bounds ones.
+    if (static_cast<std::size_t>(bytes_read) < sizeof(TowerReply))
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::connection_reset)}},
+               "tower dropped the connection");
+    if (replies[0U].status == ReplyStatus::ProtocolMismatch && tolerate_rejection)
+        return ReplyStatus::ProtocolMismatch;
+    if (replies[0U].status == ReplyStatus::ProtocolMismatch)
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::protocol_not_supported)}},
+               "tower rejected protocol version");
+    if (static_cast<std::size_t>(bytes_read) != requests.size() * sizeof(TowerReply))
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::bad_message)}},
+               "failed to receive reply from tower");
+
+    auto status = ReplyStatus::Ok;
+    auto next_fd = fds.begin();
+    for (const auto& reply : std::span{replies}.first(requests.size())) {
+        // Rejections come without descriptors.
+        if (reply.status != ReplyStatus::Ok && tolerate_rejection) {
+            if (status == ReplyStatus::Ok)
+                status = reply.status;
+            continue;
+        }
+        if (reply.status == ReplyStatus::LayoutMismatch)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::protocol_not_supported)}},
+                   "tower rejected channel layout version");
+        if (reply.status == ReplyStatus::PayloadSizeMismatch)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::invalid_argument)}},
+                   "tower rejected channel payload size");
+        if (reply.status == ReplyStatus::KindMismatch)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::wrong_protocol_type)}},
+                   "tower rejected channel kind");
+        if (reply.status == ReplyStatus::ResourceExhausted)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::not_enough_memory)}},
+                   "tower failed to create channel");
+
+        if (fds.end() - next_fd < static_cast<std::ptrdiff_t>(kFdsPerChannel))
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::too_many_files_open)}},
+                   "failed to receive channel descriptors from tower");
+        const auto memfd = std::move(*next_fd++);
+        auto eventfd = std::move(*next_fd++);
+
+        void* ptr =
+            expect(io::sysVal(::mmap(nullptr, reply.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd.fd(), 0)),
+                   "failed to mmap channel memory");
+
+        auto& channel_page = *static_cast<ChannelPage*>(ptr);
+        assert(channel_page.layout_version == kLayoutVersion);
+
+        // Transparent huge pages are granted per mapping.
+        if (channel_page.page_backing == PageBacking::TransparentHuge)
+            static_cast<void>(::madvise(ptr, reply.total_size, MADV_HUGEPAGE));
+
+        auto& endpoint = endpoints.emplace_back(
+            Endpoint{.page = &channel_page, .mapped_size = reply.total_size, .notify_fd = std::move(eventfd)});
+        adoptRecord(endpoint, reply.record);
+    }
+
+    return status;
+}
+
+/// Opens channels through a tower connection, in as few round trips as possible
+[[nodiscard]] std::vector<Endpoint> openEndpoints(const io::Fd& sockfd, std::span<const ClientRequest> requests) {
+    std::vector<Endpoint> endpoints;
+    endpoints.reserve(requests.size());
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Round trips should not be unrolled
+    for (auto batch = requests; !batch.empty(); batch = batch.subspan(std::min(batch.size(), kMaxBatchSize)))
+        openBatch(sockfd, batch.first(std::min(batch.size(), kMaxBatchSize)), endpoints);
+
+    return endpoints;
+}
+
+/// Fetches the notification descriptor of a channel from the default tower, unless none is listening
+///
+/// Directly attached endpoints could otherwise only share it with those opened through the tower by taking it from
+/// their processes, which they are seldom allowed to.
+[[nodiscard]] std::optional<io::Fd> towerEventFd(const ClientRequest& request) {
+    const auto sockfd = tryConnectTower();
+    if (!sockfd.has_value())
+        return std::nullopt;
+
+    std::array<std::byte, kMaxClientMessageSize> buf{};
+    std::span<std::byte> sndbuf{buf};
+    io::putBuf(sndbuf, kProtocolMagic);
+    io::putBuf(sndbuf, kProtocolVersion);
+    io::putBuf(sndbuf, MessageKind::Notify);
+    io::putBuf(sndbuf, std::uint16_t{1U});
+    writeClientRequest(sndbuf, request);
+    if (::write(sockfd->fd(), buf.data(), buf.size() - sndbuf.size()) < 0)
+        return std::nullopt;
+
+    TowerReply reply{};
+    ::iovec iov{.iov_base = &reply, .iov_len = sizeof(reply)};
+    alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int))> data{};
+    ::msghdr msg{};
     msg.msg_iov = &iov;
     msg.msg_iovlen = 1;
+    msg.msg_control = data.data();
+    msg.msg_controllen = data.size();
+    const auto bytes_read = ::recvmsg(sockfd->fd(), &msg, 0);
+
+    // Towers predating such requests hang up on them.
+    const auto* const cmsg = bytes_read > 0 ? CMSG_FIRSTHDR(&msg) : nullptr;
+    if (cmsg == nullptr || cmsg->cmsg_len != CMSG_LEN(sizeof(int)))
+        return std::nullopt;
+    int fd{-1};
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    io::Fd eventfd{fd};
+    if (static_cast<std::size_t>(bytes_read) != sizeof(reply) || reply.status != ReplyStatus::Ok)
+        return std::nullopt;
+    return eventfd;
+}
+
+/// Registry of the default tower, which directly attached endpoints find their channels in
+[[nodiscard]] const io::Fd& directRegistry() {
+    static const io::Fd registryfd =
+        expect(openRegistry(registryPathFor(kDefaultTowerPath)), "failed to open channel registry");
+    return registryfd;
+}
+
+/// Creates the requested channel in the registry, unless another endpoint or the tower beats us to it
+///
+/// The channel is set up in an unnamed file first, and only linked in once complete, so that nobody ever comes across
+/// one half-way.
+///
+/// @return Whether the channel got created, rather than found to exist already
+[[nodiscard]] bool createDirectChannel(const std::string& file_name, const ClientRequest& request) {
+    const auto& registryfd = directRegistry();
+    const auto memfd = expect(
+        io::adoptSysFd(::openat(registryfd.fd(), ".", O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR)),
+        "failed to create channel memory");
+
+    // Only the tower gets hugetlbfs pages, and calibrates the time stamp counter.
+    auto backing = request.page_backing == PageBacking::TransparentHuge ? PageBacking::TransparentHuge
+                                                                        : PageBacking::Default;
+    const auto page_size = pageSizeFor(request);
+    if (page_size > kMaxChannelSize)
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::file_too_large)}},
+               "channel settings exceed the largest channel size");
+    const auto size = backing == PageBacking::Default ? page_size : alignUp(page_size, kHugePageSize);
+    // NOLINTNEXTLINE(*-narrowing-conversions)
+    expect(io::sysCheck(::ftruncate(memfd.fd(), size)), "failed to size channel memory");
+    auto* const ptr = expect(io::sysVal(::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd.fd(), 0)),
+                             "failed to mmap channel memory");
+    if (backing == PageBacking::TransparentHuge && ::madvise(ptr, size, MADV_HUGEPAGE) != 0)
+        backing = PageBacking::Default;
+
+    // Bound ahead of initialization, the pages get allocated on the node to begin with.
+    auto numa_node = kNoNumaNode;
+    if (request.numa_node != kNoNumaNode) {
+        if (auto res = io::preferNumaNode(ptr, size, request.numa_node); res.has_value())
+            numa_node = request.numa_node;
+        else
+            libraryLog().log(LogLevel::Warning, "failed to bind channel memory to NUMA node {}: {}", request.numa_node,
+                             res.error().message());
+    }
+
+    auto creation = request;
+    if (creation.clock == ChannelClock::Tsc)
+        creation.clock = ChannelClock::Steady;
+    initChannelPage(ptr, creation, backing).numa_node.store(numa_node, std::memory_order_relaxed);
+    expect(io::sysCheck(::munmap(ptr, size)), "Failed to munmap channel memory");
+
+    const auto link = std::format("/proc/self/fd/{}", memfd.fd());
+    if (::linkat(AT_FDCWD, link.c_str(), registryfd.fd(), file_name.c_str(), AT_SYMLINK_FOLLOW) == 0)
+        return true;
+    if (errno == EEXIST)
+        return false;
+    expect(io::expected<void>{io::unexpected{io::errnoCode()}}, "failed to link channel into the registry");
+    return false;
+}
+
+/// Opens a channel straight from the registry, creating it if needed, without involving the tower
+[[nodiscard]] Endpoint attachDirect(const ClientRequest& request) {
+    const auto file_name = registryFileOf(request.topic_name);
+    if (!file_name.has_value())
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::filename_too_long)}},
+               "channel name does not fit in the registry");
+    const auto& registryfd = directRegistry();
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Only retried on races with other endpoints or the tower
+    for (;;) {
+        auto channelfd = io::adoptSysFd(::openat(registryfd.fd(), file_name->c_str(), O_RDWR | O_CLOEXEC));
+        if (!channelfd.has_value()) {
+            if (channelfd.error() != std::errc::no_such_file_or_directory)
+                expect(io::expected<void>{io::unexpected{channelfd.error()}}, "failed to open channel memory");
+            static_cast<void>(createDirectChannel(*file_name, request));
+            continue;
+        }
+
+        // Held for as long as the endpoint lives; the tower frees the channel only once it gets the lock exclusively,
+        // after which the file is gone from the registry.
+        expect(io::sysCheck(::flock(channelfd->fd(), LOCK_SH)), "failed to lock channel memory");
+        struct ::stat status{};
+        expect(io::sysCheck(::fstat(channelfd->fd(), &status)), "failed to stat channel memory");
+        if (status.st_nlink == 0U)
+            continue;
+
+        const auto size = static_cast<std::size_t>(status.st_size);
+        if (size < sizeof(ChannelPage))
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::protocol_not_supported)}},
+                   "registry holds an incompatible channel");
+        void* ptr = expect(io::sysVal(::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, channelfd->fd(), 0)),
+                           "failed to mmap channel memory");
+
+        auto& channel_page = *static_cast<ChannelPage*>(ptr);
+        if (channel_page.layout_version != kLayoutVersion ||
+            ChannelPage::total_size(channel_page.max_payload_size, channel_page.slot_count, channel_page.writer_lanes,
+                                    channel_page.history_depth, channel_page.trace_depth,
+                                    channel_page.record_count) > size)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::protocol_not_supported)}},
+                   "registry holds an incompatible channel layout version");
+        if (channel_page.max_payload_size != request.max_payload_size)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::invalid_argument)}},
+                   "registry holds a channel of another payload size");
+        if (channel_page.kind != request.kind)
+            expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::wrong_protocol_type)}},
+                   "registry holds a channel of another kind");
+
+        if (channel_page.page_backing == PageBacking::TransparentHuge)
+            static_cast<void>(::madvise(ptr, size, MADV_HUGEPAGE));
+        if (auto bound = bindChannel(channel_page, size, request.numa_node); !bound.has_value())
+            libraryLog().log(LogLevel::Warning, "failed to bind channel memory to NUMA node {}: {}", request.numa_node,
+                             bound.error().message());
+
+        // Share the descriptor other endpoints wait on, so that all get woken up together: the tower hands it out if
+        // listening, otherwise it gets taken from another endpoint if any is left and we may trace its process.
+        auto notifyfd = towerEventFd(request);
+        if (!notifyfd.has_value())
+            notifyfd = recoverEventFd(channel_page);
+        if (!notifyfd.has_value()) {
+            if (!isUnused(channel_page)) {
+                libraryLog().log(LogLevel::Error,
+                                 "failed to share the notification descriptor of channel '{}' with its other "
+                                 "endpoints, which no tower listens for and we may not trace; notifications will not "
+                                 "wake them up",
+                                 request.topic_name);
+            }
+            notifyfd = expect(io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)), "failed to create eventfd");
+        }
+
+        Endpoint endpoint{.page = &channel_page,
+                          .mapped_size = size,
+                          .notify_fd = std::move(*notifyfd),
+                          .channel_fd = std::move(*channelfd)};
+        adoptRecord(endpoint, claimRecord(channel_page, ::getpid(), pidNamespace(), request.type));
+        return endpoint;
+    }
+}
+
+[[nodiscard]] Endpoint connect(const ClientRequest& request, bool direct_attach) {
+    if (direct_attach)
+        return attachDirect(request);
+    return std::move(openEndpoints(connectTower(), {&request, 1U}).front());
+}
+
+[[nodiscard]] ClientRequest clientRequestFor(RequesterType type, ChannelKind kind,
+                                             const ChannelRequest& request) noexcept {
+    return {.layout_version = kLayoutVersion,
+            .type = type,
+            .max_payload_size = request.max_payload_size,
+            .slot_count = static_cast<std::uint32_t>(request.options.slot_count),
+            .page_backing = request.options.page_backing,
+            .kind = kind,
+            .history_depth = static_cast<std::uint32_t>(request.options.history_depth),
+            .clock = request.options.clock,
+            .trace_depth = static_cast<std::uint32_t>(request.options.trace_depth),
+            .numa_node = type != RequesterType::Writer             ? kNoNumaNode
+                         : request.options.numa_node == kLocalNumaNode ? io::currentNumaNode()
+                                                                       : request.options.numa_node,
+            .writer_lanes = static_cast<std::uint32_t>(request.options.writer_lanes),
+            .endpoint_records = static_cast<std::uint32_t>(request.options.endpoint_records),
+            .topic_name = request.channel_name};
+}
+
+void disconnect(const Endpoint& endpoint) {
+    expect(io::sysCheck(::munmap(endpoint.page, endpoint.mapped_size)), "Failed to munmap channel memory");
+}
+
+/// Applies the endpoint settings regarding channel memory
+void setUpMemory(const Endpoint& endpoint, const ChannelOptions& options) {
+    if (options.prefault) {
+        const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        // Populating for writing spares the write faults as well, but requires Linux 5.14.
+        if (!io::sysCheck(::madvise(endpoint.page, endpoint.mapped_size, MADV_POPULATE_WRITE)).has_value()) {
+            const auto* const bytes = reinterpret_cast<const volatile std::byte*>(endpoint.page);
+            // NOLINTNEXTLINE(altera-unroll-loops) Page faults are anything but loop overhead
+            for (std::size_t offset{0U}; offset < endpoint.mapped_size; offset += page_size)
+                static_cast<void>(bytes[offset]);
+        }
+    }
+
+    if (options.lock_memory) {
+        if (auto res = io::sysCheck(::mlock(endpoint.page, endpoint.mapped_size)); !res.has_value())
+            libraryLog().log(LogLevel::Warning, "failed to lock channel memory: {}", res.error().message());
+    }
+}
+
+/// Hints the CPU that we are busy-waiting
+void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+[[nodiscard]] Endpoint& endpointOf(void* shadow) noexcept { return *static_cast<Endpoint*>(shadow); }
+
+/// Opens the trace entry of a sequence id handed out to a prepared sample
+void tracePrepared(ChannelPage& channel_page, std::uint64_t sequence_id, std::uint64_t now) noexcept {
+    auto& entry = channel_page.trace(sequence_id);
+    // Keep readers from attributing their acquisitions of the previous occupant to the new one.
+    entry.sequence_id.store(0U, std::memory_order_relaxed);
+    entry.submitted.store(0U, std::memory_order_relaxed);
+    entry.acquired.store(0U, std::memory_order_relaxed);
+    entry.prepared.store(now, std::memory_order_relaxed);
+    entry.sequence_id.store(sequence_id, std::memory_order_release);
+}
+
+void traceSubmitted(ChannelPage& channel_page, std::uint64_t sequence_id, std::uint64_t now) noexcept {
+    auto& entry = channel_page.trace(sequence_id);
+    // Samples held for longer than the trace depth lost their entry already.
+    if (entry.sequence_id.load(std::memory_order_relaxed) == sequence_id)
+        entry.submitted.store(now, std::memory_order_release);
+}
+
+/// Records the first acquisition of a sequence id, across every reader of the channel
+void traceAcquired(ChannelPage& channel_page, std::uint64_t sequence_id, std::uint64_t now) noexcept {
+    auto& entry = channel_page.trace(sequence_id);
+    if (entry.sequence_id.load(std::memory_order_acquire) != sequence_id ||
+        entry.acquired.load(std::memory_order_relaxed) != 0U)
+        return;
+
+    std::uint64_t unacquired{0U};
+    static_cast<void>(entry.acquired.compare_exchange_strong(unacquired, now, std::memory_order_relaxed));
+}
+
+/// Accounts for a reader having observed a sample
+void observeSample(Endpoint& endpoint, std::uint64_t sequence_id) noexcept {
+    if (sequence_id <= endpoint.last_sequence_id)
+        return;
+    if (endpoint.page->trace_depth != 0U)
+        traceAcquired(*endpoint.page, sequence_id, endpoint.page->read_clock());
+    if (sequence_id > endpoint.last_sequence_id + 1U)
+        bump(endpoint.stats->skipped_sequence_ids, sequence_id - endpoint.last_sequence_id - 1U);
+    endpoint.last_sequence_id = sequence_id;
+}
+
+/// Attempts to take exclusive ownership of an unreferenced sample
+[[nodiscard]] bool claimSample(ChannelPage& channel_page, std::size_t index) noexcept {
+    std::size_t expected_count{0U};
+    constexpr std::size_t kDesiredCount{1U};
+    if (!channel_page[index].ref_count.compare_exchange_strong(expected_count, kDesiredCount,
+                                                               std::memory_order_acquire))
+        return false;
+
+    occupancyWord(channel_page, index).fetch_or(occupancyBit(channel_page, index), std::memory_order_relaxed);
+    return true;
+}
+
+/// Scans the occupancy hints once, from the given lane on and wrapping around, claiming the first free sample found
+///
+/// @return The index of the claimed sample, or Endpoint::kNoSlot if none could be claimed
+[[nodiscard]] std::size_t claimAnySample(ChannelPage& channel_page, EndpointStats& stats,
+                                         std::size_t first_lane = 0U) noexcept {
+    const auto lane_word_count =
+        (channel_page.lane_slot_count + ChannelPage::kOccupancyWordBits - 1U) / ChannelPage::kOccupancyWordBits;
+    // NOLINTNEXTLINE(altera-unroll-loops) Let's benchmark first
+    for (std::size_t scanned_lanes{0U}; scanned_lanes < channel_page.writer_lanes; ++scanned_lanes) {
+        const auto lane = (first_lane + scanned_lanes) % channel_page.writer_lanes;
+        // NOLINTNEXTLINE(altera-unroll-loops) Let's benchmark first
+        for (std::size_t lane_word{0U}; lane_word < lane_word_count; ++lane_word) {
+            // Read occupancy hints, skipping fully occupied words at once.
+            const auto word = (lane * channel_page.lane_word_stride) + lane_word;
+            auto occupancy = channel_page.occupancy(word).load(std::memory_order_relaxed);
+
+            // NOLINTNEXTLINE(altera-id-dependent-backward-branch,altera-unroll-loops) Let's benchmark first
+            for (std::size_t bit{0U}; (bit = std::countr_one(occupancy)) < ChannelPage::kOccupancyWordBits;
+                 occupancy |= (std::uint64_t{1U} << bit)) {
+                const auto index =
+                    (lane * channel_page.lane_slot_count) + (lane_word * ChannelPage::kOccupancyWordBits) + bit;
+                if (claimSample(channel_page, index))
+                    return index;
+                // The hint for this sample was racy.
+                bump(stats.racy_hints);
+            }
+        }
+    }
+
+    // Everything is occupied or all hints were racy.
+    return Endpoint::kNoSlot;
+}
+
+/// Readies a claimed sample for being written
+void beginSample(ChannelPage& channel_page, std::size_t index) noexcept {
+    auto& sample = channel_page[index];
 
-    alignas(::cmsghdr) std::array<char, CMSG_SPACE(sizeof(memfd))> data{};
-    msg.msg_control = &data;
-    msg.msg_controllen = sizeof(data);
+    // Turn away copy-out readers still looking at the previous contents.
+    sample.seqlock.store(sample.seqlock.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
 
-    expect(io::sysCheck(::recvmsg(sockfd.fd(), &msg, 0)), "failed to receive reply from tower");
+    // Bump the seq id now but do not stamp,
+    // thus making writer races visible from logs.
+    sample.sequence_id = channel_page.next_seq_id.fetch_add(1U, std::memory_order_relaxed);
 
-    const auto* const cmsg = CMSG_FIRSTHDR(&msg);
-    assert(cmsg != nullptr);
-    std::memcpy(&memfd, CMSG_DATA(cmsg), sizeof(memfd));
+    // Assume every block gets rewritten, unless seeded from the latest sample.
+    sample.base_version = sample.sequence_id;
+    sample.chain_start = 0U;
 
-    void* ptr = expect(io::sysVal(::mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0)),
-                       "failed to mmap channel memory");
+    if (channel_page.trace_depth != 0U)
+        tracePrepared(channel_page, sample.sequence_id, channel_page.read_clock());
+}
+
+/// Takes a reference to the latest sample
+///
+/// @return The index of the referenced sample
+[[nodiscard]] std::size_t referenceLatest(ChannelPage& channel_page, std::atomic_uint64_t& retries) noexcept {
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;;) {
+        const auto latest = channel_page.latest.load(std::memory_order_acquire);
+        const auto index = latestIndexOf(latest);
+
+        // Bump up sample refcount.
+        channel_page[index].ref_count.fetch_add(1U, std::memory_order_acquire);
+
+        // The sample may have been recycled before our reference landed,
+        // in which case we back off and try again with the new latest.
+        if (channel_page.latest.load(std::memory_order_acquire) != latest) {
+            releaseSample(channel_page, index);
+            bump(retries);
+            continue;
+        }
+
+        // Hint that the sample is being used.
+        occupancyWord(channel_page, index).fetch_or(occupancyBit(channel_page, index), std::memory_order_relaxed);
+
+        return index;
+    }
+}
+
+/// Claims a slot for the next prepared sample, preferably the spare one
+///
+/// @return The index of the claimed slot, or Endpoint::kNoSlot if none could be claimed
+[[nodiscard]] std::size_t claimPreparedSlot(Endpoint& endpoint) noexcept {
+    auto index = std::exchange(endpoint.spare_index, Endpoint::kNoSlot);
+    if (index != Endpoint::kNoSlot)
+        return index;
+
+    index = claimAnySample(*endpoint.page, *endpoint.stats, endpoint.lane);
+    if (index == Endpoint::kNoSlot)
+        bump(endpoint.stats->prepare_retries);
+    else
+        hold(endpoint, index);
+    return index;
+}
+
+/// Copies over the payload blocks of the latest sample which a freshly begun sample does not share already
+///
+/// @param stale_base_version Base version of the sample's payload, from before it was begun
+void seedFromLatest(Endpoint& endpoint, std::size_t index, std::uint64_t stale_base_version) noexcept {
+    auto& channel_page = *endpoint.page;
+    auto& sample = channel_page[index];
+
+    // Keep the latest sample from being recycled while copying from it.
+    const auto latest_index = referenceLatest(channel_page, endpoint.stats->acquire_retries);
+    hold(endpoint, latest_index);
+    const auto& latest = channel_page[latest_index];
+
+    auto* const versions = channel_page.block_versions(sample);
+    const auto* const latest_versions = channel_page.block_versions(latest);
+    const auto copy_blocks = [&](std::size_t first, std::size_t last) {
+        const auto offset = first * kDirtyBlockSize;
+        const auto end = std::min(last * kDirtyBlockSize, channel_page.max_payload_size);
+        std::memcpy(&sample.payload[offset], &latest.payload[offset], end - offset);
+    };
+
+    // Copy runs of differing blocks at once.
+    auto run_first = Endpoint::kNoSlot;
+    const auto block_count = channel_page.block_count();
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the payload size
+    for (std::size_t block{0U}; block < block_count; ++block) {
+        const auto version = std::max(stale_base_version, versions[block]);
+        const auto latest_version = std::max(latest.base_version, latest_versions[block]);
+        versions[block] = latest_version;
+
+        if (version != latest_version) {
+            if (run_first == Endpoint::kNoSlot)
+                run_first = block;
+        } else if (run_first != Endpoint::kNoSlot) {
+            copy_blocks(std::exchange(run_first, Endpoint::kNoSlot), block);
+        }
+    }
+    if (run_first != Endpoint::kNoSlot)
+        copy_blocks(run_first, block_count);
+
+    sample.base_version = 0U;
+    // Changes can only be told apart from the samples this one directly descends from.
+    sample.chain_start = latest.sequence_id + 1U == sample.sequence_id ? latest.chain_start : sample.sequence_id;
+
+    unhold(endpoint, latest_index);
+    releaseSample(channel_page, latest_index);
+}
+
+/// Wakes up the readers waiting on the channel, only paying for syscalls if any is
+void notifyReaders(const Endpoint& endpoint) noexcept {
+    auto& channel_page = *endpoint.page;
+
+    // Readers blocked in a wait call
+    channel_page.notify_epoch.fetch_add(1U, std::memory_order_seq_cst);
+    if (channel_page.waiter_count.load(std::memory_order_seq_cst) != 0U)
+        io::futexWake(channel_page.notify_epoch);
+
+    // Readers waiting through their notification descriptor
+    if (channel_page.armed_count.load(std::memory_order_seq_cst) != 0U)
+        static_cast<void>(::eventfd_write(endpoint.notify_fd.fd(), 1U));
+}
+
+/// Blocks until the condition holds, or until the timeout expires
+///
+/// @return Whether the condition holds
+template <typename Condition>
+[[nodiscard]] bool waitUntil(const Endpoint& endpoint, std::chrono::nanoseconds timeout, Condition condition) {
+    if (condition())
+        return true;
 
-    return *static_cast<ChannelPage*>(ptr);
+    auto& channel_page = *endpoint.page;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    // Announce ourselves before sampling the epoch, so that either the writer
+    // sees us waiting or we see its epoch bump.
+    channel_page.waiter_count.fetch_add(1U, std::memory_order_seq_cst);
+    // Threads may share a reader while waiting.
+    endpoint.stats->waiting.fetch_add(1U, std::memory_order_relaxed);
+
+    bool holds{false};
+    // NOLINTNEXTLINE(altera-unroll-loops) Wait loops should not be unrolled
+    for (;;) {
+        const auto epoch = channel_page.notify_epoch.load(std::memory_order_seq_cst);
+        holds = condition();
+        if (holds)
+            break;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+
+        // Spurious wake-ups, signals and epoch races all end up re-checking.
+        static_cast<void>(io::futexWait(channel_page.notify_epoch, epoch, deadline - now));
+    }
+
+    endpoint.stats->waiting.fetch_sub(1U, std::memory_order_relaxed);
+    channel_page.waiter_count.fetch_sub(1U, std::memory_order_relaxed);
+
+    return holds;
 }
 
-void disconnect(ChannelPage& channel_page) {
-    expect(io::sysCheck(::munmap(&channel_page, ChannelPage::total_size(channel_page.max_payload_size))),
-           "Failed to munmap channel memory");
+[[nodiscard]] std::chrono::nanoseconds clockTimeOf(const ChannelPage& channel_page, std::uint64_t reading) noexcept {
+    return std::chrono::nanoseconds{channel_page.clock_time(reading)};
+}
+
+/// Converts a reading of the channel clock to the system clock, as of how long ago it was taken
+[[nodiscard]] std::chrono::system_clock::time_point systemTimeOf(const ChannelPage& channel_page,
+                                                                 std::uint64_t reading) noexcept {
+    const auto time = clockTimeOf(channel_page, reading);
+    if (channel_page.clock == ChannelClock::System)
+        return std::chrono::system_clock::time_point{
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(time)};
+
+    const auto age = clockTimeOf(channel_page, channel_page.read_clock()) - time;
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::system_clock::now() - age);
+}
+
+[[nodiscard]] void* adoptReaderEndpoint(Endpoint endpoint, const ChannelOptions& options) {
+    setUpMemory(endpoint, options);
+
+    auto* const adopted = new Endpoint{std::move(endpoint)};
+    auto& channel_page = *adopted->page;
+    // Only count what was skipped from now on.
+    const auto latest_index = latestIndexOf(channel_page.latest.load(std::memory_order_acquire));
+    adopted->last_sequence_id = channel_page[latest_index].sequence_id;
+
+    return adopted;
+}
+
+[[nodiscard]] void* adoptWriterEndpoint(Endpoint endpoint, const ChannelOptions& options) {
+    libraryLog().log(LogLevel::Debug, "channel sample size: {}", endpoint.page->max_payload_size);
+    setUpMemory(endpoint, options);
+
+    auto* const adopted = new Endpoint{std::move(endpoint)};
+    auto& channel_page = *adopted->page;
+    // Lanes get handed out in turn, writers sharing them once there are more writers than lanes.
+    adopted->lane = channel_page.next_lane.fetch_add(1U, std::memory_order_relaxed) % channel_page.writer_lanes;
+
+    adopted->reserve_spare_slot = options.reserve_spare_slot;
+    if (!adopted->reserve_spare_slot)
+        return adopted;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    while ((adopted->spare_index = claimAnySample(channel_page, *adopted->stats, adopted->lane)) ==
+           Endpoint::kNoSlot)
+        std::this_thread::yield();
+    hold(*adopted, adopted->spare_index);
+
+    return adopted;
 }
 
 } // namespace
@@ -120,136 +856,981 @@ auto Reader::Sample::getSequenceId() const -> std::uint64_t {
 }
 
 auto Reader::Sample::getTimestamp() const -> std::chrono::system_clock::time_point {
-    return static_cast<const ChannelSample*>(m_shadow)->timestamp;
+    return systemTimeOf(*static_cast<const ChannelPage*>(m_channel),
+                        static_cast<const ChannelSample*>(m_shadow)->timestamp);
+}
+
+auto Reader::Sample::getClockTimestamp() const -> std::chrono::nanoseconds {
+    return clockTimeOf(*static_cast<const ChannelPage*>(m_channel),
+                       static_cast<const ChannelSample*>(m_shadow)->timestamp);
 }
 
 auto Reader::Sample::getPayload() const -> const void* { return +static_cast<const ChannelSample*>(m_shadow)->payload; }
 
-Reader::Reader(std::string_view channel_name, std::size_t max_payload_size)
-    : m_shadow{[=]() {
-          auto& channel = connect(
-              {.type = RequesterType::Reader, .max_payload_size = max_payload_size, .topic_name = channel_name});
-          assert(channel.max_payload_size == max_payload_size);
-          return static_cast<void*>(&channel);
-      }()} {}
+auto Reader::Sample::getSize() const -> std::size_t { return static_cast<const ChannelSample*>(m_shadow)->size; }
+
+Reader::Reader(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : Reader{adoptReaderEndpoint(
+          connect(clientRequestFor(RequesterType::Reader, ChannelKind::Mailbox,
+                                   {channel_name, max_payload_size, options}),
+                  options.direct_attach),
+          options)} {}
 
 Reader::~Reader() noexcept {
     if (m_shadow == nullptr)
         return;
 
-    disconnect(*static_cast<ChannelPage*>(m_shadow));
+    const auto* const endpoint = &endpointOf(m_shadow);
+    if (endpoint->arm_count != 0U) {
+        endpoint->stats->armed.store(0U, std::memory_order_relaxed);
+        endpoint->page->armed_count.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
     m_shadow = nullptr;
 }
 
+auto Reader::getNotificationFd() const -> int { return endpointOf(m_shadow).notify_fd.fd(); }
+
+void Reader::armNotifications() {
+    auto& endpoint = endpointOf(m_shadow);
+    if (endpoint.arm_count++ == 0U) {
+        endpoint.page->armed_count.fetch_add(1U, std::memory_order_seq_cst);
+        endpoint.stats->armed.store(1U, std::memory_order_relaxed);
+    }
+}
+
+void Reader::disarmNotifications() {
+    auto& endpoint = endpointOf(m_shadow);
+    assert(endpoint.arm_count != 0U);
+    if (--endpoint.arm_count == 0U) {
+        endpoint.stats->armed.store(0U, std::memory_order_relaxed);
+        endpoint.page->armed_count.fetch_sub(1U, std::memory_order_relaxed);
+    }
+}
+
 bool Reader::hasNewData(std::uint64_t sequence_id) const {
-    const auto& channel_page = *static_cast<const ChannelPage*>(m_shadow);
-    const auto index = channel_page.latest_sample_index.load(std::memory_order_relaxed);
+    const auto& channel_page = *endpointOf(m_shadow).page;
+    const auto index = latestIndexOf(channel_page.latest.load(std::memory_order_relaxed));
     const auto& sample = channel_page[index];
 
     return sample.sequence_id > sequence_id;
 }
 
+bool Reader::waitForNewData(std::uint64_t sequence_id, std::chrono::nanoseconds timeout) const {
+    return waitUntil(endpointOf(m_shadow), timeout, [&] { return hasNewData(sequence_id); });
+}
+
+auto Reader::getClockTime() const -> std::chrono::nanoseconds {
+    const auto& channel_page = *endpointOf(m_shadow).page;
+    return clockTimeOf(channel_page, channel_page.read_clock());
+}
+
+auto Reader::readLatest(void* destination, std::size_t size) const -> std::uint64_t {
+    std::size_t payload_size{0U};
+    return readLatest(destination, size, payload_size);
+}
+
+auto Reader::readLatest(void* destination, std::size_t size, std::size_t& payload_size) const -> std::uint64_t {
+    auto& endpoint = endpointOf(m_shadow);
+    const auto& channel_page = *endpoint.page;
+    assert(size <= channel_page.max_payload_size);
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;; bump(endpoint.stats->copy_retries)) {
+        const auto index = latestIndexOf(channel_page.latest.load(std::memory_order_acquire));
+        const auto& sample = channel_page[index];
+
+        const auto begin = sample.seqlock.load(std::memory_order_acquire);
+        if ((begin & 1U) != 0U)
+            // The sample is being rewritten, hence no longer the latest.
+            continue;
+
+        // These plain reads may race with the writer, in which case the
+        // sequence lock will have moved and the copy gets discarded.
+        const auto sequence_id = sample.sequence_id;
+        const auto sample_size = sample.size;
+        std::memcpy(destination, +sample.payload, std::min(size, sample_size));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sample.seqlock.load(std::memory_order_relaxed) == begin) {
+            payload_size = sample_size;
+            observeSample(endpoint, sequence_id);
+            return sequence_id;
+        }
+    }
+}
+
 auto Reader::acquire() -> Sample {
-    auto& channel_page = *static_cast<ChannelPage*>(m_shadow);
-    const auto index = channel_page.latest_sample_index.load(std::memory_order_relaxed);
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    const auto index = referenceLatest(channel_page, endpoint.stats->acquire_retries);
+    hold(endpoint, index);
     auto& sample = channel_page[index];
 
-    // Bump up sample refcount.
-    sample.ref_count.fetch_add(1U, std::memory_order_acquire);
+    bump(endpoint.stats->acquires);
+    observeSample(endpoint, sample.sequence_id);
+    return Sample{static_cast<void*>(&sample), index, &channel_page};
+}
+
+void Reader::acquireHistory(std::size_t count, std::vector<Sample>& samples) {
+    samples.clear();
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    if (channel_page.history_depth == 1U) {
+        if (count != 0U)
+            samples.push_back(acquire());
+        return;
+    }
+
+    const auto head = channel_page.history_head.load(std::memory_order_acquire);
+    count = std::min({count, channel_page.history_depth, static_cast<std::size_t>(head)});
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the history depth
+    for (std::size_t i{0U}; i < count; ++i) {
+        auto& entry = channel_page.history(head - 1U - i);
+        const auto index = entry.load(std::memory_order_acquire);
+        if (index == ChannelPage::kNoSample)
+            continue;
+
+        channel_page[index].ref_count.fetch_add(1U, std::memory_order_acquire);
 
-    // Hint that the sample is being used.
-    channel_page.occupancy.fetch_or(1U << index, std::memory_order_relaxed);
+        // The sample may have been pushed out of the history before our reference landed,
+        // in which case it is older than the ones we are after anyway.
+        if (entry.load(std::memory_order_acquire) != index) {
+            releaseSample(channel_page, index);
+            bump(endpoint.stats->acquire_retries);
+            continue;
+        }
+
+        occupancyWord(channel_page, index).fetch_or(occupancyBit(channel_page, index), std::memory_order_relaxed);
+        hold(endpoint, index);
+        samples.push_back(Sample{static_cast<void*>(&channel_page[index]), index, &channel_page});
+    }
 
-    return Sample{static_cast<void*>(&sample)};
+    std::ranges::sort(samples, {}, &Sample::getSequenceId);
+    bump(endpoint.stats->acquires, samples.size());
+    if (!samples.empty())
+        observeSample(endpoint, samples.back().getSequenceId());
 }
 
-void Reader::release(Sample sample_handle) {
-    auto& channel_page = *static_cast<ChannelPage*>(m_shadow);
-    auto& sample = *static_cast<ChannelSample*>(sample_handle.m_shadow);
+void Reader::getChangedRanges(const Sample& sample_handle, std::uint64_t since_sequence_id,
+                              std::vector<ByteRange>& ranges) const {
+    ranges.clear();
+    const auto& channel_page = *endpointOf(m_shadow).page;
+    const auto& sample = *static_cast<const ChannelSample*>(sample_handle.m_shadow);
+    if (sample.sequence_id <= since_sequence_id)
+        return;
 
-    // Bump down refcount.
-    const auto count = sample.ref_count.fetch_sub(1U, std::memory_order_relaxed);
+    const bool tracked = since_sequence_id >= sample.chain_start;
+    const auto* const versions = channel_page.block_versions(sample);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the payload size
+    for (std::size_t block{0U}; block < channel_page.block_count(); ++block) {
+        if (tracked && std::max(sample.base_version, versions[block]) <= since_sequence_id)
+            continue;
 
-    // If refcount is zero, hint that the sample is not being used.
-    if (count == 1U) {
-        const auto index = channel_page.index_of(sample);
-        channel_page.occupancy.fetch_xor(1U << index, std::memory_order_relaxed);
+        const auto offset = block * kDirtyBlockSize;
+        const auto size = std::min(kDirtyBlockSize, channel_page.max_payload_size - offset);
+        if (!ranges.empty() && ranges.back().offset + ranges.back().size == offset)
+            ranges.back().size += size;
+        else
+            ranges.push_back({.offset = offset, .size = size});
     }
 }
 
+void Reader::release(Sample sample_handle) {
+    auto& endpoint = endpointOf(m_shadow);
+    unhold(endpoint, sample_handle.m_index);
+    releaseSample(*endpoint.page, sample_handle.m_index);
+    bump(endpoint.stats->releases);
+}
+
 auto Writer::Sample::getSequenceId() const -> std::uint64_t {
     return static_cast<const ChannelSample*>(m_shadow)->sequence_id;
 }
 
 auto Writer::Sample::getPayload() -> void* { return +static_cast<ChannelSample*>(m_shadow)->payload; }
 
-Writer::Writer(std::string_view channel_name, std::size_t max_payload_size)
-    : m_shadow{[=]() {
-          auto& channel = connect(
-              {.type = RequesterType::Writer, .max_payload_size = max_payload_size, .topic_name = channel_name});
-          std::println("channel sample size: {}", channel.max_payload_size);
-
-          assert(channel.max_payload_size == max_payload_size);
-          return static_cast<void*>(&channel);
-      }()} {}
+Writer::Writer(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : Writer{adoptWriterEndpoint(
+          connect(clientRequestFor(RequesterType::Writer, ChannelKind::Mailbox,
+                                   {channel_name, max_payload_size, options}),
+                  options.direct_attach),
+          options)} {}
 
 Writer::~Writer() noexcept {
     if (m_shadow == nullptr)
         return;
 
-    disconnect(*static_cast<ChannelPage*>(m_shadow));
+    const auto* const endpoint = &endpointOf(m_shadow);
+    if (endpoint->spare_index != Endpoint::kNoSlot) {
+        unhold(*endpoint, endpoint->spare_index);
+        releaseSample(*endpoint->page, endpoint->spare_index);
+    }
+
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
     m_shadow = nullptr;
 }
 
+auto Writer::tryPrepare() -> std::optional<Sample> {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+
+    const auto index = claimPreparedSlot(endpoint);
+    if (index == Endpoint::kNoSlot)
+        return std::nullopt;
+
+    beginSample(channel_page, index);
+    bump(endpoint.stats->prepares);
+    return Sample{static_cast<void*>(&channel_page[index]), index};
+}
+
+auto Writer::prepareFor(std::chrono::steady_clock::time_point deadline) -> std::optional<Sample> {
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;;) {
+        if (auto sample = tryPrepare())
+            return sample;
+        if (std::chrono::steady_clock::now() >= deadline)
+            return std::nullopt;
+        cpuRelax();
+    }
+}
+
 auto Writer::prepare() -> Sample {
-    auto& channel_page = *static_cast<ChannelPage*>(m_shadow);
-    for (;; std::this_thread::yield()) {
-        // Read occupancy hints.
-        auto occupancy = channel_page.occupancy.load(std::memory_order_relaxed);
-        if (~occupancy == 0U)
-            // Everything is occupied, which is very unlikely.
-            continue;
+    auto& stats = *endpointOf(m_shadow).stats;
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;; bump(stats.prepare_yields), std::this_thread::yield()) {
+        if (auto sample = tryPrepare())
+            return *sample;
+        // Everything is occupied or all hints were racy,
+        // which is very much unlikely given enough slots.
+    }
+}
 
-        // NOLINTNEXTLINE(altera-id-dependent-backward-branch,altera-unroll-loops) Let's benchmark first
-        for (std::size_t index{0U}; (index = std::countr_one(occupancy)) < std::numeric_limits<std::uint64_t>::digits;
-             occupancy |= (1U << index)) {
-            auto& sample = channel_page[index];
-            std::uint64_t expected_count{0U};
-            constexpr std::uint64_t kDesiredCount{1U};
-            if (sample.ref_count.compare_exchange_strong(expected_count, kDesiredCount, std::memory_order_relaxed))
-                // The hint for this sample was racy.
-                continue;
+auto Writer::prepareFromLatest() -> Sample {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
 
-            // The sample is ours now.
-            // Bump the seq id now but do not stamp,
-            // thus making writer races visible from logs.
-            sample.sequence_id = channel_page.next_seq_id.fetch_add(1U, std::memory_order_relaxed);
-            return Sample{static_cast<void*>(&sample)};
-        }
-        // Everything is occupied and all hints were racy,
-        // which is very much unlikely.
+    auto index = Endpoint::kNoSlot;
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    while ((index = claimPreparedSlot(endpoint)) == Endpoint::kNoSlot) {
+        bump(endpoint.stats->prepare_yields);
+        std::this_thread::yield();
     }
+
+    const auto stale_base_version = channel_page[index].base_version;
+    beginSample(channel_page, index);
+    seedFromLatest(endpoint, index, stale_base_version);
+
+    bump(endpoint.stats->prepares);
+    return Sample{static_cast<void*>(&channel_page[index]), index};
 }
 
-void Writer::submit(Sample sample_handle) {
-    auto& channel_page = *static_cast<ChannelPage*>(m_shadow);
+void Writer::markDirty(const Sample& sample_handle, std::size_t offset, std::size_t size) {
+    const auto& channel_page = *endpointOf(m_shadow).page;
     auto& sample = *static_cast<ChannelSample*>(sample_handle.m_shadow);
+    assert(offset + size <= channel_page.max_payload_size);
+    if (size == 0U)
+        return;
+
+    auto* const versions = channel_page.block_versions(sample);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the payload size
+    for (auto block = offset / kDirtyBlockSize; block <= (offset + size - 1U) / kDirtyBlockSize; ++block)
+        versions[block] = sample.sequence_id;
+}
+
+void Writer::submit(Sample sample_handle) { submit(sample_handle, endpointOf(m_shadow).page->max_payload_size); }
+
+void Writer::submit(Sample sample_handle, std::size_t payload_size) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    auto& sample = *static_cast<ChannelSample*>(sample_handle.m_shadow);
+    assert(payload_size <= channel_page.max_payload_size);
+
+    sample.size = payload_size;
 
     // Timestamp the sample
-    sample.timestamp = std::chrono::system_clock::now();
+    sample.timestamp = channel_page.read_clock();
+    if (channel_page.trace_depth != 0U)
+        traceSubmitted(channel_page, sample.sequence_id, sample.timestamp);
+
+    // Let copy-out readers in again.
+    sample.seqlock.store(sample.seqlock.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+
+    // Pin the sample in the history, unpinning the one it pushes out.
+    if (channel_page.history_depth != 1U) {
+        sample.ref_count.fetch_add(1U, std::memory_order_relaxed);
+        const auto position = channel_page.history_head.fetch_add(1U, std::memory_order_relaxed);
+        const auto evicted_index =
+            channel_page.history(position).exchange(sample_handle.m_index, std::memory_order_acq_rel);
+        if (evicted_index != ChannelPage::kNoSample)
+            releaseSample(channel_page, evicted_index);
+    }
+
+    // Hand our reference over to the channel as its latest sample, unless a newer one got submitted meanwhile, in
+    // which case ours is dropped rather than taking it over.
+    unhold(endpoint, sample_handle.m_index);
+    const auto word = latestWordOf(sample_handle.m_index, sample.sequence_id);
+    auto latest = channel_page.latest.load(std::memory_order_relaxed);
+    bool published{false};
+    // NOLINTNEXTLINE(altera-unroll-loops) Only retried on races with other writers
+    while (!published && isNewerThan(sample.sequence_id, latest))
+        published = channel_page.latest.compare_exchange_weak(latest, word, std::memory_order_acq_rel,
+                                                              std::memory_order_relaxed);
+    const auto previous_index = published ? latestIndexOf(latest) : sample_handle.m_index;
+
+    // Drop the reference held on behalf of being the latest, or our own.
+    const bool previous_released = releaseSample(channel_page, previous_index);
+
+    notifyReaders(endpoint);
+
+    // Refill the spare slot off the prepare path, preferably with the sample we just retired.
+    if (endpoint.reserve_spare_slot && endpoint.spare_index == Endpoint::kNoSlot) {
+        endpoint.spare_index = previous_released && claimSample(channel_page, previous_index)
+                                   ? previous_index
+                                   : claimAnySample(channel_page, *endpoint.stats, endpoint.lane);
+        if (endpoint.spare_index != Endpoint::kNoSlot)
+            hold(endpoint, endpoint.spare_index);
+    }
+
+    bump(endpoint.stats->submits);
+}
+
+namespace {
+
+[[nodiscard]] void* adoptQueueWriterEndpoint(Endpoint endpoint, const ChannelOptions& options) {
+    setUpMemory(endpoint, options);
+
+    return new Endpoint{std::move(endpoint)};
+}
+
+[[nodiscard]] void* adoptQueueReaderEndpoint(Endpoint endpoint, const ChannelOptions& options) {
+    auto& channel_page = *endpoint.page;
+    // Claim the queue as our record's owner, so that the tower can free it on our behalf.
+    const auto pid = endpoint.record == ChannelPage::kNoRecord
+                         ? static_cast<std::int32_t>(::getpid())
+                         : endpoint.stats->owner_pid.load(std::memory_order_relaxed);
+    std::int32_t free_pid{0};
+    if (!channel_page.queue_reader_pid.compare_exchange_strong(free_pid, pid, std::memory_order_acquire))
+        expect(io::expected<void>{io::unexpected{std::make_error_code(std::errc::device_or_resource_busy)}},
+               "queue channel already has a reader");
+
+    setUpMemory(endpoint, options);
+
+    auto* const adopted = new Endpoint{std::move(endpoint)};
+    // Pick up after the previous reader, including whatever it left unreleased.
+    adopted->queue_position = channel_page.queue_tail.load(std::memory_order_relaxed);
+
+    return adopted;
+}
+
+[[nodiscard]] ChannelPage& queueOf(void* shadow) noexcept { return *static_cast<ChannelPage*>(shadow); }
+
+} // namespace
+
+auto QueueWriter::Batch::getSequenceId(std::size_t index) const -> std::uint64_t {
+    assert(index < m_size);
+    return queueOf(m_shadow).queue_slot(m_position + index).sequence_id;
+}
+
+auto QueueWriter::Batch::getPayload(std::size_t index) -> void* {
+    assert(index < m_size);
+    return +queueOf(m_shadow).queue_slot(m_position + index).payload;
+}
+
+void QueueWriter::Batch::setSize(std::size_t index, std::size_t payload_size) {
+    assert(index < m_size);
+    auto& channel_page = queueOf(m_shadow);
+    assert(payload_size <= channel_page.max_payload_size);
+    channel_page.queue_slot(m_position + index).size = payload_size;
+}
+
+QueueWriter::QueueWriter(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : m_shadow{adoptQueueWriterEndpoint(
+          connect(clientRequestFor(RequesterType::Writer, ChannelKind::Queue,
+                                   {channel_name, max_payload_size, options}),
+                  options.direct_attach),
+          options)} {}
+
+QueueWriter::~QueueWriter() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    const auto* const endpoint = &endpointOf(m_shadow);
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
+    m_shadow = nullptr;
+}
+
+auto QueueWriter::tryPrepareBatch(std::size_t max_count) -> Batch {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    if (max_count == 0U)
+        return Batch{&channel_page, 0U, 0U};
+
+    auto head = channel_page.queue_head.load(std::memory_order_relaxed);
+    std::size_t count{0U};
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;;) {
+        // The reader frees slots in queue order, so the free ones all follow the head.
+        count = 0U;
+        // NOLINTNEXTLINE(altera-id-dependent-backward-branch,altera-unroll-loops) Bounded by the slot count
+        while (count < max_count &&
+               channel_page.queue_slot(head + count).turn.load(std::memory_order_acquire) == head + count)
+            ++count;
+
+        if (count == 0U) {
+            if (channel_page.queue_slot(head).turn.load(std::memory_order_acquire) < head) {
+                // The slot still holds the sample of the previous lap.
+                bump(endpoint.stats->prepare_retries);
+                return Batch{&channel_page, head, 0U};
+            }
+            // Another writer got there first.
+            head = channel_page.queue_head.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (channel_page.queue_head.compare_exchange_weak(head, head + count, std::memory_order_relaxed))
+            break;
+    }
+
+    const auto now = channel_page.trace_depth != 0U ? channel_page.read_clock() : 0U;
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t i{0U}; i < count; ++i) {
+        auto& sample = channel_page.queue_slot(head + i);
+        // Let the tower publish the position on our behalf, should we crash before submitting.
+        sample.reservation.store(ChannelPage::reservation_of(head + i, endpoint.record), std::memory_order_relaxed);
+        sample.sequence_id = head + i + 1U;
+        sample.size = channel_page.max_payload_size;
+        if (channel_page.trace_depth != 0U)
+            tracePrepared(channel_page, sample.sequence_id, now);
+    }
+
+    bump(endpoint.stats->prepares, count);
+    return Batch{&channel_page, head, count};
+}
+
+auto QueueWriter::prepareBatchFor(std::size_t max_count, std::chrono::steady_clock::time_point deadline) -> Batch {
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;;) {
+        auto batch = tryPrepareBatch(max_count);
+        if (!batch.empty() || std::chrono::steady_clock::now() >= deadline)
+            return batch;
+        cpuRelax();
+    }
+}
+
+void QueueWriter::submit(Batch batch) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    if (batch.empty())
+        return;
+
+    const auto timestamp = channel_page.read_clock();
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t i{0U}; i < batch.m_size; ++i) {
+        const auto position = batch.m_position + i;
+        auto& sample = channel_page.queue_slot(position);
+        sample.timestamp = timestamp;
+        if (channel_page.trace_depth != 0U)
+            traceSubmitted(channel_page, sample.sequence_id, timestamp);
+        sample.turn.store(position + 1U, std::memory_order_release);
+    }
+
+    notifyReaders(endpoint);
+    bump(endpoint.stats->submits, batch.m_size);
+}
+
+auto QueueReader::Batch::getSequenceId(std::size_t index) const -> std::uint64_t {
+    assert(index < m_size);
+    return queueOf(m_shadow).queue_slot(m_position + index).sequence_id;
+}
+
+auto QueueReader::Batch::getTimestamp(std::size_t index) const -> std::chrono::system_clock::time_point {
+    assert(index < m_size);
+    const auto& channel_page = queueOf(m_shadow);
+    return systemTimeOf(channel_page, channel_page.queue_slot(m_position + index).timestamp);
+}
+
+auto QueueReader::Batch::getClockTimestamp(std::size_t index) const -> std::chrono::nanoseconds {
+    assert(index < m_size);
+    const auto& channel_page = queueOf(m_shadow);
+    return clockTimeOf(channel_page, channel_page.queue_slot(m_position + index).timestamp);
+}
+
+auto QueueReader::Batch::getPayload(std::size_t index) const -> const void* {
+    assert(index < m_size);
+    return +queueOf(m_shadow).queue_slot(m_position + index).payload;
+}
+
+auto QueueReader::Batch::getSize(std::size_t index) const -> std::size_t {
+    assert(index < m_size);
+    return queueOf(m_shadow).queue_slot(m_position + index).size;
+}
+
+QueueReader::QueueReader(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : m_shadow{adoptQueueReaderEndpoint(
+          connect(clientRequestFor(RequesterType::Reader, ChannelKind::Queue,
+                                   {channel_name, max_payload_size, options}),
+                  options.direct_attach),
+          options)} {}
+
+QueueReader::~QueueReader() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    const auto* const endpoint = &endpointOf(m_shadow);
+    endpoint->page->queue_reader_pid.store(0, std::memory_order_release);
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
+    m_shadow = nullptr;
+}
+
+auto QueueReader::hasData() const -> bool {
+    const auto& endpoint = endpointOf(m_shadow);
+    const auto position = endpoint.queue_position;
+    return endpoint.page->queue_slot(position).turn.load(std::memory_order_acquire) == position + 1U;
+}
+
+auto QueueReader::waitForData(std::chrono::nanoseconds timeout) const -> bool {
+    return waitUntil(endpointOf(m_shadow), timeout, [&] { return hasData(); });
+}
+
+auto QueueReader::getClockTime() const -> std::chrono::nanoseconds {
+    const auto& channel_page = *endpointOf(m_shadow).page;
+    return clockTimeOf(channel_page, channel_page.read_clock());
+}
+
+auto QueueReader::acquireBatch(std::size_t max_count) -> Batch {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    const auto position = endpoint.queue_position;
+
+    // Stop at the first sample not published yet, even if later ones are.
+    std::size_t count{0U};
+    // NOLINTNEXTLINE(altera-id-dependent-backward-branch,altera-unroll-loops) Bounded by the slot count
+    while (count < max_count &&
+           channel_page.queue_slot(position + count).turn.load(std::memory_order_acquire) == position + count + 1U)
+        ++count;
+
+    if (count != 0U && channel_page.trace_depth != 0U) {
+        const auto now = channel_page.read_clock();
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+        for (std::size_t i{0U}; i < count; ++i)
+            traceAcquired(channel_page, position + i + 1U, now);
+    }
+
+    endpoint.queue_position += count;
+    bump(endpoint.stats->acquires, count);
+    return Batch{&channel_page, position, count};
+}
+
+void QueueReader::releaseBatch(Batch batch) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    assert(batch.m_position == channel_page.queue_tail.load(std::memory_order_relaxed));
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t i{0U}; i < batch.m_size; ++i) {
+        const auto position = batch.m_position + i;
+        channel_page.queue_slot(position).turn.store(position + channel_page.slot_count, std::memory_order_release);
+    }
+
+    channel_page.queue_tail.store(batch.m_position + batch.m_size, std::memory_order_relaxed);
+    bump(endpoint.stats->releases, batch.m_size);
+}
+
+namespace {
+
+/// Polls of a call's state before its client goes to sleep, as replies typically take less time than being woken up
+constexpr std::size_t kReplySpinCount{1024U};
+
+[[nodiscard]] ChannelPage& rpcChannelOf(void* shadow) noexcept { return *static_cast<ChannelPage*>(shadow); }
+
+[[nodiscard]] constexpr bool isSettled(std::uint32_t state) noexcept {
+    return rpcStateOf(state) == RpcState::Replied || rpcStateOf(state) == RpcState::Dropped;
+}
+
+/// Whether a slot holds a posted request, only looking at slots some client holds
+[[nodiscard]] bool isPosted(ChannelPage& channel_page, std::size_t index) noexcept {
+    return (occupancyWord(channel_page, index).load(std::memory_order_relaxed) & occupancyBit(channel_page, index)) !=
+               0U &&
+           rpcStateOf(channel_page[index].rpc_state.load(std::memory_order_relaxed)) == RpcState::Requested;
+}
+
+/// Takes a reference to a sample only if someone else holds one already
+[[nodiscard]] bool shareSample(ChannelSample& sample) noexcept {
+    auto count = sample.ref_count.load(std::memory_order_relaxed);
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    while (count != 0U) {
+        if (sample.ref_count.compare_exchange_weak(count, count + 1U, std::memory_order_acquire))
+            return true;
+    }
+    return false;
+}
+
+[[nodiscard]] void* adoptRpcEndpoint(Endpoint endpoint, const ChannelOptions& options) {
+    setUpMemory(endpoint, options);
+
+    return new Endpoint{std::move(endpoint)};
+}
+
+} // namespace
+
+auto RpcClient::Call::getCorrelationId() const -> std::uint64_t { return rpcChannelOf(m_shadow)[m_index].sequence_id; }
+
+auto RpcClient::Call::getPayload() const -> void* { return +rpcChannelOf(m_shadow)[m_index].payload; }
+
+auto RpcClient::Call::getSize() const -> std::size_t { return rpcChannelOf(m_shadow)[m_index].size; }
+
+auto RpcClient::Call::isDropped() const -> bool {
+    return rpcStateOf(rpcChannelOf(m_shadow)[m_index].rpc_state.load(std::memory_order_acquire)) == RpcState::Dropped;
+}
+
+RpcClient::RpcClient(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : m_shadow{adoptRpcEndpoint(connect(clientRequestFor(RequesterType::Writer, ChannelKind::Rpc,
+                                                         {channel_name, max_payload_size, options}),
+                                        options.direct_attach),
+                                options)} {}
+
+RpcClient::~RpcClient() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    const auto* const endpoint = &endpointOf(m_shadow);
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
+    m_shadow = nullptr;
+}
+
+auto RpcClient::prepare() -> Call {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+
+    auto index = Endpoint::kNoSlot;
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    while ((index = claimAnySample(channel_page, *endpoint.stats)) == Endpoint::kNoSlot) {
+        bump(endpoint.stats->prepare_yields);
+        std::this_thread::yield();
+    }
+    hold(endpoint, index);
+
+    auto& sample = channel_page[index];
+    // Servers only ever take slots holding a request, which a freed slot never does.
+    sample.rpc_state.store(static_cast<std::uint32_t>(RpcState::Idle), std::memory_order_relaxed);
+    sample.sequence_id = channel_page.next_seq_id.fetch_add(1U, std::memory_order_relaxed);
+    sample.size = 0U;
+    if (channel_page.trace_depth != 0U)
+        tracePrepared(channel_page, sample.sequence_id, channel_page.read_clock());
+
+    bump(endpoint.stats->prepares);
+    return Call{&channel_page, index};
+}
+
+void RpcClient::post(const Call& call, std::size_t payload_size) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    auto& sample = channel_page[call.m_index];
+    assert(payload_size <= channel_page.max_payload_size);
+
+    sample.size = payload_size;
+    sample.timestamp = channel_page.read_clock();
+    if (channel_page.trace_depth != 0U)
+        traceSubmitted(channel_page, sample.sequence_id, sample.timestamp);
+    sample.rpc_state.store(static_cast<std::uint32_t>(RpcState::Requested), std::memory_order_release);
+
+    notifyReaders(endpoint);
+    bump(endpoint.stats->submits);
+}
+
+auto RpcClient::waitForReply(const Call& call, std::chrono::nanoseconds timeout) const -> bool {
+    auto& sample = (*endpointOf(m_shadow).page)[call.m_index];
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Spin loops should not be unrolled
+    for (std::size_t spin{0U}; spin < kReplySpinCount; ++spin) {
+        if (isSettled(sample.rpc_state.load(std::memory_order_acquire)))
+            return true;
+        cpuRelax();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    // NOLINTNEXTLINE(altera-unroll-loops) Wait loops should not be unrolled
+    for (;;) {
+        // Flag ourselves as waiting before sleeping, for the server to know to wake us up.
+        const auto state = sample.rpc_state.fetch_or(kRpcCallerWaiting, std::memory_order_acquire);
+        if (isSettled(state))
+            return true;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            return false;
+
+        // Spurious wake-ups, signals and races with the server all end up re-checking.
+        static_cast<void>(io::futexWait(sample.rpc_state, state | kRpcCallerWaiting, deadline - now));
+    }
+}
+
+auto RpcClient::call(const Call& call, std::size_t payload_size, std::chrono::nanoseconds timeout) -> bool {
+    post(call, payload_size);
+    return waitForReply(call, timeout);
+}
+
+void RpcClient::release(Call call) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+
+    // A server which took the request already keeps the slot until replying.
+    abandonCall(channel_page[call.m_index], true);
+    unhold(endpoint, call.m_index);
+    releaseSample(channel_page, call.m_index);
+}
+
+auto RpcServer::Call::getCorrelationId() const -> std::uint64_t { return rpcChannelOf(m_shadow)[m_index].sequence_id; }
+
+auto RpcServer::Call::getPayload() const -> void* { return +rpcChannelOf(m_shadow)[m_index].payload; }
+
+auto RpcServer::Call::getSize() const -> std::size_t { return rpcChannelOf(m_shadow)[m_index].size; }
+
+RpcServer::RpcServer(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    : m_shadow{adoptRpcEndpoint(connect(clientRequestFor(RequesterType::Reader, ChannelKind::Rpc,
+                                                         {channel_name, max_payload_size, options}),
+                                        options.direct_attach),
+                                options)} {}
+
+RpcServer::~RpcServer() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    // Calls accepted yet not replied to get dropped along with our record.
+    const auto* const endpoint = &endpointOf(m_shadow);
+    releaseEndpoint(*endpoint);
+    disconnect(*endpoint);
+    delete endpoint;
+    m_shadow = nullptr;
+}
+
+auto RpcServer::hasRequests() const -> bool {
+    auto& channel_page = *endpointOf(m_shadow).page;
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t index{0U}; index < channel_page.slot_count; ++index) {
+        if (isPosted(channel_page, index))
+            return true;
+    }
+    return false;
+}
+
+auto RpcServer::waitForRequests(std::chrono::nanoseconds timeout) const -> bool {
+    return waitUntil(endpointOf(m_shadow), timeout, [&] { return hasRequests(); });
+}
+
+auto RpcServer::tryAccept() -> std::optional<Call> {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    const auto slot_count = channel_page.slot_count;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the slot count
+    for (std::size_t i{0U}; i < slot_count; ++i) {
+        const auto index = static_cast<std::size_t>((endpoint.queue_position + i) % slot_count);
+        if (!isPosted(channel_page, index))
+            continue;
+
+        // Keep the slot from being recycled should the client let go of the call, before taking the request.
+        auto& sample = channel_page[index];
+        if (!shareSample(sample))
+            continue;
+
+        auto state = sample.rpc_state.load(std::memory_order_acquire);
+        // NOLINTNEXTLINE(altera-unroll-loops) Only retried on races with the client flagging itself waiting
+        while (rpcStateOf(state) == RpcState::Requested &&
+               !sample.rpc_state.compare_exchange_weak(
+                   state, static_cast<std::uint32_t>(RpcState::Serving) | (state & kRpcCallerWaiting),
+                   std::memory_order_acquire)) {
+        }
+        if (rpcStateOf(state) != RpcState::Requested) {
+            // Withdrawn, or taken by another server.
+            bump(endpoint.stats->acquire_retries);
+            releaseSample(channel_page, index);
+            continue;
+        }
+
+        hold(endpoint, index);
+        // Resume past the request next time, so that none gets passed over for long.
+        endpoint.queue_position = index + 1U;
+        if (channel_page.trace_depth != 0U)
+            traceAcquired(channel_page, sample.sequence_id, channel_page.read_clock());
+
+        bump(endpoint.stats->acquires);
+        return Call{&channel_page, index};
+    }
+
+    return std::nullopt;
+}
+
+void RpcServer::reply(Call call, std::size_t payload_size) {
+    auto& endpoint = endpointOf(m_shadow);
+    auto& channel_page = *endpoint.page;
+    auto& sample = channel_page[call.m_index];
+    assert(payload_size <= channel_page.max_payload_size);
+
+    sample.size = payload_size;
+    // Our reference keeps the slot ours until the client is woken up.
+    const auto state =
+        sample.rpc_state.exchange(static_cast<std::uint32_t>(RpcState::Replied), std::memory_order_acq_rel);
+    if ((state & kRpcCallerWaiting) != 0U)
+        io::futexWake(sample.rpc_state);
+
+    unhold(endpoint, call.m_index);
+    releaseSample(channel_page, call.m_index);
+    bump(endpoint.stats->releases);
+}
+
+namespace {
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct WaitSetState final {
+    io::Fd epollfd;
+    std::vector<Reader*> readers{};
+    std::vector<std::size_t> ready{};
+};
+
+[[nodiscard]] WaitSetState& waitSetOf(void* shadow) noexcept { return *static_cast<WaitSetState*>(shadow); }
+
+} // namespace
+
+WaitSet::WaitSet()
+    : m_shadow{new WaitSetState{
+          .epollfd = expect(io::adoptSysFd(::epoll_create1(EPOLL_CLOEXEC)), "failed to create epoll instance")}} {}
+
+WaitSet::~WaitSet() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    const auto* const state = &waitSetOf(m_shadow);
+    for (auto* const reader : state->readers)
+        reader->disarmNotifications();
+
+    delete state;
+    m_shadow = nullptr;
+}
+
+auto WaitSet::add(Reader& reader) -> std::size_t {
+    auto& state = waitSetOf(m_shadow);
+    const auto index = state.readers.size();
+
+    // Writers never drain the shared descriptor, so only edges are meaningful.
+    ::epoll_event event{.events = EPOLLIN | EPOLLET, .data = {.u64 = index}};
+    expect(io::sysCheck(::epoll_ctl(state.epollfd.fd(), EPOLL_CTL_ADD, reader.getNotificationFd(), &event)),
+           "failed to watch notification descriptor");
+
+    state.readers.push_back(&reader);
+    reader.armNotifications();
+
+    return index;
+}
+
+auto WaitSet::wait(std::chrono::nanoseconds timeout) -> const std::vector<std::size_t>& {
+    auto& state = waitSetOf(m_shadow);
+    state.ready.clear();
+
+    constexpr std::size_t kMaxEvents{64U};
+    std::array<::epoll_event, kMaxEvents> events{};
+    const auto timeout_ms = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(timeout).count());
+
+    const auto count = ::epoll_wait(state.epollfd.fd(), events.data(), events.size(), timeout_ms);
+    if (count < 0 && errno == EINTR)
+        return state.ready;
+    expect(io::sysCheck(count), "failed to wait for notifications");
+
+    for (const auto& event : std::span{events}.first(static_cast<std::size_t>(count)))
+        state.ready.push_back(event.data.u64);
+
+    return state.ready;
+}
+
+namespace {
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct SessionState final {
+    io::Fd sockfd;
+};
+
+[[nodiscard]] SessionState& sessionOf(void* shadow) noexcept { return *static_cast<SessionState*>(shadow); }
+
+[[nodiscard]] std::vector<Endpoint> openSessionEndpoints(void* shadow, RequesterType type,
+                                                         std::span<const ChannelRequest> requests) {
+    std::vector<ClientRequest> client_requests;
+    client_requests.reserve(requests.size());
+    for (const auto& request : requests)
+        client_requests.push_back(clientRequestFor(type, ChannelKind::Mailbox, request));
+
+    return openEndpoints(sessionOf(shadow).sockfd, client_requests);
+}
+
+} // namespace
+
+Session::Session() : m_shadow{new SessionState{.sockfd = connectTower()}} {}
+
+Session::Session(std::string_view tower_path) : m_shadow{new SessionState{.sockfd = connectTower(tower_path)}} {}
+
+Session::~Session() noexcept {
+    if (m_shadow == nullptr)
+        return;
+
+    delete &sessionOf(m_shadow);
+    m_shadow = nullptr;
+}
+
+auto Session::openReaders(const std::vector<ChannelRequest>& requests) -> std::vector<Reader> {
+    auto endpoints = openSessionEndpoints(m_shadow, RequesterType::Reader, requests);
+
+    std::vector<Reader> readers;
+    readers.reserve(endpoints.size());
+    // NOLINTNEXTLINE(altera-unroll-loops) Readers are set up one by one
+    for (std::size_t i{0U}; i < endpoints.size(); ++i)
+        readers.push_back(Reader{adoptReaderEndpoint(std::move(endpoints[i]), requests[i].options)});
+
+    return readers;
+}
+
+auto Session::openWriters(const std::vector<ChannelRequest>& requests) -> std::vector<Writer> {
+    auto endpoints = openSessionEndpoints(m_shadow, RequesterType::Writer, requests);
+
+    std::vector<Writer> writers;
+    writers.reserve(endpoints.size());
+    // NOLINTNEXTLINE(altera-unroll-loops) Writers are set up one by one
+    for (std::size_t i{0U}; i < endpoints.size(); ++i)
+        writers.push_back(Writer{adoptWriterEndpoint(std::move(endpoints[i]), requests[i].options)});
+
+    return writers;
+}
+
+auto Session::openReader(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    -> Reader {
+    return std::move(openReaders({{channel_name, max_payload_size, options}}).front());
+}
+
+auto Session::openWriter(std::string_view channel_name, std::size_t max_payload_size, const ChannelOptions& options)
+    -> Writer {
+    return std::move(openWriters({{channel_name, max_payload_size, options}}).front());
+}
 
-    // Update latest sample index
-    const auto index = channel_page.index_of(sample);
-    const auto previous_index = channel_page.latest_sample_index.exchange(index, std::memory_order_release);
+auto Session::tryOpenWriter(std::string_view channel_name, std::size_t max_payload_size, OpenStatus& status,
+                            const ChannelOptions& options) -> std::optional<Writer> {
+    const ChannelRequest request{channel_name, max_payload_size, options};
+    const auto client_request = clientRequestFor(RequesterType::Writer, ChannelKind::Mailbox, request);
 
-    // Bump down previous sample's refcount.
-    auto& previous_sample = channel_page[previous_index];
-    const auto count = previous_sample.ref_count.fetch_sub(1U, std::memory_order_relaxed);
+    std::vector<Endpoint> endpoints;
+    status = openBatch(sessionOf(m_shadow).sockfd, {&client_request, 1U}, endpoints, true);
+    if (status != ReplyStatus::Ok)
+        return std::nullopt;
 
-    // If refcount is zero, hint that the previous latest sample is not being
-    // used.
-    if (count == 1U)
-        channel_page.occupancy.fetch_xor(1U << previous_index, std::memory_order_relaxed);
+    return Writer{adoptWriterEndpoint(std::move(endpoints.front()), options)};
 }
 
 } // namespace fastipc
@@ -0,0 +1,355 @@
+/*
+ *  inspect.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "inspect.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "io/cursor.hxx"
+#include "io/fd.hxx"
+#include "io/numa.hxx"
+#include "io/result.hxx"
+#include "channel.hxx"
+#include "local_proto.hxx"
+#include "registry.hxx"
+
+namespace fastipc {
+namespace {
+
+static_assert(std::is_trivially_copyable_v<EndpointSnapshot>);
+static_assert(std::is_trivially_copyable_v<LatencySummary>);
+
+template <typename T>
+void append(std::vector<std::byte>& buf, const T& value) {
+    const auto* const bytes = reinterpret_cast<const std::byte*>(&value);
+    buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+
+[[nodiscard]] io::unexpected malformed() noexcept {
+    return io::unexpected{std::make_error_code(std::errc::bad_message)};
+}
+
+/// Snapshots the claimed stats records of a channel
+void snapshotEndpoints(const impl::ChannelPage& channel_page, std::vector<EndpointSnapshot>& endpoints) {
+    // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+    for (std::size_t record{0U}; record < channel_page.record_count; ++record) {
+        const auto& stats = channel_page.stats(record);
+        const auto pid = stats.owner_pid.load(std::memory_order_acquire);
+        if (pid == 0)
+            continue;
+
+        endpoints.push_back({
+            .record = static_cast<std::uint32_t>(record),
+            .pid = pid,
+            .alive = ownerState(stats) != OwnerState::Gone,
+            .role = stats.role,
+            .prepares = stats.prepares.load(std::memory_order_relaxed),
+            .submits = stats.submits.load(std::memory_order_relaxed),
+            .prepare_retries = stats.prepare_retries.load(std::memory_order_relaxed),
+            .prepare_yields = stats.prepare_yields.load(std::memory_order_relaxed),
+            .racy_hints = stats.racy_hints.load(std::memory_order_relaxed),
+            .acquires = stats.acquires.load(std::memory_order_relaxed),
+            .releases = stats.releases.load(std::memory_order_relaxed),
+            .acquire_retries = stats.acquire_retries.load(std::memory_order_relaxed),
+            .copy_retries = stats.copy_retries.load(std::memory_order_relaxed),
+            .skipped_sequence_ids = stats.skipped_sequence_ids.load(std::memory_order_relaxed),
+        });
+    }
+}
+
+/// Summarizes latencies, in whatever order
+[[nodiscard]] LatencySummary summarize(std::vector<std::uint64_t>& latencies) {
+    if (latencies.empty())
+        return {};
+
+    const auto at = [&](std::size_t percent) {
+        const auto nth = latencies.begin() + static_cast<std::ptrdiff_t>((latencies.size() - 1U) * percent / 100U);
+        std::ranges::nth_element(latencies, nth);
+        return *nth;
+    };
+    return {.count = latencies.size(), .median = at(50U), .p99 = at(99U), .max = std::ranges::max(latencies)};
+}
+
+/// Summarizes the latencies of the samples found in the trace ring of a channel
+///
+/// Entries being rewritten concurrently, or attributed an acquisition of their previous occupant, get skipped.
+void snapshotTrace(const impl::ChannelPage& channel_page, ChannelSnapshot& snapshot) {
+    std::vector<std::uint64_t> fill;
+    std::vector<std::uint64_t> delivery;
+    fill.reserve(channel_page.trace_depth);
+    delivery.reserve(channel_page.trace_depth);
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+    for (std::size_t position{0U}; position < channel_page.trace_depth; ++position) {
+        const auto& entry = channel_page.trace(position);
+        const auto sequence_id = entry.sequence_id.load(std::memory_order_acquire);
+        const auto prepared = entry.prepared.load(std::memory_order_relaxed);
+        const auto submitted = entry.submitted.load(std::memory_order_acquire);
+        const auto acquired = entry.acquired.load(std::memory_order_relaxed);
+        if (sequence_id == 0U || entry.sequence_id.load(std::memory_order_acquire) != sequence_id || submitted == 0U ||
+            submitted < prepared)
+            continue;
+
+        fill.push_back(channel_page.clock_span(prepared, submitted));
+        if (acquired >= submitted)
+            delivery.push_back(channel_page.clock_span(submitted, acquired));
+    }
+
+    snapshot.fill_latency = summarize(fill);
+    snapshot.delivery_latency = summarize(delivery);
+}
+
+/// Node holding most of the pages of a channel, among those faulted in by the calling process
+[[nodiscard]] std::int32_t residentNodeOf(const impl::ChannelPage& channel_page) {
+    return io::residentNumaNode(&channel_page,
+                                impl::ChannelPage::total_size(channel_page.max_payload_size, channel_page.slot_count,
+                                                              channel_page.writer_lanes, channel_page.history_depth,
+                                                              channel_page.trace_depth, channel_page.record_count));
+}
+
+} // namespace
+
+ChannelSnapshot snapshotChannel(std::string_view name, impl::ChannelPage& channel_page) {
+    if (channel_page.kind == ChannelKind::Queue) {
+        const auto tail = channel_page.queue_tail.load(std::memory_order_relaxed);
+        const auto head = std::max(channel_page.queue_head.load(std::memory_order_relaxed), tail);
+        ChannelSnapshot snapshot{
+            .name = std::string{name},
+            .kind = ChannelKind::Queue,
+            .max_payload_size = channel_page.max_payload_size,
+            .slot_count = channel_page.slot_count,
+            .occupied_slots = head - tail,
+            .latest_sequence_id = head,
+            .waiter_count = channel_page.waiter_count.load(std::memory_order_relaxed),
+            .armed_count = channel_page.armed_count.load(std::memory_order_relaxed),
+            .clock = channel_page.clock,
+            .numa_node = channel_page.numa_node.load(std::memory_order_relaxed),
+            .resident_node = residentNodeOf(channel_page),
+            .fill_latency = {},
+            .delivery_latency = {},
+            .endpoints = {},
+        };
+        snapshotTrace(channel_page, snapshot);
+        snapshotEndpoints(channel_page, snapshot.endpoints);
+
+        return snapshot;
+    }
+
+    std::uint64_t occupied_slots{0U};
+    // NOLINTNEXTLINE(altera-unroll-loops) Not worth it
+    for (std::size_t word{0U}; word < channel_page.occupancy_word_count(); ++word)
+        occupied_slots += std::popcount(channel_page.occupancy(word).load(std::memory_order_relaxed));
+    // Padding bits are permanently set.
+    occupied_slots -= (channel_page.occupancy_word_count() * impl::ChannelPage::kOccupancyWordBits) -
+                      channel_page.slot_count;
+
+    // RPC channels count the calls in flight, and hand out sequence ids as correlation ids.
+    const auto latest_sequence_id =
+        channel_page.kind == ChannelKind::Rpc
+            ? channel_page.next_seq_id.load(std::memory_order_relaxed) - 1U
+            : channel_page[impl::latestIndexOf(channel_page.latest.load(std::memory_order_acquire))].sequence_id;
+
+    ChannelSnapshot snapshot{
+        .name = std::string{name},
+        .kind = channel_page.kind,
+        .max_payload_size = channel_page.max_payload_size,
+        .slot_count = channel_page.slot_count,
+        .occupied_slots = occupied_slots,
+        .latest_sequence_id = latest_sequence_id,
+        .waiter_count = channel_page.waiter_count.load(std::memory_order_relaxed),
+        .armed_count = channel_page.armed_count.load(std::memory_order_relaxed),
+        .clock = channel_page.clock,
+        .numa_node = channel_page.numa_node.load(std::memory_order_relaxed),
+        .resident_node = residentNodeOf(channel_page),
+        .fill_latency = {},
+        .delivery_latency = {},
+        .endpoints = {},
+    };
+    snapshotTrace(channel_page, snapshot);
+    snapshotEndpoints(channel_page, snapshot.endpoints);
+
+    return snapshot;
+}
+
+std::vector<std::byte> writeChannelSnapshots(std::span<const ChannelSnapshot> snapshots, std::size_t max_size) {
+    std::vector<std::byte> buf;
+    append(buf, std::uint32_t{0U});
+
+    std::uint32_t channel_count{0U};
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the reply size
+    for (const auto& snapshot : snapshots) {
+        const auto name_size = std::min<std::size_t>(snapshot.name.size(), UINT8_MAX);
+        const auto size = sizeof(std::uint8_t) + name_size + sizeof(ChannelKind) + (4U * sizeof(std::uint64_t)) +
+                          (3U * sizeof(std::uint32_t)) + sizeof(ChannelClock) + (2U * sizeof(std::int32_t)) +
+                          (2U * sizeof(LatencySummary)) +
+                          (snapshot.endpoints.size() * sizeof(EndpointSnapshot));
+        if (buf.size() + size > max_size)
+            break;
+
+        append(buf, static_cast<std::uint8_t>(name_size));
+        const auto* const name = reinterpret_cast<const std::byte*>(snapshot.name.data());
+        buf.insert(buf.end(), name, name + name_size);
+        append(buf, snapshot.kind);
+        append(buf, snapshot.max_payload_size);
+        append(buf, snapshot.slot_count);
+        append(buf, snapshot.occupied_slots);
+        append(buf, snapshot.latest_sequence_id);
+        append(buf, snapshot.waiter_count);
+        append(buf, snapshot.armed_count);
+        append(buf, snapshot.clock);
+        append(buf, snapshot.numa_node);
+        append(buf, snapshot.resident_node);
+        append(buf, snapshot.fill_latency);
+        append(buf, snapshot.delivery_latency);
+        append(buf, static_cast<std::uint32_t>(snapshot.endpoints.size()));
+        for (const auto& endpoint : snapshot.endpoints)
+            append(buf, endpoint);
+        ++channel_count;
+    }
+
+    std::memcpy(buf.data(), &channel_count, sizeof(channel_count));
+    // Trailing, for clients predating paging to ignore.
+    append(buf, static_cast<std::uint32_t>(snapshots.size() - channel_count));
+    return buf;
+}
+
+io::expected<SnapshotPage> readChannelSnapshots(std::span<const std::byte> buf) {
+    if (buf.size() < sizeof(std::uint32_t))
+        return malformed();
+    const auto channel_count = io::getBuf<std::uint32_t>(buf);
+
+    SnapshotPage page{.channels = {}, .remaining_count = 0U};
+    auto& snapshots = page.channels;
+    snapshots.reserve(channel_count);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the reply size
+    for (std::uint32_t i{0U}; i < channel_count; ++i) {
+        if (buf.size() < sizeof(std::uint8_t))
+            return malformed();
+        const auto name_size = io::getBuf<std::uint8_t>(buf);
+
+        constexpr std::size_t kFieldsSize = sizeof(ChannelKind) + (4U * sizeof(std::uint64_t)) +
+                                            (3U * sizeof(std::uint32_t)) + sizeof(ChannelClock) +
+                                            (2U * sizeof(std::int32_t)) + (2U * sizeof(LatencySummary));
+        if (buf.size() < name_size + kFieldsSize)
+            return malformed();
+        const auto name = io::takeBuf(buf, name_size);
+
+        auto& snapshot = snapshots.emplace_back();
+        snapshot.name = std::string{reinterpret_cast<const char*>(name.data()), name.size()};
+        snapshot.kind = io::getBuf<ChannelKind>(buf);
+        snapshot.max_payload_size = io::getBuf<std::uint64_t>(buf);
+        snapshot.slot_count = io::getBuf<std::uint64_t>(buf);
+        snapshot.occupied_slots = io::getBuf<std::uint64_t>(buf);
+        snapshot.latest_sequence_id = io::getBuf<std::uint64_t>(buf);
+        snapshot.waiter_count = io::getBuf<std::uint32_t>(buf);
+        snapshot.armed_count = io::getBuf<std::uint32_t>(buf);
+        snapshot.clock = io::getBuf<ChannelClock>(buf);
+        snapshot.numa_node = io::getBuf<std::int32_t>(buf);
+        snapshot.resident_node = io::getBuf<std::int32_t>(buf);
+        snapshot.fill_latency = io::getBuf<LatencySummary>(buf);
+        snapshot.delivery_latency = io::getBuf<LatencySummary>(buf);
+        const auto endpoint_count = io::getBuf<std::uint32_t>(buf);
+
+        if (buf.size() < endpoint_count * sizeof(EndpointSnapshot))
+            return malformed();
+        snapshot.endpoints.reserve(endpoint_count);
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the reply size
+        for (std::uint32_t j{0U}; j < endpoint_count; ++j)
+            snapshot.endpoints.push_back(io::getBuf<EndpointSnapshot>(buf));
+    }
+
+    // Towers predating paging fit every channel they can into a single reply, counting none left out.
+    if (buf.size() >= sizeof(std::uint32_t))
+        page.remaining_count = io::getBuf<std::uint32_t>(buf);
+    return page;
+}
+
+io::expected<std::vector<ChannelSnapshot>> inspectTower(std::string_view path) {
+    auto sockfd = io::adoptSysFd(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+    if (!sockfd.has_value())
+        return io::unexpected{sockfd.error()};
+
+    ::sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return io::unexpected{std::make_error_code(std::errc::filename_too_long)};
+    std::memcpy(addr.sun_path, path.data(), path.size());
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (auto res = io::sysCheck(::connect(sockfd->fd(), reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)));
+        !res.has_value())
+        return io::unexpected{res.error()};
+
+    std::vector<ChannelSnapshot> snapshots;
+    std::vector<std::byte> reply(kMaxInspectReplySize);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the number of channels
+    for (;;) {
+        // Every page starts after the last channel of the previous one, channels being sorted by name.
+        const auto after = snapshots.empty() ? std::string_view{} : std::string_view{snapshots.back().name};
+        std::array<std::byte, sizeof(std::uint32_t) + sizeof(std::uint16_t) + sizeof(MessageKind) +
+                                  sizeof(std::uint16_t) + sizeof(std::uint8_t) + UINT8_MAX>
+            request{};
+        std::span<std::byte> sndbuf{request};
+        io::putBuf(sndbuf, kProtocolMagic);
+        io::putBuf(sndbuf, kProtocolVersion);
+        io::putBuf(sndbuf, MessageKind::Inspect);
+        io::putBuf(sndbuf, std::uint16_t{0U});
+        io::putBuf(sndbuf, static_cast<std::uint8_t>(after.size()));
+        io::putBuf(sndbuf, std::as_bytes(std::span{after}));
+
+        if (auto res = io::sysCheck(
+                ::send(sockfd->fd(), request.data(), request.size() - sndbuf.size(), MSG_NOSIGNAL));
+            !res.has_value())
+            return io::unexpected{res.error()};
+
+        const auto bytes_read = ::recv(sockfd->fd(), reply.data(), reply.size(), 0);
+        if (bytes_read < 0)
+            return io::unexpected{io::errnoCode()};
+
+        auto page = readChannelSnapshots(std::span<const std::byte>{reply}.first(static_cast<std::size_t>(bytes_read)));
+        if (!page.has_value())
+            return io::unexpected{page.error()};
+        // A page without channels could not make any progress.
+        if (page->remaining_count != 0U && page->channels.empty())
+            return malformed();
+
+        std::ranges::move(page->channels, std::back_inserter(snapshots));
+        if (page->remaining_count == 0U)
+            return snapshots;
+    }
+}
+
+} // namespace fastipc
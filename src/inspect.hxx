@@ -0,0 +1,118 @@
+/*
+ *  inspect.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io/result.hxx"
+#include "channel.hxx"
+#include "local_proto.hxx"
+
+namespace fastipc {
+
+/// Counters of an endpoint, as found in its stats record
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct EndpointSnapshot {
+    std::uint32_t record;
+    std::int32_t pid;
+    // Whether the owning process still exists
+    bool alive;
+    RequesterType role;
+
+    std::uint64_t prepares;
+    std::uint64_t submits;
+    std::uint64_t prepare_retries;
+    std::uint64_t prepare_yields;
+    std::uint64_t racy_hints;
+
+    std::uint64_t acquires;
+    std::uint64_t releases;
+    std::uint64_t acquire_retries;
+    std::uint64_t copy_retries;
+    std::uint64_t skipped_sequence_ids;
+
+    /// Number of slots the endpoint currently holds on to
+    [[nodiscard]] std::uint64_t heldSlots() const noexcept {
+        return role == RequesterType::Writer ? prepares - submits : acquires - releases;
+    }
+};
+
+/// Distribution of latencies found in a channel's trace ring, in nanoseconds
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct LatencySummary {
+    // Number of traced samples, zero if the channel is not traced
+    std::uint64_t count;
+    std::uint64_t median;
+    std::uint64_t p99;
+    std::uint64_t max;
+};
+
+/// State of a channel along with the counters of its endpoints
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ChannelSnapshot {
+    std::string name;
+    ChannelKind kind;
+    std::uint64_t max_payload_size;
+    std::uint64_t slot_count;
+    // Queues count the samples queued, not yet released, and RPC channels the calls in flight
+    std::uint64_t occupied_slots;
+    std::uint64_t latest_sequence_id;
+    std::uint32_t waiter_count;
+    std::uint32_t armed_count;
+    ChannelClock clock;
+    // Node the channel memory is bound to, kNoNumaNode if none
+    std::int32_t numa_node;
+    // Node holding most of the channel pages the tower maps, -1 if unknown
+    std::int32_t resident_node;
+    // From prepare to submit, for the newest samples traced
+    LatencySummary fill_latency;
+    // From submit to the first acquisition by any reader, for the newest samples traced
+    LatencySummary delivery_latency;
+    std::vector<EndpointSnapshot> endpoints;
+};
+
+/// Snapshots a channel's state and the counters of its tracked endpoints
+///
+/// @note Counters are read while being updated, hence only consistent with themselves.
+[[nodiscard]] ChannelSnapshot snapshotChannel(std::string_view name, impl::ChannelPage& channel_page);
+
+/// Snapshots making up a reply to an inspection, a page of every channel
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct SnapshotPage {
+    std::vector<ChannelSnapshot> channels;
+    // Channels left out for the size of the reply, to be asked for starting after the last one in this page
+    std::uint32_t remaining_count;
+};
+
+/// Serializes snapshots, leaving out the channels which would exceed the given size and counting them
+[[nodiscard]] std::vector<std::byte> writeChannelSnapshots(std::span<const ChannelSnapshot> snapshots,
+                                                           std::size_t max_size);
+
+/// Deserializes snapshots
+[[nodiscard]] io::expected<SnapshotPage> readChannelSnapshots(std::span<const std::byte> buf);
+
+/// Asks the tower listening at the given path for a snapshot of every channel, page after page
+[[nodiscard]] io::expected<std::vector<ChannelSnapshot>> inspectTower(std::string_view path);
+
+} // namespace fastipc
@@ -16,10 +16,15 @@
  *
  */
 
+#include <cerrno>
+#include <charconv>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <unordered_map>
 #include <vector>
+#include <arpa/inet.h>
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -61,4 +66,50 @@ expected<std::unordered_map<std::string, std::vector<SocketAddr>>> getInterfaceA
         });
 }
 
+expected<SocketAddr> parseSocketAddr(std::string_view text) noexcept {
+    const auto invalid = unexpected{std::make_error_code(std::errc::invalid_argument)};
+
+    const auto colon = text.rfind(':');
+    if (colon == std::string_view::npos)
+        return invalid;
+
+    std::uint16_t port{0U};
+    const auto port_text = text.substr(colon + 1U);
+    if (const auto [end, ec] = std::from_chars(port_text.data(), port_text.data() + port_text.size(), port);
+        ec != std::errc{} || end != port_text.data() + port_text.size())
+        return invalid;
+
+    auto host = text.substr(0U, colon);
+    const bool is_v6 = host.starts_with('[') && host.ends_with(']');
+    if (is_v6)
+        host = host.substr(1U, host.size() - 2U);
+    const std::string host_text{host};
+
+    if (is_v6) {
+        ::in6_addr addr{};
+        if (::inet_pton(AF_INET6, host_text.c_str(), &addr) != 1)
+            return invalid;
+        return SocketAddrV6{.addr = Ipv6Addr::from(addr), .port = port, .flowinfo = 0U, .scope_id = 0U};
+    }
+
+    ::in_addr addr{};
+    if (::inet_pton(AF_INET, host_text.c_str(), &addr) != 1)
+        return invalid;
+    return SocketAddrV4{.addr = Ipv4Addr::from(addr), .port = port};
+}
+
+expected<SocketAddr> getLocalAddress(int sockfd) noexcept {
+    ::sockaddr_storage storage{};
+    ::socklen_t size{sizeof(storage)};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (::getsockname(sockfd, reinterpret_cast<::sockaddr*>(&storage), &size) != 0)
+        return unexpected{errnoCode()};
+
+    if (storage.ss_family == AF_INET)
+        return SocketAddrV4::from(*reinterpret_cast<const ::sockaddr_in*>(&storage));
+    if (storage.ss_family == AF_INET6)
+        return SocketAddrV6::from(*reinterpret_cast<const ::sockaddr_in6*>(&storage));
+    return unexpected{std::make_error_code(std::errc::address_family_not_supported)};
+}
+
 } // namespace fastipc::io
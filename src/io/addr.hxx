@@ -26,6 +26,8 @@
 #include <format>
 #include <print>
 #include <span>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -52,7 +54,15 @@ struct SocketAddrV4 final {
     std::uint16_t port;
 
     constexpr static SocketAddrV4 from(const ::sockaddr_in& sockaddr) noexcept {
-        return {.addr = Ipv4Addr::from(sockaddr.sin_addr), .port = sockaddr.sin_port};
+        return {.addr = Ipv4Addr::from(sockaddr.sin_addr), .port = fromBe(sockaddr.sin_port)};
+    }
+
+    [[nodiscard]] ::sockaddr_in to() const noexcept {
+        ::sockaddr_in sockaddr{};
+        sockaddr.sin_family = AF_INET;
+        sockaddr.sin_port = toBe(port);
+        std::memcpy(&sockaddr.sin_addr, addr.value.data(), addr.value.size());
+        return sockaddr;
     }
 };
 
@@ -84,10 +94,20 @@ struct SocketAddrV6 final {
 
     constexpr static SocketAddrV6 from(const ::sockaddr_in6& sockaddr) noexcept {
         return {.addr = Ipv6Addr::from(sockaddr.sin6_addr),
-                .port = sockaddr.sin6_port,
+                .port = fromBe(sockaddr.sin6_port),
                 .flowinfo = sockaddr.sin6_flowinfo,
                 .scope_id = sockaddr.sin6_scope_id};
     }
+
+    [[nodiscard]] ::sockaddr_in6 to() const noexcept {
+        ::sockaddr_in6 sockaddr{};
+        sockaddr.sin6_family = AF_INET6;
+        sockaddr.sin6_port = toBe(port);
+        sockaddr.sin6_flowinfo = flowinfo;
+        sockaddr.sin6_scope_id = scope_id;
+        std::memcpy(&sockaddr.sin6_addr, addr.value.data(), addr.value.size());
+        return sockaddr;
+    }
 };
 
 using IpAddr = std::variant<Ipv4Addr, Ipv6Addr>;
@@ -95,6 +115,12 @@ using SocketAddr = std::variant<SocketAddrV4, SocketAddrV6>;
 
 expected<std::unordered_map<std::string, std::vector<SocketAddr>>> getInterfaceAddresses() noexcept;
 
+/// Parses a socket address written as `a.b.c.d:port` or `[v6]:port`
+expected<SocketAddr> parseSocketAddr(std::string_view text) noexcept;
+
+/// Address a socket is bound to
+expected<SocketAddr> getLocalAddress(int sockfd) noexcept;
+
 } // namespace fastipc::io
 
 template <>
@@ -201,7 +227,7 @@ class std::formatter<fastipc::io::SocketAddrV6> {
 
     auto format(const fastipc::io::SocketAddrV6& self, auto& ctx) const {
         if (self.scope_id == 0) {
-            return std::format_to(ctx.out(), "[{}]:{}", self.addr, self.scope_id, self.port);
+            return std::format_to(ctx.out(), "[{}]:{}", self.addr, self.port);
         } else {
             return std::format_to(ctx.out(), "[{}%{}]:{}", self.addr, self.scope_id, self.port);
         }
@@ -0,0 +1,56 @@
+/*
+ *  futex.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "result.hxx"
+
+namespace fastipc::io {
+
+static_assert(sizeof(std::atomic_uint32_t) == sizeof(std::uint32_t) && std::atomic_uint32_t::is_always_lock_free);
+
+/// Blocks while @a word holds @a expected, for at most @a timeout
+///
+/// @note Uses shared futexes, so @a word may live in memory mapped by several processes.
+[[nodiscard]] inline io::expected<void> futexWait(const std::atomic_uint32_t& word, std::uint32_t expected,
+                                                  std::chrono::nanoseconds timeout) noexcept {
+    const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    const ::timespec ts{.tv_sec = static_cast<::time_t>(secs.count()),
+                        .tv_nsec = static_cast<long>((timeout - secs).count())};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    return sysCheck(::syscall(SYS_futex, &word, FUTEX_WAIT, expected, &ts, nullptr, 0));
+}
+
+/// Wakes up to @a count threads blocked on @a word
+inline void futexWake(std::atomic_uint32_t& word, int count = INT_MAX) noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    static_cast<void>(::syscall(SYS_futex, &word, FUTEX_WAKE, count, nullptr, nullptr, 0));
+}
+
+} // namespace fastipc::io
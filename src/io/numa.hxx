@@ -0,0 +1,102 @@
+/*
+ *  numa.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "result.hxx"
+
+namespace fastipc::io {
+
+/// Nodes beyond this many cannot be bound to
+constexpr std::int32_t kMaxNumaNodes{1024};
+
+/// NUMA node of the CPU the calling thread runs on, which may change as soon as it gets migrated
+[[nodiscard]] inline std::int32_t currentNumaNode() noexcept {
+    unsigned cpu{0U};
+    unsigned node{0U};
+    if (::getcpu(&cpu, &node) != 0)
+        return 0;
+    return static_cast<std::int32_t>(node);
+}
+
+/// Has the pages of a mapping preferably allocated on @a node, falling back to others when it runs out of memory
+///
+/// @note Applies to the file backing shared mappings, hence to pages faulted in through any mapping of it; pages
+///       already in memory are only migrated if mapped by the calling process alone.
+[[nodiscard]] inline io::expected<void> preferNumaNode(void* addr, std::size_t size, std::int32_t node) noexcept {
+    if (node < 0 || node >= kMaxNumaNodes)
+        return io::unexpected{std::make_error_code(std::errc::invalid_argument)};
+
+    constexpr std::size_t kMaskBits{sizeof(unsigned long) * CHAR_BIT};
+    std::array<unsigned long, kMaxNumaNodes / kMaskBits> nodemask{};
+    const auto bit = static_cast<std::size_t>(node);
+    nodemask[bit / kMaskBits] = 1UL << (bit % kMaskBits);
+
+    // The kernel drops the last bit of the mask it is told about.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    return sysCheck(::syscall(SYS_mbind, addr, size, MPOL_PREFERRED, nodemask.data(), kMaxNumaNodes + 1, MPOL_MF_MOVE));
+}
+
+/// Pages of a mapping looked at to tell where it resides
+constexpr std::size_t kSampledPages{256U};
+
+/// NUMA node holding most of the pages of a mapping which the calling process has faulted in, -1 if none
+///
+/// Only looks at up to kSampledPages pages, evenly spread over the mapping.
+[[nodiscard]] inline std::int32_t residentNumaNode(const void* addr, std::size_t size) {
+    const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto page_count = (size + page_size - 1U) / page_size;
+    const auto stride = std::max<std::size_t>((page_count + kSampledPages - 1U) / kSampledPages, 1U);
+
+    std::array<const void*, kSampledPages> pages{};
+    std::array<int, kSampledPages> status{};
+    std::size_t count{0U};
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kSampledPages
+    for (std::size_t page{0U}; page < page_count && count < kSampledPages; page += stride)
+        pages[count++] = static_cast<const std::byte*>(addr) + (page * page_size);
+
+    // Without target nodes, the kernel only reports where the pages are.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    if (::syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0)
+        return -1;
+
+    std::map<int, std::size_t> page_counts;
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kSampledPages
+    for (const auto node : std::span{status}.first(count)) {
+        if (node >= 0)
+            ++page_counts[node];
+    }
+    if (page_counts.empty())
+        return -1;
+    return std::ranges::max_element(page_counts, {}, [](const auto& entry) { return entry.second; })->first;
+}
+
+} // namespace fastipc::io
@@ -23,6 +23,8 @@
 #include <iostream>
 #include <system_error>
 
+#include <sys/mman.h>
+
 namespace fastipc {
 namespace io {
 
@@ -43,7 +45,8 @@ template <std::integral T>
 }
 
 [[nodiscard]] inline io::expected<void*> sysVal(void* val) noexcept {
-    if (val == nullptr) {
+    // mmap reports failures as MAP_FAILED rather than null
+    if (val == nullptr || val == MAP_FAILED) { // NOLINT(*-cstyle-cast,performance-no-int-to-ptr)
         return io::unexpected{errnoCode()};
     }
 
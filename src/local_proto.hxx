@@ -22,18 +22,107 @@
 #include <cstdint>
 #include <string_view>
 
+#include "fastipc.hxx"
+
 namespace fastipc {
 
+/// Path of the socket clients connect to unless told otherwise, whose registry directly attached endpoints use
+constexpr std::string_view kDefaultTowerPath{"fastipcd"};
+
+/// Leads every versioned client message
+///
+/// Unversioned messages hold a single request and lead with its layout version
+/// instead, which this value is guaranteed never to collide with.
+constexpr std::uint32_t kProtocolMagic{0x46495043U}; // "FIPC" NOLINT(*-magic-numbers)
+
+/// Version of the versioned client message format
+///
+/// 1: initial version
+/// 2: requests carry the channel page backing
+/// 3: the version is followed by the message kind
+/// 4: requests carry the channel kind
+/// 5: requests carry the history depth
+/// 6: replies carry the stats record claimed for the endpoint
+/// 7: requests carry the channel clock and trace depth
+/// 8: requests may ask for RPC channels
+/// 9: requests carry the NUMA node of writers
+/// 10: requests carry the number of writer lanes
+/// 11: messages may ask for notification descriptors only
+/// 12: requests carry the number of endpoint records
+/// 13: inspections carry the channel to page on from, and replies count the channels left out
+constexpr std::uint16_t kProtocolVersion{13U};
+
+/// Maximum number of requests in a single client message
+///
+/// Bounded by the number of descriptors passed along in the reply,
+/// which the kernel limits to 253 per message.
+constexpr std::size_t kMaxBatchSize{64U};
+
+/// Number of descriptors passed along for every opened channel
+constexpr std::size_t kFdsPerChannel{2U};
+
+/// Maximum size of a client message
+constexpr std::size_t kMaxClientMessageSize{
+    sizeof(std::uint32_t) + sizeof(std::uint16_t) + sizeof(std::uint8_t) + sizeof(std::uint16_t) +
+    (kMaxBatchSize * (sizeof(std::uint32_t) + sizeof(std::uint8_t) + sizeof(std::size_t) + sizeof(std::uint32_t) +
+                      sizeof(std::uint8_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t) + sizeof(std::uint8_t) +
+                      sizeof(std::uint32_t) + sizeof(std::int32_t) + sizeof(std::uint32_t) + sizeof(std::uint32_t) +
+                      sizeof(std::uint8_t) + UINT8_MAX))};
+
+/// Maximum size of the tower's reply to an inspection
+constexpr std::size_t kMaxInspectReplySize{std::size_t{128U} << 10U}; // NOLINT(*-magic-numbers)
+
+enum class MessageKind : std::uint8_t {
+    /// Opens the requested channels, creating them if needed
+    Open = 0,
+    /// Snapshots the channels sorting after a given name, carrying no requests
+    Inspect = 1,
+    /// Hands out the notification descriptors of the requested channels only, for directly attached endpoints to
+    /// share with the others; claims no record
+    Notify = 2,
+};
+
 enum class RequesterType : std::uint8_t {
     Reader = 0,
     Writer = 1,
 };
 
+enum class ChannelKind : std::uint8_t {
+    /// Latest value wins, as read by Reader and written by Writer
+    Mailbox = 0,
+    /// Lossless FIFO, as read by QueueReader and written by QueueWriter
+    Queue = 1,
+    /// Request/reply, as called by RpcClient (writing) and served by RpcServer (reading)
+    Rpc = 2,
+};
+
 // NOLINTNEXTLINE(altera-struct-pack-align)
 struct ClientRequest {
+    std::uint32_t layout_version;
     RequesterType type;
     std::size_t max_payload_size;
+    std::uint32_t slot_count;
+    PageBacking page_backing;
+    ChannelKind kind;
+    std::uint32_t history_depth;
+    ChannelClock clock;
+    std::uint32_t trace_depth;
+    // Node the writer wants the channel memory on, kNoNumaNode for readers and writers without preference
+    std::int32_t numa_node;
+    std::uint32_t writer_lanes;
+    std::uint32_t endpoint_records;
     std::string_view topic_name;
 };
 
+/// Status of a reply, surfaced as is by sessions which open channels without aborting on rejection
+using ReplyStatus = OpenStatus;
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct TowerReply {
+    ReplyStatus status;
+    // Stats record claimed on behalf of the client's process, or ChannelPage::kNoRecord
+    std::uint32_t record;
+    std::size_t total_size;
+};
+
 } // namespace fastipc
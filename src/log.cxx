@@ -0,0 +1,90 @@
+/*
+ *  log.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Drains and formats the log rings of fastipc processes, the tower included.
+//
+// Usage: fastipc-log [--follow] [--interval-ms <ms>]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log_reader.hxx"
+
+namespace {
+
+void print(const std::vector<fastipc::LogEntry>& entries, const std::vector<fastipc::LogDrops>& drops) {
+    constexpr std::array kLevelNames{"debug", "info", "warning", "error"};
+
+    for (const auto& entry : entries) {
+        const auto since_epoch = std::chrono::duration_cast<std::chrono::microseconds>(entry.time.time_since_epoch());
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        const auto level = static_cast<std::size_t>(entry.level);
+        std::println("{}.{:06} {} {}[{}:{}] {}", seconds.count(), (since_epoch - seconds).count(),
+                     level < kLevelNames.size() ? kLevelNames.at(level) : "unknown", entry.source, entry.pid,
+                     entry.tid, entry.message);
+    }
+    for (const auto& drop : drops)
+        std::println("dropped {} record(s) of [{}:{}] for lack of room", drop.count, drop.pid, drop.tid);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<std::string_view> args(argv + 1, argv + argc); // NOLINT(*-pointer-arithmetic)
+
+    bool follow{false};
+    std::chrono::milliseconds interval{100}; // NOLINT(*-magic-numbers)
+    for (std::size_t i{0U}; i < args.size(); ++i) {
+        if (args[i] == "--follow") {
+            follow = true;
+        } else if (args[i] == "--interval-ms" && i + 1U < args.size()) {
+            interval = std::chrono::milliseconds{std::strtol(std::string{args[++i]}.c_str(), nullptr, 10)};
+        } else {
+            std::println(stderr, "usage: fastipc-log [--follow] [--interval-ms <ms>]");
+            return EXIT_FAILURE;
+        }
+    }
+
+    fastipc::LogCollector collector;
+    std::vector<fastipc::LogEntry> entries;
+    std::vector<fastipc::LogDrops> drops;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        collector.collect(entries, drops);
+        // Rings are only ordered within themselves.
+        std::ranges::stable_sort(entries, {}, &fastipc::LogEntry::time);
+        print(entries, drops);
+        std::fflush(stdout);
+        if (!follow)
+            return EXIT_SUCCESS;
+
+        entries.clear();
+        drops.clear();
+        std::this_thread::sleep_for(interval);
+    }
+}
@@ -0,0 +1,330 @@
+/*
+ *  log_reader.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "log_reader.hxx"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io/cursor.hxx"
+#include "io/fd.hxx"
+#include "io/result.hxx"
+#include "channel.hxx"
+#include "log_ring.hxx"
+
+namespace fastipc {
+namespace {
+
+template <typename T>
+[[nodiscard]] std::string formatValue(std::string_view field, const T& value) {
+    return std::vformat(field, std::make_format_args(value));
+}
+
+/// Formats the next encoded argument along a replacement field, consuming it
+///
+/// @param field Replacement field, stripped of its argument id
+/// @return Whether the argument could be formatted
+[[nodiscard]] bool formatNextArg(std::string_view field, std::span<const std::byte>& args, std::string& message) {
+    if (args.size() < sizeof(impl::LogArgType))
+        return false;
+
+    auto remaining = args;
+    const auto type = io::getBuf<impl::LogArgType>(remaining);
+    const auto fits = [&](std::size_t size) { return remaining.size() >= size; };
+    try {
+        switch (type) {
+        case impl::LogArgType::Bool:
+            if (!fits(sizeof(bool)))
+                return false;
+            message += formatValue(field, io::getBuf<bool>(remaining));
+            break;
+        case impl::LogArgType::Char:
+            if (!fits(sizeof(char)))
+                return false;
+            message += formatValue(field, io::getBuf<char>(remaining));
+            break;
+        case impl::LogArgType::Signed:
+            if (!fits(sizeof(std::int64_t)))
+                return false;
+            message += formatValue(field, io::getBuf<std::int64_t>(remaining));
+            break;
+        case impl::LogArgType::Unsigned:
+            if (!fits(sizeof(std::uint64_t)))
+                return false;
+            message += formatValue(field, io::getBuf<std::uint64_t>(remaining));
+            break;
+        case impl::LogArgType::Floating:
+            if (!fits(sizeof(double)))
+                return false;
+            message += formatValue(field, io::getBuf<double>(remaining));
+            break;
+        case impl::LogArgType::String: {
+            if (!fits(sizeof(std::uint32_t)))
+                return false;
+            const auto size = io::getBuf<std::uint32_t>(remaining);
+            if (!fits(size))
+                return false;
+            const auto text = io::takeBuf(remaining, size);
+            message += formatValue(field, std::string_view{reinterpret_cast<const char*>(text.data()), text.size()});
+            break;
+        }
+        case impl::LogArgType::Pointer:
+            if (!fits(sizeof(std::uint64_t)))
+                return false;
+            // The pointer is only printed, never followed.
+            message += formatValue(field, reinterpret_cast<const void*>(io::getBuf<std::uint64_t>(remaining)));
+            break;
+        default:
+            // Nothing past an unknown argument can be made sense of.
+            args = {};
+            return false;
+        }
+    } catch (const std::format_error&) {
+        args = remaining;
+        return false;
+    }
+
+    args = remaining;
+    return true;
+}
+
+// Stderr reopened as a description of its own, non-blocking, or -1 if it is a socket to send to as is
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+std::atomic_int g_stderr_fd{-1};
+
+/// Writes a record which no collector would get to see to stderr, dropping what would block
+void writeToStderr(LogLevel level, std::string_view source, std::string_view format,
+                   std::span<const std::byte> args) noexcept {
+    constexpr std::array kLevelNames{"debug", "info", "warning", "error"};
+    const auto index = static_cast<std::size_t>(level);
+    const auto line = std::format("{} {}[{}:{}] {}\n", index < kLevelNames.size() ? kLevelNames.at(index) : "unknown",
+                                  source, ::getpid(), ::gettid(), formatLogMessage(format, args));
+
+    if (const auto fd = g_stderr_fd.load(std::memory_order_relaxed); fd >= 0)
+        static_cast<void>(::write(fd, line.data(), line.size()));
+    else
+        static_cast<void>(::send(STDERR_FILENO, line.data(), line.size(), MSG_DONTWAIT | MSG_NOSIGNAL));
+}
+
+/// Whether the thread owning a ring is gone
+[[nodiscard]] bool isWriterGone(const impl::LogRing& ring) {
+    return ring.closed.load(std::memory_order_acquire) || (::kill(ring.pid, 0) != 0 && errno == ESRCH);
+}
+
+} // namespace
+
+void fallBackToStderr() noexcept {
+    struct ::stat status {};
+    if (::fstat(STDERR_FILENO, &status) != 0)
+        return;
+
+    // Pipes and terminals get a description of their own, so as not to make the one shared with others non-blocking.
+    if (!S_ISSOCK(status.st_mode) && g_stderr_fd.load(std::memory_order_relaxed) < 0) {
+        const auto fd = ::open("/proc/self/fd/2", O_WRONLY | O_APPEND | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        g_stderr_fd.store(fd, std::memory_order_relaxed);
+    }
+    impl::setLogFallback(writeToStderr);
+}
+
+std::string formatLogMessage(std::string_view format, std::span<const std::byte> args) {
+    std::string message;
+    message.reserve(format.size());
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the format string
+    for (std::size_t i{0U}; i < format.size();) {
+        const auto next = i + 1U < format.size() ? format[i + 1U] : '\0';
+        if ((format[i] == '{' && next == '{') || (format[i] == '}' && next == '}')) {
+            message += format[i];
+            i += 2U;
+            continue;
+        }
+        if (format[i] != '{') {
+            message += format[i++];
+            continue;
+        }
+
+        const auto close = format.find('}', i);
+        if (close == std::string_view::npos) {
+            message += format.substr(i);
+            break;
+        }
+
+        // Arguments are numbered automatically, in order.
+        const auto field = format.substr(i, close - i + 1U);
+        const auto spec = field.find(':');
+        const auto stripped =
+            spec == std::string_view::npos ? std::string{"{}"} : "{" + std::string{field.substr(spec)};
+        if (!formatNextArg(stripped, args, message))
+            message += field;
+        i = close + 1U;
+    }
+
+    return message;
+}
+
+LogCollector::LogCollector(std::string directory)
+    : m_directory{std::move(directory)},
+      m_directoryfd{expect(io::adoptSysFd(::open(m_directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)),
+                           "failed to open log ring directory")},
+      m_markerfd{expect(io::adoptSysFd(::openat(m_directoryfd.fd(), std::string{impl::kLogCollectorMarker}.c_str(),
+                                                O_RDONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)),
+                        "failed to open log collector marker")} {
+    // Writers probing for collectors only hold the lock exclusively for an instant.
+    expect(io::sysCheck(::flock(m_markerfd.fd(), LOCK_SH)), "failed to lock log collector marker");
+}
+
+LogCollector::~LogCollector() noexcept {
+    for (const auto& [name, mapped] : m_rings)
+        static_cast<void>(::munmap(mapped.ring, impl::LogRing::total_size(mapped.ring->capacity)));
+}
+
+void LogCollector::discover() {
+    auto dirfd = io::adoptSysFd(::dup(m_directoryfd.fd()));
+    if (!dirfd.has_value())
+        return;
+    auto* const dir = ::fdopendir(dirfd->fd());
+    if (dir == nullptr)
+        return;
+    // The directory stream owns the duplicate from now on.
+    static_cast<void>(std::move(*dirfd));
+    ::rewinddir(dir);
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the directory
+    for (const auto* entry = ::readdir(dir); entry != nullptr; entry = ::readdir(dir)) {
+        const std::string_view name{entry->d_name};
+        if (!name.starts_with(impl::kLogRingPrefix) || m_rings.contains(std::string{name}))
+            continue;
+
+        auto fd = io::adoptSysFd(::openat(m_directoryfd.fd(), entry->d_name, O_RDWR | O_CLOEXEC));
+        struct ::stat status{};
+        // Another collector may be draining the ring already.
+        if (!fd.has_value() || ::flock(fd->fd(), LOCK_EX | LOCK_NB) != 0 || ::fstat(fd->fd(), &status) != 0 ||
+            static_cast<std::size_t>(status.st_size) < sizeof(impl::LogRing))
+            continue;
+
+        const auto size = static_cast<std::size_t>(status.st_size);
+        auto* const ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd->fd(), 0);
+        if (ptr == MAP_FAILED) // NOLINT(*-cstyle-cast,performance-no-int-to-ptr)
+            continue;
+
+        auto* const ring = static_cast<impl::LogRing*>(ptr);
+        if (ring->layout_version != impl::kLogLayoutVersion || ring->capacity == 0U ||
+            impl::LogRing::total_size(ring->capacity) != size) {
+            static_cast<void>(::munmap(ptr, size));
+            continue;
+        }
+
+        m_rings.emplace(std::string{name}, MappedRing{.fd = std::move(*fd), .ring = ring, .reported_drops = 0U});
+    }
+
+    ::closedir(dir);
+}
+
+void LogCollector::collect(std::vector<LogEntry>& entries, std::vector<LogDrops>& drops) {
+    discover();
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the number of rings
+    for (auto it = m_rings.begin(); it != m_rings.end();) {
+        auto& [name, mapped] = *it;
+        auto& ring = *mapped.ring;
+        // Sample whether the writer is gone first, so that whatever it wrote before going gets drained below.
+        const bool gone = isWriterGone(ring);
+
+        const auto head = ring.head.load(std::memory_order_acquire);
+        auto tail = ring.tail.load(std::memory_order_relaxed);
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the ring capacity
+        while (tail < head) {
+            const auto* const record = ring.at(tail);
+            std::uint32_t size{0U};
+            auto level = LogLevel::Debug;
+            std::memcpy(&size, record + offsetof(impl::LogRecordHeader, size), sizeof(size));
+            std::memcpy(&level, record + offsetof(impl::LogRecordHeader, level), sizeof(level));
+
+            const auto aligned_size = impl::alignUp(size, impl::kLogRecordAlignment);
+            if (size == 0U || aligned_size > head - tail || (tail % ring.capacity) + aligned_size > ring.capacity) {
+                // Only a misbehaving writer gets here, leaving nothing to be trusted in the ring.
+                tail = head;
+                break;
+            }
+            tail += aligned_size;
+            if (level == impl::kLogFillerLevel)
+                continue;
+
+            impl::LogRecordHeader header{};
+            if (size < sizeof(header))
+                continue;
+            std::memcpy(&header, record, sizeof(header));
+
+            auto body = std::span<const std::byte>{record, size}.subspan(sizeof(header));
+            if (body.size() < std::size_t{header.source_size} + header.format_size)
+                continue;
+            const auto source = io::takeBuf(body, header.source_size);
+            const auto format = io::takeBuf(body, header.format_size);
+
+            entries.push_back({
+                .time = std::chrono::system_clock::time_point{std::chrono::duration_cast<
+                    std::chrono::system_clock::duration>(std::chrono::nanoseconds{header.timestamp})},
+                .level = header.level,
+                .pid = ring.pid,
+                .tid = ring.tid,
+                .source = std::string{reinterpret_cast<const char*>(source.data()), source.size()},
+                .message = formatLogMessage({reinterpret_cast<const char*>(format.data()), format.size()}, body),
+            });
+        }
+        ring.tail.store(tail, std::memory_order_release);
+
+        const auto dropped = ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != mapped.reported_drops) {
+            drops.push_back({.pid = ring.pid, .tid = ring.tid, .count = dropped - mapped.reported_drops});
+            mapped.reported_drops = dropped;
+        }
+
+        if (!gone) {
+            ++it;
+            continue;
+        }
+
+        static_cast<void>(::unlinkat(m_directoryfd.fd(), name.c_str(), 0));
+        static_cast<void>(::munmap(mapped.ring, impl::LogRing::total_size(ring.capacity)));
+        it = m_rings.erase(it);
+    }
+}
+
+} // namespace fastipc
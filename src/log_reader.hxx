@@ -0,0 +1,101 @@
+/*
+ *  log_reader.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "io/fd.hxx"
+#include "log_ring.hxx"
+
+namespace fastipc {
+
+/// Log record, formatted
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct LogEntry {
+    std::chrono::system_clock::time_point time;
+    LogLevel level;
+    std::int32_t pid;
+    std::int32_t tid;
+    std::string source;
+    std::string message;
+};
+
+/// Records dropped by the writer of a log ring, for lack of room
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct LogDrops {
+    std::int32_t pid;
+    std::int32_t tid;
+    std::uint64_t count;
+};
+
+/// Formats a log message as `std::format` would, from its format string and encoded arguments
+///
+/// Fields left without an argument, or whose specification does not suit their argument, are kept as they are.
+[[nodiscard]] std::string formatLogMessage(std::string_view format, std::span<const std::byte> args);
+
+/// Has the records at warning level or above which no collector would get to see written to stderr instead
+///
+/// Stderr is written without ever blocking, leaving out what does not fit at once.
+void fallBackToStderr() noexcept;
+
+/// Drains the log rings of a directory, formatting their records
+///
+/// Writers only set up rings while a collector exists, which announces itself through a marker in the directory.
+/// Rings being drained by another collector are left alone.
+class LogCollector final {
+  public:
+    explicit LogCollector(std::string directory = std::string{impl::kLogRingDirectory});
+
+    LogCollector(const LogCollector&) = delete;
+    LogCollector& operator=(const LogCollector&) = delete;
+    ~LogCollector() noexcept;
+
+    /// Drains every ring, removing those whose thread is gone once drained
+    ///
+    /// @param[out] entries Appended the records not collected yet, in order per ring
+    /// @param[out] drops Appended the records dropped per ring since the previous call
+    void collect(std::vector<LogEntry>& entries, std::vector<LogDrops>& drops);
+
+  private:
+    // NOLINTNEXTLINE(altera-struct-pack-align)
+    struct MappedRing {
+        io::Fd fd;
+        impl::LogRing* ring;
+        std::uint64_t reported_drops;
+    };
+
+    /// Maps the rings which showed up since the previous call
+    void discover();
+
+    std::string m_directory;
+    io::Fd m_directoryfd;
+    // Marker held under a shared lock for as long as the collector exists
+    io::Fd m_markerfd;
+    std::map<std::string, MappedRing> m_rings;
+};
+
+} // namespace fastipc
@@ -0,0 +1,119 @@
+/*
+ *  log_ring.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "fastipc.hxx"
+#include "channel.hxx"
+
+namespace fastipc::impl {
+
+/// Version of the log ring layout below, bumped on every incompatible change
+constexpr std::uint32_t kLogLayoutVersion{1U};
+
+/// Directory holding the log rings
+constexpr std::string_view kLogRingDirectory{"/dev/shm"};
+
+/// Prefix of the files backing log rings, followed by the process and thread ids, dot-separated
+constexpr std::string_view kLogRingPrefix{"fastipc-log."};
+
+/// File in the ring directory which running collectors hold a shared lock on, announcing themselves to writers
+constexpr std::string_view kLogCollectorMarker{"fastipc-log-collector"};
+
+/// Number of record bytes a thread's log ring holds
+constexpr std::size_t kLogRingCapacity{std::size_t{256U} << 10U}; // NOLINT(*-magic-numbers)
+
+/// Alignment of log records within their ring
+constexpr std::size_t kLogRecordAlignment{8U};
+
+/// Level of the filler left at the end of a ring by records which did not fit before it
+constexpr auto kLogFillerLevel = static_cast<LogLevel>(UINT8_MAX);
+
+/// Header of a log record, followed by the source name, the format string and the encoded arguments
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct LogRecordHeader final {
+    // Bytes taken up by the record, header included, up to the alignment of the next one
+    std::uint32_t size;
+    LogLevel level;
+    std::uint8_t source_size;
+    std::uint16_t format_size;
+    // Nanoseconds since the epoch of the system clock
+    std::uint64_t timestamp;
+};
+
+/// Ring of log records written by a single thread, and drained by a single collector at a time
+///
+/// Records are written in place and never wrap around: one which does not fit before the end of the ring leaves a
+/// filler there, and starts over at the beginning.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct LogRing final {
+    // Immutable after creation
+    alignas(kCacheLineSize) std::uint32_t layout_version{kLogLayoutVersion};
+    std::int32_t pid{0};
+    std::int32_t tid{0};
+    std::size_t capacity{0U};
+
+    // Writer-owned
+    // Number of bytes ever written, filler included
+    alignas(kCacheLineSize) std::atomic_uint64_t head{0U};
+    // Records which found the ring full
+    std::atomic_uint64_t dropped{0U};
+    // Set once the writing thread is gone, for the ring to be removed once drained
+    std::atomic_bool closed{false};
+
+    // Collector-owned
+    // Number of bytes ever drained
+    alignas(kCacheLineSize) std::atomic_uint64_t tail{0U};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    alignas(kCacheLineSize) std::byte data[0]; // NOLINT(*-c-arrays)
+#pragma GCC diagnostic pop
+
+    [[nodiscard]] constexpr static std::size_t total_size(std::size_t capacity) noexcept {
+        return sizeof(LogRing) + capacity;
+    }
+
+    [[nodiscard]] std::byte* at(std::uint64_t position) noexcept {
+        return &data[static_cast<std::size_t>(position % capacity)];
+    }
+    [[nodiscard]] const std::byte* at(std::uint64_t position) const noexcept {
+        return &data[static_cast<std::size_t>(position % capacity)];
+    }
+};
+
+/// Most bytes a record may take up to be handed to the fallback, header included
+constexpr std::size_t kLogFallbackRecordCapacity{std::size_t{1U} << 10U}; // NOLINT(*-magic-numbers)
+
+/// Handler of the records at warning level or above which no collector would get to see, given encoded arguments
+using LogFallback = void (*)(LogLevel level, std::string_view source, std::string_view format,
+                             std::span<const std::byte> args) noexcept;
+
+/// Sets the handler of the records logged while no collector runs, null to drop them
+void setLogFallback(LogFallback fallback) noexcept;
+
+static_assert(sizeof(LogRecordHeader) % kLogRecordAlignment == 0U);
+static_assert(sizeof(LogRing) % kCacheLineSize == 0U);
+
+} // namespace fastipc::impl
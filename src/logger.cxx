@@ -0,0 +1,253 @@
+/*
+ *  logger.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "fastipc.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io/fd.hxx"
+#include "io/result.hxx"
+#include "channel.hxx"
+#include "log_ring.hxx"
+
+namespace fastipc {
+
+using namespace impl;
+
+namespace {
+
+/// Interval between attempts of a thread at setting up its ring, while no collector runs
+constexpr std::chrono::seconds kRingRetryInterval{1};
+
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+std::atomic<LogLevel> g_log_level{LogLevel::Info};
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+std::atomic<LogFallback> g_log_fallback{nullptr};
+
+[[nodiscard]] std::string ringPath(std::int32_t pid, std::int32_t tid) {
+    return std::format("{}/{}{}.{}", kLogRingDirectory, kLogRingPrefix, pid, tid);
+}
+
+/// Whether a collector runs, holding the shared lock on its marker
+[[nodiscard]] bool isCollectorRunning() noexcept {
+    const auto path = std::format("{}/{}", kLogRingDirectory, kLogCollectorMarker);
+    const auto fd = io::adoptSysFd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    return fd.has_value() && ::flock(fd->fd(), LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+}
+
+/// Log ring of a thread, set up on its first record once a collector runs
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ThreadLog final {
+    LogRing* ring{nullptr};
+    // When to next attempt setting up the ring, if none is yet
+    std::chrono::steady_clock::time_point next_attempt{};
+    // Head of the ring once the record being written gets committed
+    std::uint64_t pending_head{0U};
+    // Record being written while no collector runs, laid out as in a ring, for the fallback to get on commit
+    alignas(LogRecordHeader) std::array<std::byte, kLogFallbackRecordCapacity> fallback_record{};
+
+    ThreadLog() = default;
+    ThreadLog(const ThreadLog&) = delete;
+    ThreadLog& operator=(const ThreadLog&) = delete;
+    ~ThreadLog() noexcept {
+        if (ring == nullptr)
+            return;
+
+        // Rings with nothing left to collect, or nobody left to collect it, are of no use to anyone.
+        ring->closed.store(true, std::memory_order_release);
+        if (ring->tail.load(std::memory_order_acquire) == ring->head.load(std::memory_order_relaxed) ||
+            !isCollectorRunning())
+            static_cast<void>(::unlink(ringPath(ring->pid, ring->tid).c_str()));
+        static_cast<void>(::munmap(std::exchange(ring, nullptr), LogRing::total_size(kLogRingCapacity)));
+    }
+};
+
+thread_local ThreadLog t_log; // NOLINT(*-avoid-non-const-global-variables)
+
+/// Creates the log ring of the calling thread, only linking it into the ring directory once set up
+[[nodiscard]] LogRing* createRing() noexcept {
+    const std::string directory{kLogRingDirectory};
+    auto fd = io::adoptSysFd(::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR));
+    if (!fd.has_value())
+        return nullptr;
+
+    const auto size = LogRing::total_size(kLogRingCapacity);
+    if (::ftruncate(fd->fd(), static_cast<::off_t>(size)) != 0)
+        return nullptr;
+    auto* const ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd->fd(), 0);
+    if (ptr == MAP_FAILED) // NOLINT(*-cstyle-cast,performance-no-int-to-ptr)
+        return nullptr;
+
+    auto* const ring = ::new (ptr) LogRing;
+    ring->pid = static_cast<std::int32_t>(::getpid());
+    ring->tid = static_cast<std::int32_t>(::gettid());
+    ring->capacity = kLogRingCapacity;
+
+    const auto link = std::format("/proc/self/fd/{}", fd->fd());
+    const auto path = ringPath(ring->pid, ring->tid);
+    // A ring left behind by an exited thread of the same ids is no longer of use to anyone.
+    if (::linkat(AT_FDCWD, link.c_str(), AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW) != 0 &&
+        (errno != EEXIST || ::unlink(path.c_str()) != 0 ||
+         ::linkat(AT_FDCWD, link.c_str(), AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW) != 0)) {
+        static_cast<void>(::munmap(ptr, size));
+        return nullptr;
+    }
+
+    return ring;
+}
+
+/// Log ring of the calling thread, or null if it is not set up
+[[nodiscard]] LogRing* threadRing() noexcept {
+    if (t_log.ring != nullptr)
+        return t_log.ring;
+
+    // Rings are only left behind for a collector to remove.
+    const auto now = std::chrono::steady_clock::now();
+    if (now < t_log.next_attempt)
+        return nullptr;
+    t_log.next_attempt = now + kRingRetryInterval;
+    if (isCollectorRunning())
+        t_log.ring = createRing();
+    return t_log.ring;
+}
+
+[[nodiscard]] std::string_view sourceOf(void* shadow) noexcept { return *static_cast<const std::string*>(shadow); }
+
+/// Writes a record's header, source name and format string, returning where its arguments go
+[[nodiscard]] std::byte* writeRecordHeader(std::byte* out, LogLevel level, std::size_t record_size,
+                                           std::string_view source, std::string_view format) noexcept {
+    const LogRecordHeader header{
+        .size = static_cast<std::uint32_t>(record_size),
+        .level = level,
+        .source_size = static_cast<std::uint8_t>(source.size()),
+        .format_size = static_cast<std::uint16_t>(format.size()),
+        .timestamp = nanosecondsOf<std::chrono::system_clock>(std::chrono::system_clock::now()),
+    };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, source.data(), source.size());
+    out += source.size();
+    std::memcpy(out, format.data(), format.size());
+    return out + format.size();
+}
+
+/// Starts a record for the fallback, if any, unless it is below warning level or too large to hand over
+[[nodiscard]] std::byte* beginFallbackRecord(LogLevel level, std::string_view source, std::string_view format,
+                                             std::size_t args_size) noexcept {
+    const auto record_size = sizeof(LogRecordHeader) + source.size() + format.size() + args_size;
+    if (level < LogLevel::Warning || g_log_fallback.load(std::memory_order_relaxed) == nullptr ||
+        format.size() > UINT16_MAX || record_size > kLogFallbackRecordCapacity)
+        return nullptr;
+    return writeRecordHeader(t_log.fallback_record.data(), level, record_size, source, format);
+}
+
+/// Hands the record started last for the fallback over to it
+void commitFallbackRecord() noexcept {
+    const auto fallback = g_log_fallback.load(std::memory_order_relaxed);
+    if (fallback == nullptr)
+        return;
+
+    LogRecordHeader header{};
+    std::memcpy(&header, t_log.fallback_record.data(), sizeof(header));
+    const auto record = std::span{t_log.fallback_record}.first(header.size).subspan(sizeof(header));
+    const auto source = record.first(header.source_size);
+    const auto format = record.subspan(header.source_size, header.format_size);
+    fallback(header.level, {reinterpret_cast<const char*>(source.data()), source.size()},
+             {reinterpret_cast<const char*>(format.data()), format.size()},
+             record.subspan(std::size_t{header.source_size} + header.format_size));
+}
+
+} // namespace
+
+void setLogLevel(LogLevel level) noexcept { g_log_level.store(level, std::memory_order_relaxed); }
+
+void impl::setLogFallback(LogFallback fallback) noexcept {
+    g_log_fallback.store(fallback, std::memory_order_relaxed);
+}
+
+Logger::Logger(std::string_view source)
+    : m_shadow{new std::string{source.substr(0U, std::min<std::size_t>(source.size(), UINT8_MAX))}} {}
+
+Logger::~Logger() noexcept { delete static_cast<std::string*>(m_shadow); }
+
+auto Logger::beginRecord(LogLevel level, std::string_view format, std::size_t args_size) const noexcept
+    -> std::byte* {
+    if (level < g_log_level.load(std::memory_order_relaxed))
+        return nullptr;
+
+    const auto source = sourceOf(m_shadow);
+    auto* const ring = threadRing();
+    if (ring == nullptr)
+        return beginFallbackRecord(level, source, format, args_size);
+
+    const auto record_size = sizeof(LogRecordHeader) + source.size() + format.size() + args_size;
+    const auto size = alignUp(record_size, kLogRecordAlignment);
+    if (format.size() > UINT16_MAX || size > ring->capacity / 2U) {
+        ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Records do not wrap around, leaving the rest of the ring to filler instead.
+    const auto head = ring->head.load(std::memory_order_relaxed);
+    const auto room_before_end = ring->capacity - static_cast<std::size_t>(head % ring->capacity);
+    const auto filler_size = room_before_end < size ? room_before_end : 0U;
+    if (head + filler_size + size - ring->tail.load(std::memory_order_acquire) > ring->capacity) {
+        ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (filler_size != 0U) {
+        // Filler may be too short for a whole header, hence only carries its leading size and level.
+        const auto filler_record_size = static_cast<std::uint32_t>(filler_size);
+        std::memcpy(ring->at(head) + offsetof(LogRecordHeader, size), &filler_record_size, sizeof(std::uint32_t));
+        std::memcpy(ring->at(head) + offsetof(LogRecordHeader, level), &kLogFillerLevel, sizeof(LogLevel));
+    }
+
+    t_log.pending_head = head + filler_size + size;
+    return writeRecordHeader(ring->at(head + filler_size), level, record_size, source, format);
+}
+
+void Logger::commitRecord() const noexcept {
+    // Records begun without a ring went to the fallback.
+    if (t_log.ring == nullptr) {
+        commitFallbackRecord();
+        return;
+    }
+    t_log.ring->head.store(t_log.pending_head, std::memory_order_release);
+}
+
+} // namespace fastipc
@@ -16,9 +16,112 @@
  *
  */
 
+// Runs the tower, optionally bridging channels to and from fastipcd on other hosts.
+//
+// Usage: fastipcd [--verbose] [--tcp] [--bridge-to <address> --channel <name>:<max payload size>...]
+//                 [--bridge-from <address> --channel <name>:<max payload size>...]
+//
+// Addresses are written as `a.b.c.d:port` or `[v6]:port`; bridges use UDP unless asked for TCP. Channels belong to the
+// bridge option preceding them: the sender forwards those, and the receiver republishes nothing else.
+
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "bridge.hxx"
+#include "io/addr.hxx"
 #include "tower.hxx"
 
-int main() {
-    auto tower = fastipc::Tower::create("fastipcd");
+namespace {
+
+constexpr std::string_view kTowerPath{"fastipcd"};
+
+/// Parses a channel to bridge, written as `<name>:<max payload size>`
+[[nodiscard]] std::optional<fastipc::BridgedChannel> parseChannel(std::string_view text) {
+    const auto colon = text.rfind(':');
+    if (colon == std::string_view::npos || colon == 0U)
+        return std::nullopt;
+
+    std::size_t max_payload_size{0U};
+    const auto size_text = text.substr(colon + 1U);
+    if (const auto [end, ec] = std::from_chars(size_text.data(), size_text.data() + size_text.size(), max_payload_size);
+        ec != std::errc{} || end != size_text.data() + size_text.size())
+        return std::nullopt;
+
+    return fastipc::BridgedChannel{.name = std::string{text.substr(0U, colon)}, .max_payload_size = max_payload_size};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<std::string_view> args(argv + 1, argv + argc); // NOLINT(*-pointer-arithmetic)
+
+    auto transport = fastipc::BridgeTransport::Udp;
+    std::optional<fastipc::io::SocketAddr> bridge_to;
+    std::optional<fastipc::io::SocketAddr> bridge_from;
+    std::vector<fastipc::BridgedChannel> sent_channels;
+    std::vector<fastipc::BridgedChannel> received_channels;
+    std::vector<fastipc::BridgedChannel>* channels{nullptr};
+    bool valid{true};
+    for (std::size_t i{0U}; valid && i < args.size(); ++i) {
+        const bool has_value = i + 1U < args.size();
+        if (args[i] == "--verbose") {
+            fastipc::setLogLevel(fastipc::LogLevel::Debug);
+        } else if (args[i] == "--tcp") {
+            transport = fastipc::BridgeTransport::Tcp;
+        } else if (args[i] == "--bridge-to" && has_value) {
+            const auto addr = fastipc::io::parseSocketAddr(args[++i]);
+            valid = addr.has_value();
+            if (valid)
+                bridge_to = *addr;
+            channels = &sent_channels;
+        } else if (args[i] == "--bridge-from" && has_value) {
+            const auto addr = fastipc::io::parseSocketAddr(args[++i]);
+            valid = addr.has_value();
+            if (valid)
+                bridge_from = *addr;
+            channels = &received_channels;
+        } else if (args[i] == "--channel" && has_value && channels != nullptr) {
+            auto channel = parseChannel(args[++i]);
+            valid = channel.has_value();
+            if (valid)
+                channels->push_back(std::move(*channel));
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || bridge_to.has_value() == sent_channels.empty() ||
+        bridge_from.has_value() == received_channels.empty()) {
+        std::println(stderr, "usage: fastipcd [--verbose] [--tcp] [--bridge-to <address> --channel "
+                             "<name>:<max payload size>...] [--bridge-from <address> --channel "
+                             "<name>:<max payload size>...]");
+        return EXIT_FAILURE;
+    }
+
+    auto tower = fastipc::Tower::create(kTowerPath);
+
+    // Bridges open their channels through the tower, hence only once it runs.
+    std::vector<std::jthread> bridges;
+    if (bridge_to.has_value()) {
+        bridges.emplace_back([&] {
+            auto sender = fastipc::BridgeSender::create(kTowerPath, sent_channels, *bridge_to, transport);
+            sender.run();
+        });
+    }
+    if (bridge_from.has_value()) {
+        bridges.emplace_back([&] {
+            auto receiver = fastipc::BridgeReceiver::create(kTowerPath, received_channels, *bridge_from, transport);
+            receiver.run();
+        });
+    }
+
     tower.run();
 }
@@ -0,0 +1,220 @@
+/*
+ *  registry.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "registry.hxx"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "io/fd.hxx"
+#include "io/result.hxx"
+#include "channel.hxx"
+
+namespace fastipc {
+namespace {
+
+constexpr std::string_view kRegistryRoot{"/dev/shm/fastipc"};
+constexpr std::string_view kHexDigits{"0123456789ABCDEF"};
+
+[[nodiscard]] constexpr bool needsEscaping(char c, bool leading) noexcept {
+    return c == '/' || c == '%' || c == '\0' || (leading && c == '.');
+}
+
+[[nodiscard]] constexpr int hexValue(char c) noexcept {
+    const auto digit = kHexDigits.find(c);
+    return digit == std::string_view::npos ? -1 : static_cast<int>(digit);
+}
+
+[[nodiscard]] bool isEventFd(const io::Fd& fd) {
+    constexpr std::string_view kTarget{"anon_inode:[eventfd]"};
+    std::array<char, kTarget.size() + 1U> target{};
+    const auto link = std::format("/proc/self/fd/{}", fd.fd());
+    const auto size = ::readlink(link.c_str(), target.data(), target.size());
+    return size >= 0 && std::string_view{target.data(), static_cast<std::size_t>(size)} == kTarget;
+}
+
+} // namespace
+
+std::string registryPathFor(std::string_view socket_path) {
+    std::error_code ec;
+    auto absolute_path = std::filesystem::absolute(socket_path, ec).lexically_normal().string();
+    if (ec)
+        absolute_path = socket_path;
+
+    // Flatten the socket path, so that every tower gets a registry of its own.
+    std::string path{kRegistryRoot};
+    for (const auto c : absolute_path)
+        path += c == '/' ? '-' : c;
+    return path;
+}
+
+std::optional<std::string> registryFileOf(std::string_view channel_name) {
+    if (channel_name.empty())
+        return std::nullopt;
+
+    // Percent-encode whatever could not stand in a file name, or would be hidden.
+    std::string file_name;
+    file_name.reserve(channel_name.size());
+    for (std::size_t i{0U}; i < channel_name.size(); ++i) {
+        const auto c = channel_name[i];
+        if (!needsEscaping(c, i == 0U)) {
+            file_name += c;
+            continue;
+        }
+
+        const auto byte = static_cast<unsigned char>(c);
+        file_name += '%';
+        file_name += kHexDigits[byte >> 4U];
+        file_name += kHexDigits[byte & 0xFU]; // NOLINT(*-magic-numbers)
+    }
+
+    if (file_name.size() > NAME_MAX)
+        return std::nullopt;
+    return file_name;
+}
+
+std::optional<std::string> channelNameOf(std::string_view file_name) {
+    if (file_name.empty() || file_name.front() == '.')
+        return std::nullopt;
+
+    std::string channel_name;
+    channel_name.reserve(file_name.size());
+    for (std::size_t i{0U}; i < file_name.size(); ++i) {
+        if (file_name[i] != '%') {
+            channel_name += file_name[i];
+            continue;
+        }
+
+        if (i + 2U >= file_name.size())
+            return std::nullopt;
+        const auto high = hexValue(file_name[i + 1U]);
+        const auto low = hexValue(file_name[i + 2U]);
+        if (high < 0 || low < 0)
+            return std::nullopt;
+        channel_name += static_cast<char>((high << 4) | low);
+        i += 2U;
+    }
+
+    return channel_name;
+}
+
+io::expected<io::Fd> openRegistry(const std::string& path) {
+    if (::mkdir(path.c_str(), S_IRWXU) != 0 && errno != EEXIST)
+        return io::unexpected{io::errnoCode()};
+    return io::adoptSysFd(::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+}
+
+std::optional<std::uint64_t> processStartTime(std::int32_t pid) {
+    std::ifstream stat{std::format("/proc/{}/stat", pid)};
+    std::string line;
+    if (!std::getline(stat, line))
+        return std::nullopt;
+
+    // The command name may hold anything, spaces and parentheses included, hence fields are counted from its end.
+    const auto command_end = line.rfind(')');
+    if (command_end == std::string::npos)
+        return std::nullopt;
+    std::istringstream fields{line.substr(command_end + 1U)};
+    std::string field;
+    // The start time is the 22nd field, the 20th past the command name.
+    constexpr int kStartTimeField{20};
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kStartTimeField
+    for (int i{0}; i < kStartTimeField; ++i) {
+        if (!(fields >> field))
+            return std::nullopt;
+    }
+
+    std::uint64_t start_time{0U};
+    if (const auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), start_time);
+        ec != std::errc{} || end != field.data() + field.size())
+        return std::nullopt;
+    return start_time;
+}
+
+std::uint64_t pidNamespace() {
+    static const std::uint64_t pid_namespace = [] {
+        struct ::stat status{};
+        return ::stat("/proc/self/ns/pid", &status) == 0 ? static_cast<std::uint64_t>(status.st_ino) : 0U;
+    }();
+    return pid_namespace;
+}
+
+OwnerState ownerState(const impl::EndpointStats& stats) {
+    const auto pid = stats.owner_pid.load(std::memory_order_acquire);
+    if (pid == 0)
+        return OwnerState::Free;
+    if (const auto pid_namespace = stats.owner_pid_namespace.load(std::memory_order_relaxed);
+        pid_namespace == 0U || pid_namespace != pidNamespace())
+        return OwnerState::Foreign;
+    if (::kill(pid, 0) != 0 && errno == ESRCH)
+        return OwnerState::Gone;
+
+    // Processes we may not look into are taken for live, just as those exiting between both checks.
+    const auto owner_start_time = stats.owner_start_time.load(std::memory_order_relaxed);
+    if (const auto start_time = processStartTime(pid);
+        owner_start_time != 0U && start_time.has_value() && *start_time != owner_start_time)
+        return OwnerState::Gone;
+    return OwnerState::Live;
+}
+
+std::optional<io::Fd> recoverEventFd(const impl::ChannelPage& channel_page) {
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the record count
+    for (std::size_t record{0U}; record < channel_page.record_count; ++record) {
+        const auto& stats = channel_page.stats(record);
+        const auto pid = stats.owner_pid.load(std::memory_order_acquire);
+        const auto notify_fd = stats.notify_fd.load(std::memory_order_acquire);
+        const auto owner_start_time = stats.owner_start_time.load(std::memory_order_relaxed);
+        if (pid == 0 || notify_fd < 0 || owner_start_time == 0U)
+            continue;
+
+        const auto pidfd = io::adoptSysFd(static_cast<int>(::syscall(SYS_pidfd_open, pid, 0U)));
+        if (!pidfd.has_value())
+            continue;
+        // The process id may have been reused since the record was left behind; checked with the pidfd open, so that
+        // the process checked is the one descriptors get taken from.
+        if (ownerState(stats) != OwnerState::Live)
+            continue;
+        auto eventfd = io::adoptSysFd(static_cast<int>(::syscall(SYS_pidfd_getfd, pidfd->fd(), notify_fd, 0U)));
+        if (eventfd.has_value() && isEventFd(*eventfd))
+            return std::move(*eventfd);
+    }
+
+    return std::nullopt;
+}
+
+} // namespace fastipc
@@ -0,0 +1,74 @@
+/*
+ *  registry.hxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "io/fd.hxx"
+#include "io/result.hxx"
+#include "channel.hxx"
+
+namespace fastipc {
+
+/// Directory pinning the channels of the tower listening at the given path
+///
+/// Lives on tmpfs, so that channels outlive the tower without ever being written back to disk.
+[[nodiscard]] std::string registryPathFor(std::string_view socket_path);
+
+/// Name of the registry file pinning a channel, unless the channel name does not fit in one
+[[nodiscard]] std::optional<std::string> registryFileOf(std::string_view channel_name);
+
+/// Name of the channel a registry file pins, unless it is no such file
+[[nodiscard]] std::optional<std::string> channelNameOf(std::string_view file_name);
+
+/// Opens the registry directory, creating it if needed
+[[nodiscard]] io::expected<io::Fd> openRegistry(const std::string& path);
+
+/// Start time of a process, in clock ticks since boot, unless it is gone
+[[nodiscard]] std::optional<std::uint64_t> processStartTime(std::int32_t pid);
+
+/// PID namespace of the calling process, as the inode of its /proc entry; zero if unknown
+[[nodiscard]] std::uint64_t pidNamespace();
+
+/// State of the process owning a stats record, as far as the calling process can tell
+enum class OwnerState : std::uint8_t {
+    Free = 0,
+    Live = 1,
+    /// Exited, whether or not its process id got reused by another process since
+    Gone = 2,
+    /// Owned from another PID namespace, or one not known yet, in which its process id means nothing to us
+    Foreign = 3,
+};
+
+/// Tells whether the process owning a stats record is still the one which claimed it
+///
+/// Records whose owner did not get to record its start time yet are only checked for their process id. Those of
+/// other PID namespaces are never taken for gone, leaving them to the owner's lock on the channel.
+[[nodiscard]] OwnerState ownerState(const impl::EndpointStats& stats);
+
+/// Recovers the notification descriptor of a channel from one of its live endpoints, which keep waiting on it
+///
+/// Records whose process id got reused by another process since are skipped. Takes Linux 5.6, as well as being
+/// allowed to trace the endpoint's process.
+[[nodiscard]] std::optional<io::Fd> recoverEventFd(const impl::ChannelPage& channel_page);
+
+} // namespace fastipc
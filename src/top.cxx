@@ -0,0 +1,150 @@
+/*
+ *  top.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+// Lists the tower's channels along with the live rates of their endpoints.
+//
+// Usage: fastipc-top [--once] [--interval-ms <ms>]
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <map>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "inspect.hxx"
+
+namespace {
+
+using EndpointKey = std::tuple<std::string, std::uint32_t, std::int32_t>;
+
+/// Counter deltas per second, or totals without a previous snapshot
+[[nodiscard]] double rate(std::uint64_t current, const std::uint64_t* previous, double seconds) noexcept {
+    if (previous == nullptr)
+        return static_cast<double>(current);
+    return static_cast<double>(current - *previous) / seconds;
+}
+
+void print(const std::vector<fastipc::ChannelSnapshot>& snapshots,
+           const std::map<EndpointKey, fastipc::EndpointSnapshot>& previous, double seconds) {
+    std::println("{} channel(s), {}", snapshots.size(), previous.empty() ? "totals" : "per second");
+
+    for (const auto& channel : snapshots) {
+        const bool is_queue = channel.kind == fastipc::ChannelKind::Queue;
+        const bool is_rpc = channel.kind == fastipc::ChannelKind::Rpc;
+        std::println("{} ({}): {} B payload, {}/{} slots {}, latest seq {}, {} waiting, {} armed", channel.name,
+                     is_queue ? "queue" : (is_rpc ? "rpc" : "mailbox"), channel.max_payload_size,
+                     channel.occupied_slots, channel.slot_count,
+                     is_queue ? "queued" : (is_rpc ? "in flight" : "occupied"), channel.latest_sequence_id,
+                     channel.waiter_count, channel.armed_count);
+        if (channel.fill_latency.count != 0U) {
+            constexpr std::array kClockNames{"system", "steady", "tsc"};
+            std::println("  traced {} sample(s) on the {} clock: prepare to submit {}/{}/{} ns, "
+                         "submit to first acquire {}/{}/{} ns (median/p99/max)",
+                         channel.fill_latency.count, kClockNames.at(static_cast<std::size_t>(channel.clock)),
+                         channel.fill_latency.median, channel.fill_latency.p99, channel.fill_latency.max,
+                         channel.delivery_latency.median, channel.delivery_latency.p99, channel.delivery_latency.max);
+        }
+        if (channel.numa_node != fastipc::kNoNumaNode || channel.resident_node >= 0)
+            std::println("  NUMA node {}, resident on node {}",
+                         channel.numa_node == fastipc::kNoNumaNode ? "unbound" : std::to_string(channel.numa_node),
+                         channel.resident_node < 0 ? "unknown" : std::to_string(channel.resident_node));
+
+        for (const auto& endpoint : channel.endpoints) {
+            const auto found = previous.find({channel.name, endpoint.record, endpoint.pid});
+            const auto* const before = found == previous.end() ? nullptr : &found->second;
+            const auto counter = [&](std::uint64_t fastipc::EndpointSnapshot::* field) {
+                return rate(endpoint.*field, before == nullptr ? nullptr : &(before->*field), seconds);
+            };
+
+            const auto owner = std::format("pid {}{}", endpoint.pid, endpoint.alive ? "" : " (dead)");
+            if (endpoint.role == fastipc::RequesterType::Writer) {
+                std::println("  writer {:>16}: {:.0f} submits, {:.0f} prepare retries, {:.0f} yields, "
+                             "{:.0f} racy hints, {} slots held",
+                             owner, counter(&fastipc::EndpointSnapshot::submits),
+                             counter(&fastipc::EndpointSnapshot::prepare_retries),
+                             counter(&fastipc::EndpointSnapshot::prepare_yields),
+                             counter(&fastipc::EndpointSnapshot::racy_hints), endpoint.heldSlots());
+            } else {
+                std::println("  reader {:>16}: {:.0f} acquires, {:.0f} acquire retries, {:.0f} copy retries, "
+                             "{:.0f} skipped, {} slots held",
+                             owner, counter(&fastipc::EndpointSnapshot::acquires),
+                             counter(&fastipc::EndpointSnapshot::acquire_retries),
+                             counter(&fastipc::EndpointSnapshot::copy_retries),
+                             counter(&fastipc::EndpointSnapshot::skipped_sequence_ids), endpoint.heldSlots());
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<std::string_view> args(argv + 1, argv + argc); // NOLINT(*-pointer-arithmetic)
+
+    bool once{false};
+    std::chrono::milliseconds interval{1000}; // NOLINT(*-magic-numbers)
+    for (std::size_t i{0U}; i < args.size(); ++i) {
+        if (args[i] == "--once") {
+            once = true;
+        } else if (args[i] == "--interval-ms" && i + 1U < args.size()) {
+            interval = std::chrono::milliseconds{std::strtol(std::string{args[++i]}.c_str(), nullptr, 10)};
+        } else {
+            std::println(stderr, "usage: fastipc-top [--once] [--interval-ms <ms>]");
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::map<EndpointKey, fastipc::EndpointSnapshot> previous;
+    auto previous_time = std::chrono::steady_clock::now();
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        const auto snapshots = fastipc::inspectTower("fastipcd");
+        const auto now = std::chrono::steady_clock::now();
+        if (!snapshots.has_value()) {
+            std::println(stderr, "failed to inspect tower: {}", snapshots.error().message());
+            return EXIT_FAILURE;
+        }
+
+        if (!once)
+            // Clear the terminal
+            std::print("\x1b[H\x1b[2J");
+        print(*snapshots, previous, std::chrono::duration<double>(now - previous_time).count());
+        std::fflush(stdout);
+        if (once)
+            return EXIT_SUCCESS;
+
+        previous.clear();
+        for (const auto& channel : *snapshots) {
+            for (const auto& endpoint : channel.endpoints)
+                previous.emplace(EndpointKey{channel.name, endpoint.record, endpoint.pid}, endpoint);
+        }
+        previous_time = now;
+
+        std::this_thread::sleep_for(interval);
+    }
+}
@@ -18,55 +18,400 @@
 
 #include "tower.hxx"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <chrono>
 #include <csignal>
 #include <cstddef>
 #include <cstdint>
-#include <cstdio>
 #include <cstring>
-#include <limits>
-#include <print>
+#include <format>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <utility>
-
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
 #include <sys/un.h>
 #include <unistd.h>
 
 #include "io/cursor.hxx"
 #include "io/fd.hxx"
+#include "io/numa.hxx"
 #include "io/result.hxx"
 #include "channel.hxx"
+#include "inspect.hxx"
 #include "local_proto.hxx"
+#include "log_reader.hxx"
+#include "registry.hxx"
 
 namespace fastipc {
 namespace {
 
-[[nodiscard]] ClientRequest readClientRequest(std::span<const std::byte>& buf) noexcept {
-    const auto requester_type = io::getBuf<std::underlying_type_t<RequesterType>>(buf);
-    const auto max_payload_size = io::getBuf<std::size_t>(buf);
-    const auto topic_name_buf = io::takeBuf(buf, io::getBuf<std::uint8_t>(buf));
+/// Logger of the tower
+[[nodiscard]] const Logger& towerLog() {
+    static const Logger logger{"fastipcd"};
+    return logger;
+}
 
-    assert(requester_type < 2);
+[[nodiscard]] constexpr std::string_view kindName(ChannelKind kind) noexcept {
+    switch (kind) {
+    case ChannelKind::Queue:
+        return "queue";
+    case ChannelKind::Rpc:
+        return "RPC";
+    case ChannelKind::Mailbox:
+    default:
+        return "mailbox";
+    }
+}
 
-    return {
+[[nodiscard]] constexpr std::string_view roleName(ChannelKind kind, RequesterType type) noexcept {
+    if (kind == ChannelKind::Rpc)
+        return type == RequesterType::Reader ? "server" : "client";
+    return type == RequesterType::Reader ? "reader" : "writer";
+}
+
+[[nodiscard]] std::optional<ClientRequest> readClientRequest(std::span<const std::byte>& buf,
+                                                             std::uint16_t protocol_version) noexcept {
+    const bool has_page_backing = protocol_version >= 2U;
+    const bool has_kind = protocol_version >= 4U;
+    const bool has_history_depth = protocol_version >= 5U;
+    const bool has_tracing = protocol_version >= 7U;
+    const bool has_numa_node = protocol_version >= 9U;
+    const bool has_writer_lanes = protocol_version >= 10U;
+    const bool has_endpoint_records = protocol_version >= 12U;
+    const std::size_t header_size = sizeof(std::uint32_t) + sizeof(std::underlying_type_t<RequesterType>) +
+                                    sizeof(std::size_t) + sizeof(std::uint32_t) +
+                                    (has_page_backing ? sizeof(PageBacking) : 0U) +
+                                    (has_kind ? sizeof(ChannelKind) : 0U) +
+                                    (has_history_depth ? sizeof(std::uint32_t) : 0U) +
+                                    (has_tracing ? sizeof(ChannelClock) + sizeof(std::uint32_t) : 0U) +
+                                    (has_numa_node ? sizeof(std::int32_t) : 0U) +
+                                    (has_writer_lanes ? sizeof(std::uint32_t) : 0U) +
+                                    (has_endpoint_records ? sizeof(std::uint32_t) : 0U) +
+                                    sizeof(std::uint8_t);
+    if (buf.size() < header_size)
+        return std::nullopt;
+
+    const auto layout_version = io::getBuf<std::uint32_t>(buf);
+    const auto requester_type = io::getBuf<std::underlying_type_t<RequesterType>>(buf);
+    const auto max_payload_size = io::getBuf<std::size_t>(buf);
+    const auto slot_count = io::getBuf<std::uint32_t>(buf);
+    const auto page_backing = has_page_backing ? io::getBuf<std::underlying_type_t<PageBacking>>(buf) : 0U;
+    const auto kind = has_kind ? io::getBuf<std::underlying_type_t<ChannelKind>>(buf) : 0U;
+    const auto history_depth = has_history_depth ? io::getBuf<std::uint32_t>(buf) : 1U;
+    const auto clock = has_tracing ? io::getBuf<std::underlying_type_t<ChannelClock>>(buf) : 0U;
+    const auto trace_depth = has_tracing ? io::getBuf<std::uint32_t>(buf) : 0U;
+    const auto numa_node = has_numa_node ? io::getBuf<std::int32_t>(buf) : kNoNumaNode;
+    const auto writer_lanes = has_writer_lanes ? io::getBuf<std::uint32_t>(buf) : 1U;
+    const auto endpoint_records = has_endpoint_records
+                                      ? io::getBuf<std::uint32_t>(buf)
+                                      : static_cast<std::uint32_t>(impl::ChannelPage::kMaxRecordCount);
+    const auto topic_name_size = io::getBuf<std::uint8_t>(buf);
+
+    if (requester_type >= 2 || page_backing >= 3 || kind >= 3 || clock >= 3 || numa_node < kNoNumaNode ||
+        numa_node >= io::kMaxNumaNodes || buf.size() < topic_name_size)
+        return std::nullopt;
+    // Bounded before anything gets sized after them
+    if (max_payload_size > impl::kMaxPayloadSize || slot_count > impl::ChannelPage::kMaxSlotCount ||
+        history_depth > impl::ChannelPage::kMaxHistoryDepth || trace_depth > impl::ChannelPage::kMaxTraceDepth)
+        return std::nullopt;
+
+    const auto topic_name_buf = io::takeBuf(buf, topic_name_size);
+
+    return ClientRequest{
+        .layout_version = layout_version,
         .type = static_cast<RequesterType>(requester_type),
         .max_payload_size = max_payload_size,
+        .slot_count = slot_count,
+        .page_backing = static_cast<PageBacking>(page_backing),
+        .kind = static_cast<ChannelKind>(kind),
+        .history_depth = history_depth,
+        .clock = static_cast<ChannelClock>(clock),
+        .trace_depth = trace_depth,
+        .numa_node = numa_node,
+        .writer_lanes = writer_lanes,
+        .endpoint_records = endpoint_records,
         .topic_name = {reinterpret_cast<const char*>(topic_name_buf.data()), topic_name_buf.size()},
     };
 }
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ClientMessage {
+    // Zero for unversioned messages
+    std::uint16_t protocol_version;
+    MessageKind kind;
+    std::vector<ClientRequest> requests;
+    // Channel the inspection pages on from, empty for the first page
+    std::string inspect_after;
+};
+
+[[nodiscard]] std::optional<ClientMessage> readClientMessage(std::span<const std::byte>& buf) {
+    constexpr std::size_t kHeaderSize = sizeof(std::uint32_t) + sizeof(std::uint16_t) + sizeof(std::uint16_t);
+
+    auto peekbuf = buf;
+    if (buf.size() < kHeaderSize || io::getBuf<std::uint32_t>(peekbuf) != kProtocolMagic) {
+        // Unversioned clients send a single request at once.
+        auto request = readClientRequest(buf, 0U);
+        if (!request.has_value())
+            return std::nullopt;
+        return ClientMessage{
+            .protocol_version = 0U, .kind = MessageKind::Open, .requests = {*request}, .inspect_after = {}};
+    }
+
+    buf = peekbuf;
+    const auto protocol_version = io::getBuf<std::uint16_t>(buf);
+
+    ClientMessage message{
+        .protocol_version = protocol_version, .kind = MessageKind::Open, .requests = {}, .inspect_after = {}};
+    if (protocol_version == 0U || protocol_version > kProtocolVersion)
+        // Let the caller turn the client away, as we cannot tell what follows.
+        return message;
+
+    if (protocol_version >= 3U) {
+        if (buf.size() < sizeof(MessageKind) + sizeof(std::uint16_t))
+            return std::nullopt;
+        const auto kind = io::getBuf<std::underlying_type_t<MessageKind>>(buf);
+        if (kind >= 3)
+            return std::nullopt;
+        message.kind = static_cast<MessageKind>(kind);
+    } else if (buf.size() < sizeof(std::uint16_t)) {
+        return std::nullopt;
+    }
+
+    const auto request_count = io::getBuf<std::uint16_t>(buf);
+    if (message.kind == MessageKind::Inspect) {
+        if (request_count != 0U)
+            return std::nullopt;
+        if (protocol_version >= 13U) {
+            if (buf.size() < sizeof(std::uint8_t))
+                return std::nullopt;
+            const auto after_size = io::getBuf<std::uint8_t>(buf);
+            if (buf.size() < after_size)
+                return std::nullopt;
+            const auto after = io::takeBuf(buf, after_size);
+            message.inspect_after = std::string{reinterpret_cast<const char*>(after.data()), after.size()};
+        }
+        return message;
+    }
+
+    if (request_count == 0U || request_count > kMaxBatchSize)
+        return std::nullopt;
+
+    message.requests.reserve(request_count);
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kMaxBatchSize
+    for (std::size_t i{0U}; i < request_count; ++i) {
+        auto request = readClientRequest(buf, protocol_version);
+        if (!request.has_value())
+            return std::nullopt;
+        message.requests.push_back(*request);
+    }
+
+    return message;
+}
+
+/// Sends one reply per request of a client message, along with the descriptors of every opened channel
+[[nodiscard]] io::expected<void> reply(const io::Fd& clientfd, std::span<const TowerReply> replies,
+                                       std::span<const int> fds) noexcept {
+    assert(fds.size() <= kMaxBatchSize * kFdsPerChannel);
+
+    ::msghdr msg{};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast) iovec is shared with recvmsg
+    ::iovec iov{.iov_base = const_cast<TowerReply*>(replies.data()), .iov_len = replies.size_bytes()};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * kMaxBatchSize * kFdsPerChannel)> ctrl{};
+    if (!fds.empty()) {
+        msg.msg_control = ctrl.data();
+        msg.msg_controllen = ctrl.size();
+
+        auto* const cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET; // NOLINT(misc-include-cleaner) false-positive
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fds.size_bytes());
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), fds.size_bytes());
+        msg.msg_controllen = CMSG_SPACE(fds.size_bytes());
+    }
+
+    return io::sysCheck(::sendmsg(clientfd.fd(), &msg, MSG_NOSIGNAL));
+}
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ChannelMemory {
+    io::Fd memfd;
+    std::size_t size;
+    void* ptr;
+    PageBacking backing;
+};
+
+/// Creates and maps channel memory of at least the given size with the given backing
+///
+/// Memory goes into an unnamed file of the registry, if any, to be pinned once set up; hugetlbfs pages only come
+/// anonymous.
+[[nodiscard]] io::expected<ChannelMemory> createChannelMemory(const std::string& name, std::size_t size,
+                                                              PageBacking backing, const io::Fd& registryfd) {
+    const unsigned int flags = MFD_CLOEXEC | (backing == PageBacking::HugeTlb ? MFD_HUGETLB : 0U);
+    // Huge page backed files only come in whole huge pages, and THP only backs whole aligned huge pages.
+    const auto mapped_size = backing == PageBacking::Default ? size : impl::alignUp(size, impl::kHugePageSize);
+
+    const bool in_registry = registryfd.fd() >= 0 && backing != PageBacking::HugeTlb;
+    auto memfd =
+        io::adoptSysFd(in_registry ? ::openat(registryfd.fd(), ".", O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR)
+                                   : ::memfd_create(name.c_str(), flags));
+    if (!memfd.has_value())
+        return io::unexpected{memfd.error()};
+
+    // NOLINTNEXTLINE(*-narrowing-conversions)
+    if (auto res = io::sysCheck(::ftruncate(memfd->fd(), mapped_size)); !res.has_value())
+        return io::unexpected{res.error()};
+
+    // Fails here rather than on first touch if the hugetlb pool is exhausted.
+    const auto ptr = io::sysVal(::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd->fd(), 0));
+    if (!ptr.has_value())
+        return io::unexpected{ptr.error()};
+
+    if (backing == PageBacking::TransparentHuge) {
+        if (auto res = io::sysCheck(::madvise(*ptr, mapped_size, MADV_HUGEPAGE)); !res.has_value()) {
+            static_cast<void>(::munmap(*ptr, mapped_size));
+            return io::unexpected{res.error()};
+        }
+    }
+
+    return ChannelMemory{.memfd = std::move(*memfd), .size = mapped_size, .ptr = *ptr, .backing = backing};
+}
+
+[[nodiscard]] constexpr TowerReply rejection(ReplyStatus status) noexcept {
+    return {.status = status, .record = impl::ChannelPage::kNoRecord, .total_size = 0U};
+}
+
+/// Process on the other end of a connection, zero if unknown
+[[nodiscard]] std::int32_t peerPid(const io::Fd& clientfd) noexcept {
+    ::ucred credentials{};
+    ::socklen_t size{sizeof(credentials)};
+    if (::getsockopt(clientfd.fd(), SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0)
+        return 0;
+    return credentials.pid;
+}
+
+/// Time spent measuring the rate of the time stamp counter, once per tower
+constexpr std::chrono::milliseconds kTscCalibrationTime{10}; // NOLINT(*-magic-numbers)
+
+/// Whether the time stamp counter can stand in for the steady clock, ticking at a constant rate whatever the power
+/// state and trusted by the kernel to be in sync across cores, as its clock source
+[[nodiscard]] bool isTscReliable() {
+#if defined(__x86_64__) || defined(__i386__)
+    constexpr unsigned int kPowerManagementLeaf{0x80000007U};
+    constexpr unsigned int kInvariantTscBit{1U << 8U};
+    unsigned int eax{0U};
+    unsigned int ebx{0U};
+    unsigned int ecx{0U};
+    unsigned int edx{0U};
+    if (__get_cpuid(kPowerManagementLeaf, &eax, &ebx, &ecx, &edx) == 0 || (edx & kInvariantTscBit) == 0U)
+        return false;
+
+    const auto fd = io::adoptSysFd(
+        ::open("/sys/devices/system/clocksource/clocksource0/current_clocksource", O_RDONLY | O_CLOEXEC));
+    std::array<char, 4U> clock_source{};
+    return fd.has_value() && ::read(fd->fd(), clock_source.data(), clock_source.size()) == 4 &&
+           std::string_view{clock_source.data(), clock_source.size()} == "tsc\n";
+#else
+    return false;
+#endif
+}
+
+/// Takes a time stamp counter reading along with a steady clock one
+[[nodiscard]] std::pair<std::uint64_t, std::uint64_t> readTscAndSteadyClock() noexcept {
+    const auto before = impl::readTsc();
+    const auto ns = impl::nanosecondsOf<std::chrono::steady_clock>(std::chrono::steady_clock::now());
+    const auto after = impl::readTsc();
+    return {before + ((after - before) / 2U), ns};
+}
+
+/// Steady clock nanoseconds per time stamp counter tick between a base reading and now, as stored in channel pages
+[[nodiscard]] std::uint64_t tscScaleSince(std::uint64_t base_ticks, std::uint64_t base_ns) noexcept {
+    const auto [ticks, ns] = readTscAndSteadyClock();
+    if (ticks <= base_ticks || ns <= base_ns)
+        return 0U;
+    return static_cast<std::uint64_t>((impl::WideUint{ns - base_ns} << impl::kTscScaleBits) / (ticks - base_ticks));
+}
+
+/// Steady clock nanoseconds per time stamp counter tick, as estimated over a short calibration on first call; zero
+/// unless the time stamp counter may stand in for the steady clock
+///
+/// @attention The first call sleeps, hence the tower makes it before serving.
+[[nodiscard]] std::uint64_t initialTscScale() {
+    static const auto initial_scale = []() -> std::uint64_t {
+        if (!isTscReliable())
+            return 0U;
+        const auto [base_ticks, base_ns] = readTscAndSteadyClock();
+        std::this_thread::sleep_for(kTscCalibrationTime);
+        return tscScaleSince(base_ticks, base_ns);
+    }();
+    return initial_scale;
+}
+
+/// Sets a channel up to convert time stamp counter ticks to steady clock nanoseconds
+///
+/// Channels start off the tower's initial estimate, which each channel's periodic refinement makes more accurate as
+/// time goes by.
+///
+/// @return Whether the time stamp counter may stand in for the steady clock
+bool calibrateTsc(impl::ChannelPage& channel_page) {
+    const auto initial_scale = initialTscScale();
+    if (initial_scale == 0U)
+        return false;
+
+    std::tie(channel_page.tsc_base_ticks, channel_page.tsc_base_ns) = readTscAndSteadyClock();
+    channel_page.tsc_scale.store(initial_scale, std::memory_order_relaxed);
+    return true;
+}
+
+/// Refines a channel's conversion of time stamp counter ticks, as the span since its base readings grew
+void refineTsc(impl::ChannelPage& channel_page) noexcept {
+    if (const auto scale = tscScaleSince(channel_page.tsc_base_ticks, channel_page.tsc_base_ns); scale != 0U)
+        channel_page.tsc_scale.store(scale, std::memory_order_relaxed);
+}
+
+[[nodiscard]] io::expected<void> tryWatch(const io::Fd& epollfd, const io::Fd& fd) noexcept {
+    ::epoll_event event{.events = EPOLLIN, .data = {.fd = fd.fd()}};
+    return io::sysCheck(::epoll_ctl(epollfd.fd(), EPOLL_CTL_ADD, fd.fd(), &event));
+}
+
+void watch(const io::Fd& epollfd, const io::Fd& fd) { expect(tryWatch(epollfd, fd), "failed to watch descriptor"); }
+
 } // namespace
 
 [[nodiscard]] Tower Tower::create(std::string_view path) {
-    auto sockfd =
-        expect(io::adoptSysFd(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)), "failed to create tower socket");
+    // Our own warnings should not go unseen for lack of a collector.
+    fallBackToStderr();
+
+    auto sockfd = expect(io::adoptSysFd(::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
+                         "failed to create tower socket");
 
     ::sockaddr_un addr{};
     addr.sun_family = AF_UNIX;
@@ -81,90 +426,546 @@ namespace {
     expect(io::sysCheck(::bind(sockfd.fd(), reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr))),
            "failed to bind tower socket");
 
-    constexpr int kListenQueueSize{128};
+    constexpr int kListenQueueSize{1024};
     expect(io::sysCheck(::listen(sockfd.fd(), kListenQueueSize)), "failed to listen to tower socket");
 
-    return Tower{std::move(sockfd)};
+    auto epollfd = expect(io::adoptSysFd(::epoll_create1(EPOLL_CLOEXEC)), "failed to create tower epoll instance");
+    auto shutdownfd =
+        expect(io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)), "failed to create tower shutdown eventfd");
+
+    auto sweepfd = expect(io::adoptSysFd(::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)),
+                          "failed to create tower sweep timer");
+    const ::timespec interval{.tv_sec = kSweepInterval.count(), .tv_nsec = 0};
+    const ::itimerspec timer{.it_interval = interval, .it_value = interval};
+    expect(io::sysCheck(::timerfd_settime(sweepfd.fd(), 0, &timer, nullptr)), "failed to arm tower sweep timer");
+
+    const auto registry_path = registryPathFor(path);
+    io::Fd registryfd;
+    if (auto opened = openRegistry(registry_path); opened.has_value())
+        registryfd = std::move(*opened);
+    else
+        towerLog().log(LogLevel::Warning,
+                       "failed to open channel registry '{}': {}, channels will not survive the tower.", registry_path,
+                       opened.error().message());
+
+    watch(epollfd, sockfd);
+    watch(epollfd, shutdownfd);
+    watch(epollfd, sweepfd);
+
+    Tower tower{std::move(sockfd), std::move(epollfd), std::move(shutdownfd), std::move(sweepfd),
+                std::move(registryfd)};
+    tower.restoreChannels();
+    // Calibrated now rather than on the first channel clocked off the time stamp counter, not to stall serving.
+    static_cast<void>(initialTscScale());
+
+    return tower;
 }
 
 void Tower::run() {
+    constexpr std::size_t kMaxEvents{64U};
+    std::array<::epoll_event, kMaxEvents> events{};
+
     // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
     for (;;) {
-        auto expected_clientfd = io::adoptSysFd(::accept(m_sockfd.fd(), nullptr, nullptr));
+        const auto count = ::epoll_wait(m_epollfd.fd(), events.data(), events.size(), -1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        expect(io::sysCheck(count), "failed to wait for tower events");
+
+        for (const auto& event : std::span{events}.first(static_cast<std::size_t>(count))) {
+            const auto fd = event.data.fd;
+
+            if (fd == m_shutdownfd.fd())
+                return;
+
+            if (fd == m_sockfd.fd()) {
+                accept();
+                continue;
+            }
+
+            if (fd == m_sweepfd.fd()) {
+                std::uint64_t expirations{0U};
+                static_cast<void>(::read(fd, &expirations, sizeof(expirations)));
+                sweep();
+                continue;
+            }
+
+            if (const auto process = m_watched_pids.find(fd); process != m_watched_pids.end()) {
+                // Process descriptors turn readable once the process exits.
+                reclaim(process->second);
+                continue;
+            }
+
+            const auto client = m_clients.find(fd);
+            if (client == m_clients.end())
+                // Dropped earlier within this batch.
+                continue;
+
+            if ((event.events & EPOLLIN) != 0U && serve(client->second))
+                continue;
+
+            // Either hung up, errored, or misbehaved.
+            m_clients.erase(client);
+        }
+    }
+}
+
+void Tower::shutdown() {
+    expect(io::sysCheck(::eventfd_write(m_shutdownfd.fd(), 1U)), "Failed to shutdown tower");
+}
+
+void Tower::accept() {
+    // Drain the whole backlog before serving anyone, so that connecting never
+    // waits on other clients' requests.
+    // NOLINTNEXTLINE(altera-unroll-loops) Service loops should not be unrolled
+    for (;;) {
+        auto expected_clientfd =
+            io::adoptSysFd(::accept4(m_sockfd.fd(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC));
         if (!expected_clientfd.has_value()) {
-            if (expected_clientfd.error() == std::errc::invalid_argument)
-                break;
-            if (expected_clientfd.error() == std::errc::connection_aborted)
+            if (expected_clientfd.error() == std::errc::connection_aborted ||
+                expected_clientfd.error() == std::errc::interrupted)
+                continue;
+            if (expected_clientfd.error() == std::errc::operation_would_block ||
+                expected_clientfd.error() == std::errc::resource_unavailable_try_again)
+                return;
+
+            // Out of descriptors or memory, the backlog would keep the socket readable; pause until the next sweep.
+            towerLog().log(LogLevel::Warning, "failed to accept incoming connection: {}, pausing until the next sweep.",
+                           expected_clientfd.error().message());
+            static_cast<void>(::epoll_ctl(m_epollfd.fd(), EPOLL_CTL_DEL, m_sockfd.fd(), nullptr));
+            m_accepting = false;
+            return;
+        }
+
+        auto clientfd = std::move(*expected_clientfd);
+        if (auto res = tryWatch(m_epollfd, clientfd); !res.has_value()) {
+            towerLog().log(LogLevel::Warning, "failed to watch incoming connection: {}.", res.error().message());
+            continue;
+        }
+
+        const auto pid = peerPid(clientfd);
+        if (pid != 0)
+            watchProcess(pid);
+
+        const auto fd = clientfd.fd();
+        m_clients.insert_or_assign(fd, ClientDescriptor{.sockfd = std::move(clientfd), .pid = pid});
+    }
+}
+
+void Tower::resumeAccepting() {
+    if (m_accepting || !tryWatch(m_epollfd, m_sockfd).has_value())
+        return;
+    towerLog().log(LogLevel::Info, "accepting connections again.");
+    m_accepting = true;
+}
+
+void Tower::restoreChannels() {
+    if (m_registryfd.fd() < 0)
+        return;
+
+    auto* const dir = ::fdopendir(::openat(m_registryfd.fd(), ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (dir == nullptr)
+        return;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the registry size
+    for (const ::dirent* entry{nullptr}; (entry = ::readdir(dir)) != nullptr;) {
+        const auto name = channelNameOf(entry->d_name);
+        if (name.has_value() && adoptPinnedChannel(*name, entry->d_name) != nullptr)
+            towerLog().log(LogLevel::Info, "restored topic '{}' from the registry.", *name);
+    }
+
+    ::closedir(dir);
+
+    // Give back what endpoints gone along with the previous tower held on to.
+    sweep();
+}
+
+Tower::ChannelDescriptor* Tower::adoptPinnedChannel(const std::string& name, const std::string& file_name) {
+    const auto discard = [&](std::string_view reason) {
+        towerLog().log(LogLevel::Warning, "discarding topic '{}' from the registry: {}.", name, reason);
+        static_cast<void>(::unlinkat(m_registryfd.fd(), file_name.c_str(), 0));
+    };
+
+    auto memfd = io::adoptSysFd(::openat(m_registryfd.fd(), file_name.c_str(), O_RDWR | O_CLOEXEC));
+    if (!memfd.has_value()) {
+        if (memfd.error() != std::errc::no_such_file_or_directory)
+            towerLog().log(LogLevel::Warning, "failed to open topic '{}' from the registry: {}.", name,
+                           memfd.error().message());
+        return nullptr;
+    }
+
+    struct ::stat status{};
+    if (::fstat(memfd->fd(), &status) != 0 || !S_ISREG(status.st_mode)) {
+        discard("not a channel");
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+    if (size < sizeof(impl::ChannelPage)) {
+        discard("truncated");
+        return nullptr;
+    }
+
+    auto* const ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd->fd(), 0);
+    if (ptr == MAP_FAILED) { // NOLINT(*-cstyle-cast,performance-no-int-to-ptr)
+        towerLog().log(LogLevel::Warning, "failed to map topic '{}' from the registry: {}.", name,
+                       std::error_code{errno, std::system_category()}.message());
+        return nullptr;
+    }
+
+    auto* const page = static_cast<impl::ChannelPage*>(ptr);
+    if (page->layout_version != impl::kLayoutVersion || page->record_count > impl::ChannelPage::kMaxRecordCount ||
+        impl::ChannelPage::total_size(page->max_payload_size, page->slot_count, page->writer_lanes,
+                                      page->history_depth, page->trace_depth, page->record_count) > size) {
+        static_cast<void>(::munmap(ptr, size));
+        discard("incompatible layout");
+        return nullptr;
+    }
+    if (page->page_backing == PageBacking::TransparentHuge)
+        static_cast<void>(::madvise(ptr, size, MADV_HUGEPAGE));
+
+    // Endpoints opened from now on get woken up along with those opened before, as long as any is left.
+    auto eventfd = recoverEventFd(*page);
+    if (!eventfd.has_value()) {
+        auto created = io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK));
+        if (!created.has_value()) {
+            towerLog().log(LogLevel::Warning, "failed to take over topic '{}' from the registry: {}.", name,
+                           created.error().message());
+            static_cast<void>(::munmap(ptr, size));
+            return nullptr;
+        }
+        eventfd = std::move(*created);
+    }
+
+    auto& channel = m_channels.insert_or_assign(name, ChannelDescriptor{.memfd = std::move(*memfd),
+                                                                        .eventfd = std::move(*eventfd),
+                                                                        .total_size = size,
+                                                                        .page = page,
+                                                                        .pinned = true})
+                        .first->second;
+
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the record count
+    for (std::size_t record{0U}; record < page->record_count; ++record) {
+        if (ownerState(page->stats(record)) == OwnerState::Live)
+            watchProcess(page->stats(record).owner_pid.load(std::memory_order_relaxed));
+    }
+
+    return &channel;
+}
+
+io::expected<void> Tower::pinChannel(std::string_view name, const io::Fd& memfd) const {
+    const auto file_name = registryFileOf(name);
+    if (!file_name.has_value())
+        return io::unexpected{std::make_error_code(std::errc::filename_too_long)};
+
+    const auto link = std::format("/proc/self/fd/{}", memfd.fd());
+    return io::sysCheck(::linkat(AT_FDCWD, link.c_str(), m_registryfd.fd(), file_name->c_str(), AT_SYMLINK_FOLLOW));
+}
+
+void Tower::watchProcess(std::int32_t pid) {
+    if (const auto watched = m_pidfds.find(pid); watched != m_pidfds.end()) {
+        // The process id may belong to a new process already, the one we watched having exited unnoticed so far.
+        ::pollfd pollfd{.fd = watched->second.fd(), .events = POLLIN, .revents = 0};
+        if (::poll(&pollfd, 1U, 0) == 0)
+            return;
+        reclaim(pid);
+    }
+
+    // Process descriptors require Linux 5.3, short of which dead processes are left for the sweep to find.
+    auto pidfd = io::adoptSysFd(static_cast<int>(::syscall(SYS_pidfd_open, pid, 0U)));
+    if (!pidfd.has_value()) {
+        towerLog().log(LogLevel::Warning, "failed to watch process {}: {}.", pid, pidfd.error().message());
+        return;
+    }
+
+    watch(m_epollfd, *pidfd);
+    m_watched_pids.emplace(pidfd->fd(), pid);
+    m_pidfds.emplace(pid, std::move(*pidfd));
+}
+
+void Tower::reclaim(std::int32_t pid) {
+    for (auto& [name, channel] : m_channels) {
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the record count
+        for (std::size_t record{0U}; record < channel.page->record_count; ++record) {
+            // Process ids of other namespaces may match that of an unrelated process of ours.
+            const auto& stats = channel.page->stats(record);
+            if (stats.owner_pid.load(std::memory_order_acquire) != pid ||
+                stats.owner_pid_namespace.load(std::memory_order_relaxed) != pidNamespace())
                 continue;
+
+            towerLog().log(LogLevel::Info, "reclaiming the endpoint of exited process {} on topic '{}'.", pid, name);
+            impl::releaseRecord(*channel.page, record);
         }
+    }
 
-        auto clientfd = expect(std::move(expected_clientfd), "failed to accept incoming connection");
-        serve(std::move(clientfd));
+    if (const auto watched = m_pidfds.find(pid); watched != m_pidfds.end()) {
+        m_watched_pids.erase(watched->second.fd());
+        m_pidfds.erase(watched);
     }
+
+    freeUnusedChannels();
 }
 
-void Tower::shutdown() { expect(io::sysCheck(::shutdown(m_sockfd.fd(), SHUT_RD)), "Failed to shutdown tower socket"); }
+void Tower::sweep() {
+    resumeAccepting();
 
-void Tower::serve(io::Fd clientfd) {
-    std::array<std::byte, 128u> buf{}; // NOLINT(*-magic-numbers)
-    const auto bytes_read =
-        expect(io::sysVal(::read(clientfd.fd(), buf.data(), buf.size())), "failed to read from client");
+    for (auto& [name, channel] : m_channels) {
+        if (channel.page->clock == ChannelClock::Tsc)
+            refineTsc(*channel.page);
+
+        // NOLINTNEXTLINE(altera-unroll-loops) Bounded by the record count
+        for (std::size_t record{0U}; record < channel.page->record_count; ++record) {
+            const auto& stats = channel.page->stats(record);
+            if (ownerState(stats) != OwnerState::Gone)
+                continue;
+
+            const auto pid = stats.owner_pid.load(std::memory_order_relaxed);
+            towerLog().log(LogLevel::Info, "reclaiming the endpoint of dead process {} on topic '{}'.", pid, name);
+            impl::releaseRecord(*channel.page, record);
+        }
+    }
+
+    freeUnusedChannels();
+}
+
+void Tower::freeUnusedChannels() {
+    std::erase_if(m_channels, [&](const auto& entry) {
+        const auto& [name, channel] = entry;
+        if (!impl::isUnused(*channel.page))
+            return false;
+
+        // Directly attached endpoints share-lock the pinned file from before claiming a record until after giving it
+        // back, and check it is still pinned once they hold the lock.
+        if (channel.pinned && ::flock(channel.memfd.fd(), LOCK_EX | LOCK_NB) != 0)
+            return false;
+
+        towerLog().log(LogLevel::Info, "freeing unused topic '{}'.", name);
+        if (const auto file_name = registryFileOf(name); channel.pinned && file_name.has_value())
+            static_cast<void>(::unlinkat(m_registryfd.fd(), file_name->c_str(), 0));
+        // Clients may hold on to the descriptor, hence to the lock, for a while.
+        if (channel.pinned)
+            static_cast<void>(::flock(channel.memfd.fd(), LOCK_UN));
+        static_cast<void>(::munmap(channel.page, channel.total_size));
+        return true;
+    });
+}
+
+bool Tower::serve(ClientDescriptor& client) {
+    std::array<std::byte, kMaxClientMessageSize> buf{};
+    const auto bytes_read = ::recv(client.sockfd.fd(), buf.data(), buf.size(), 0);
+    if (bytes_read < 0)
+        return errno == EAGAIN || errno == EINTR;
+    if (bytes_read == 0)
+        // Orderly hang-up
+        return false;
 
     auto recvbuf = std::span<const std::byte>{buf.data(), static_cast<std::size_t>(bytes_read)};
-    const auto request = readClientRequest(recvbuf);
+    const auto message = readClientMessage(recvbuf);
+    if (!message.has_value()) {
+        towerLog().log(LogLevel::Warning, "dropping client sending a malformed request.");
+        return false;
+    }
 
-    std::println("{} request for topic '{}' with max payload size of {} bytes.",
-                 (request.type == RequesterType::Reader ? "reader" : "writer"), request.topic_name,
-                 request.max_payload_size);
+    if (message->protocol_version > kProtocolVersion ||
+        (message->protocol_version == 0U && message->requests.empty())) {
+        towerLog().log(LogLevel::Warning, "rejecting client with protocol version {}, supporting up to {}.",
+                       message->protocol_version, kProtocolVersion);
 
-    const auto topic_name = std::string{request.topic_name};
-    auto& channel = m_channels[topic_name];
+        const auto protocol_rejection = rejection(ReplyStatus::ProtocolMismatch);
+        return reply(client.sockfd, {&protocol_rejection, 1U}, {}).has_value();
+    }
+
+    if (message->kind == MessageKind::Inspect)
+        return inspect(client, message->inspect_after);
 
-    if (channel.page == nullptr) {
-        channel.memfd =
-            expect(io::adoptSysFd(::memfd_create(topic_name.c_str(), MFD_CLOEXEC)), "failed to create memfd");
+    std::array<TowerReply, kMaxBatchSize> replies{};
+    std::array<int, kMaxBatchSize * kFdsPerChannel> fds{};
+    std::size_t fd_count{0U};
+    const bool notify_only = message->kind == MessageKind::Notify;
 
-        channel.total_size = impl::ChannelPage::total_size(request.max_payload_size);
+    const auto request_count = message->requests.size();
+    // NOLINTNEXTLINE(altera-unroll-loops) Bounded by kMaxBatchSize
+    for (std::size_t i{0U}; i < request_count; ++i) {
+        const auto& request = message->requests[i];
+        auto& request_reply = replies[i];
 
-        // NOLINTNEXTLINE(*-narrowing-conversions)
-        expect(io::sysCheck(::ftruncate(channel.memfd.fd(), channel.total_size)), "failed to truncate channel memory");
+        towerLog().log(LogLevel::Debug, "{} {} request for topic '{}' with max payload size of {} bytes and {} slots.",
+                       kindName(request.kind), roleName(request.kind, request.type), request.topic_name,
+                       request.max_payload_size, request.slot_count);
 
-        // NOLINTNEXTLINE(misc-const-correctness) placement-new requires non-const pointee type
-        void* const ptr = expect(
-            io::sysVal(::mmap(nullptr, channel.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, channel.memfd.fd(), 0)),
-            "failed to mmap channel memory");
+        if (request.layout_version != impl::kLayoutVersion) {
+            towerLog().log(LogLevel::Warning,
+                           "rejecting request for topic '{}' with channel layout version {}, expected {}.",
+                           request.topic_name, request.layout_version, impl::kLayoutVersion);
 
-        channel.page = ::new (ptr) impl::ChannelPage;
-        channel.page->max_payload_size = request.max_payload_size;
-        // Weakly-reserve the first sample as default latest
-        channel.page->next_seq_id.store(1U, std::memory_order_relaxed);
-        channel.page->occupancy.store(1U << 0U, std::memory_order_relaxed);
+            request_reply = rejection(ReplyStatus::LayoutMismatch);
+            continue;
+        }
+
+        auto opened = openChannel(request);
+        if (!opened.has_value()) {
+            towerLog().log(LogLevel::Warning, "rejecting request for topic '{}', failed to create it: {}.",
+                           request.topic_name, opened.error().message());
+
+            request_reply = rejection(ReplyStatus::ResourceExhausted);
+            continue;
+        }
+        auto& channel = **opened;
+
+        if (channel.page->kind != request.kind) {
+            towerLog().log(LogLevel::Warning, "rejecting {} request for topic '{}', which is a {}.",
+                           kindName(request.kind), request.topic_name, kindName(channel.page->kind));
 
-        // NOLINTNEXTLINE(altera-unroll-loops) This shouldn't be unrolled as much as optimized away
-        for (std::size_t i{0U}; i < std::numeric_limits<std::uint64_t>::digits; ++i) {
-            ::new (channel.page->samples_storage + (i * (sizeof(impl::ChannelSample) + request.max_payload_size)))
-                impl::ChannelSample;
+            request_reply = rejection(ReplyStatus::KindMismatch);
+            continue;
         }
+
+        if (channel.page->max_payload_size != request.max_payload_size) {
+            towerLog().log(LogLevel::Warning,
+                           "rejecting request for topic '{}' with max payload size of {} bytes, channel has {} bytes.",
+                           request.topic_name, request.max_payload_size, channel.page->max_payload_size);
+
+            request_reply = rejection(ReplyStatus::PayloadSizeMismatch);
+            continue;
+        }
+
+        if (notify_only) {
+            request_reply = {.status = ReplyStatus::Ok,
+                             .record = impl::ChannelPage::kNoRecord,
+                             .total_size = channel.total_size};
+            fds[fd_count++] = channel.eventfd.fd();
+            continue;
+        }
+
+        // Channels opened by readers first get bound once a writer asks for a node.
+        if (const auto bound = impl::bindChannel(*channel.page, channel.total_size, request.numa_node);
+            bound.has_value() && *bound)
+            towerLog().log(LogLevel::Info, "bound topic '{}' to NUMA node {}.", request.topic_name, request.numa_node);
+        else if (!bound.has_value())
+            towerLog().log(LogLevel::Warning, "failed to bind topic '{}' to NUMA node {}: {}.", request.topic_name,
+                           request.numa_node, bound.error().message());
+
+        request_reply = {.status = ReplyStatus::Ok,
+                         .record = impl::claimRecord(*channel.page, client.pid, pidNamespace(), request.type),
+                         .total_size = channel.total_size};
+        fds[fd_count++] = channel.memfd.fd();
+        fds[fd_count++] = channel.eventfd.fd();
     }
 
-    ::msghdr msg{};
+    return reply(client.sockfd, std::span{replies}.first(request_count), std::span{fds}.first(fd_count))
+        .has_value();
+}
 
-    ::iovec iov{.iov_base = static_cast<void*>(&channel.total_size), .iov_len = sizeof(channel.total_size)};
-    msg.msg_iov = &iov;
-    msg.msg_iovlen = 1;
+bool Tower::inspect(ClientDescriptor& client, std::string_view after) {
+    std::vector<const decltype(m_channels)::value_type*> channels;
+    channels.reserve(m_channels.size());
+    // NOLINTNEXTLINE(altera-unroll-loops) Inspections are rare
+    for (const auto& entry : m_channels) {
+        if (entry.first > after)
+            channels.push_back(&entry);
+    }
+    std::ranges::sort(channels, {}, [](const auto* entry) -> const std::string& { return entry->first; });
 
-    alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(channel.memfd))> ctrl{};
-    msg.msg_control = ctrl.data();
-    msg.msg_controllen = ctrl.size();
+    std::vector<ChannelSnapshot> snapshots;
+    snapshots.reserve(channels.size());
+    // NOLINTNEXTLINE(altera-unroll-loops) Inspections are rare
+    for (const auto* const entry : channels)
+        snapshots.push_back(snapshotChannel(entry->first, *entry->second.page));
 
-    auto* const cmsg = CMSG_FIRSTHDR(&msg);
-    cmsg->cmsg_level = SOL_SOCKET; // NOLINT(misc-include-cleaner) false-positive
-    cmsg->cmsg_type = SCM_RIGHTS;
-    cmsg->cmsg_len = CMSG_LEN(sizeof(channel.memfd.fd()));
-    std::memcpy(CMSG_DATA(cmsg), &channel.memfd.fd(), sizeof(channel.memfd));
-    msg.msg_controllen = cmsg->cmsg_len;
+    const auto buf = writeChannelSnapshots(snapshots, kMaxInspectReplySize);
+    return io::sysCheck(::send(client.sockfd.fd(), buf.data(), buf.size(), MSG_NOSIGNAL)).has_value();
+}
+
+io::expected<Tower::ChannelDescriptor*> Tower::openChannel(const ClientRequest& request) {
+    const auto topic_name = std::string{request.topic_name};
+    const auto file_name = registryFileOf(topic_name);
+
+    // A channel pinned behind our back gets taken over on the next attempt, unless it cannot be mapped.
+    constexpr int kMaxAttempts{3};
+    // NOLINTNEXTLINE(altera-unroll-loops) Only retried on races with directly attached endpoints
+    for (int attempt{0}; attempt < kMaxAttempts; ++attempt) {
+        if (const auto it = m_channels.find(topic_name); it != m_channels.end())
+            return &it->second;
+
+        // Directly attached endpoints may have created the channel behind our back.
+        if (m_registryfd.fd() >= 0 && file_name.has_value()) {
+            if (auto* const channel = adoptPinnedChannel(topic_name, *file_name); channel != nullptr) {
+                towerLog().log(LogLevel::Info, "took over topic '{}' from the registry.", topic_name);
+                return channel;
+            }
+        }
+
+        auto channel = createChannel(request);
+        if (!channel.has_value() || *channel != nullptr)
+            return channel;
+    }
+    return io::unexpected{std::make_error_code(std::errc::resource_unavailable_try_again)};
+}
+
+io::expected<Tower::ChannelDescriptor*> Tower::createChannel(const ClientRequest& request) {
+    const auto topic_name = std::string{request.topic_name};
+    const auto page_size = impl::pageSizeFor(request);
+    if (page_size > impl::kMaxChannelSize)
+        return io::unexpected{std::make_error_code(std::errc::file_too_large)};
+
+    // Taken first, so that running out of descriptors fails before anything gets pinned.
+    auto eventfd = io::adoptSysFd(::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK));
+    if (!eventfd.has_value())
+        return io::unexpected{eventfd.error()};
+
+    auto memory = createChannelMemory(topic_name, page_size, request.page_backing, m_registryfd);
+    if (!memory.has_value() && request.page_backing != PageBacking::Default) {
+        towerLog().log(LogLevel::Warning,
+                       "failed to back topic '{}' with huge pages: {}, falling back to regular pages.", topic_name,
+                       memory.error().message());
+        memory = createChannelMemory(topic_name, page_size, PageBacking::Default, m_registryfd);
+    }
+    if (!memory.has_value())
+        return io::unexpected{memory.error()};
+    auto [memfd, mapped_size, ptr, backing] = std::move(*memory);
+
+    // Bound ahead of initialization, the pages get allocated on the node to begin with.
+    auto numa_node = kNoNumaNode;
+    if (request.numa_node != kNoNumaNode) {
+        if (auto res = io::preferNumaNode(ptr, mapped_size, request.numa_node); res.has_value())
+            numa_node = request.numa_node;
+        else
+            towerLog().log(LogLevel::Warning, "failed to bind topic '{}' to NUMA node {}: {}.", topic_name,
+                           request.numa_node, res.error().message());
+    }
+
+    auto& channel_page = impl::initChannelPage(ptr, request, backing);
+    channel_page.numa_node.store(numa_node, std::memory_order_relaxed);
+    if (request.clock == ChannelClock::Tsc && !calibrateTsc(channel_page)) {
+        towerLog().log(LogLevel::Warning,
+                       "time stamp counter unfit as the clock of topic '{}', falling back to the steady clock.",
+                       topic_name);
+        channel_page.clock = ChannelClock::Steady;
+    }
+
+    // Only pin channels once set up, so that a restarted tower never comes across one half-way.
+    bool pinned{false};
+    if (m_registryfd.fd() >= 0 && backing != PageBacking::HugeTlb) {
+        auto res = pinChannel(topic_name, memfd);
+        if (!res.has_value() && res.error() == std::errc::file_exists) {
+            // Whoever won the race already has endpoints on their channel.
+            static_cast<void>(::munmap(ptr, mapped_size));
+            return nullptr;
+        }
+        if (!res.has_value())
+            towerLog().log(LogLevel::Warning, "failed to pin topic '{}': {}.", topic_name, res.error().message());
+        pinned = res.has_value();
+    } else {
+        towerLog().log(LogLevel::Info, "topic '{}' is not pinned, hence will not survive the tower.", topic_name);
+    }
 
-    static_cast<void>(expect(io::sysVal(::sendmsg(clientfd.fd(), &msg, 0)), "failed to send reply to client"));
+    return &m_channels
+                .insert_or_assign(topic_name, ChannelDescriptor{.memfd = std::move(memfd),
+                                                                .eventfd = std::move(*eventfd),
+                                                                .total_size = mapped_size,
+                                                                .page = &channel_page,
+                                                                .pinned = pinned})
+                .first->second;
 }
 
 } // namespace fastipc
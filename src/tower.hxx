@@ -18,12 +18,17 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <utility>
 
 #include <unordered_map>
 
 #include "io/fd.hxx"
 #include "channel.hxx"
+#include "local_proto.hxx"
 
 namespace fastipc {
 
@@ -38,17 +43,89 @@ class Tower final {
   private:
     // NOLINTNEXTLINE(altera-struct-pack-align)
     struct ChannelDescriptor final {
+        // Anonymous, or pinned in the registry
         io::Fd memfd;
+        io::Fd eventfd;
         std::size_t total_size{0U};
         impl::ChannelPage* page{nullptr};
+        bool pinned{false};
     };
 
-    explicit Tower(io::Fd sockfd) noexcept : m_sockfd{std::move(sockfd)} {}
+    // NOLINTNEXTLINE(altera-struct-pack-align)
+    struct ClientDescriptor final {
+        io::Fd sockfd;
+        // Process on the other end, zero if unknown
+        std::int32_t pid{0};
+    };
+
+    /// Period at which channels get checked for dead endpoints and for being unused
+    constexpr static std::chrono::seconds kSweepInterval{1};
+
+    explicit Tower(io::Fd sockfd, io::Fd epollfd, io::Fd shutdownfd, io::Fd sweepfd, io::Fd registryfd) noexcept
+        : m_sockfd{std::move(sockfd)}, m_epollfd{std::move(epollfd)}, m_shutdownfd{std::move(shutdownfd)},
+          m_sweepfd{std::move(sweepfd)}, m_registryfd{std::move(registryfd)} {}
+
+    /// Takes over the channels pinned in the registry by a previous tower or directly attached endpoints, dropping
+    /// those nobody uses anymore
+    void restoreChannels();
+
+    /// Takes over a channel pinned in the registry, discarding the file if it holds no usable channel
+    ///
+    /// @return The channel, or null if none is pinned in that file
+    [[nodiscard]] ChannelDescriptor* adoptPinnedChannel(const std::string& name, const std::string& file_name);
+
+    /// Pins a channel in the registry, so that it survives the tower
+    [[nodiscard]] io::expected<void> pinChannel(std::string_view name, const io::Fd& memfd) const;
+
+    /// Accepts all pending connections
+    void accept();
+
+    /// Watches a client process for exiting, unless already watched
+    void watchProcess(std::int32_t pid);
+
+    /// Gives back whatever the endpoints of an exited process held on to, and stops watching it
+    void reclaim(std::int32_t pid);
+
+    /// Reclaims the records of processes gone unnoticed, then frees the channels nobody uses anymore
+    void sweep();
+
+    /// Unmaps and forgets about the channels no endpoint has open
+    void freeUnusedChannels();
+
+    /// Handles a client's pending request
+    ///
+    /// @return Whether to keep the client connected
+    [[nodiscard]] bool serve(ClientDescriptor& client);
+
+    /// Replies to an inspection request with snapshots of the channels sorting after the given name, as many as fit
+    ///
+    /// @return Whether to keep the client connected
+    [[nodiscard]] bool inspect(ClientDescriptor& client, std::string_view after);
+
+    /// Looks up the requested channel, taking it over from the registry or creating it if needed
+    [[nodiscard]] io::expected<ChannelDescriptor*> openChannel(const ClientRequest& request);
+
+    /// Creates the requested channel and pins it if possible
+    ///
+    /// @return The channel, or null if a directly attached endpoint pinned one of the same name first
+    [[nodiscard]] io::expected<ChannelDescriptor*> createChannel(const ClientRequest& request);
 
-    void serve(io::Fd clientfd);
+    /// Watches the tower socket for connections again, if accepting them got paused
+    void resumeAccepting();
 
     io::Fd m_sockfd;
+    io::Fd m_epollfd;
+    io::Fd m_shutdownfd;
+    io::Fd m_sweepfd;
+    // Directory pinning the channels, invalid if there is none
+    io::Fd m_registryfd;
+    std::unordered_map<int, ClientDescriptor> m_clients;
+    // Process descriptors of the client processes, by process id and the other way around
+    std::unordered_map<std::int32_t, io::Fd> m_pidfds;
+    std::unordered_map<int, std::int32_t> m_watched_pids;
     std::unordered_map<std::string, ChannelDescriptor> m_channels;
+    // Whether the tower socket is watched, which stops while out of descriptors
+    bool m_accepting{true};
 };
 
 } // namespace fastipc
@@ -0,0 +1,134 @@
+/*
+ *  bounded_prepare.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+[[nodiscard]] std::chrono::nanoseconds threadCpuTime() noexcept {
+    ::timespec ts{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+} // namespace
+
+int main() {
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::size_t max_payload_size{sizeof(int)};
+
+    // Exhaust a tiny channel and check that the bounded variants give up.
+    {
+        constexpr std::string_view channel_name{"Full house"};
+        fastipc::Writer writer{channel_name, max_payload_size, {.slot_count = 3U}};
+        fastipc::Reader reader{channel_name, max_payload_size};
+
+        const auto first = reader.acquire();
+
+        auto sample = writer.tryPrepare();
+        assert(sample.has_value());
+        writer.submit(*sample);
+        const auto second = reader.acquire();
+
+        const auto pending = writer.tryPrepare();
+        assert(pending.has_value());
+
+        assert(!writer.tryPrepare().has_value());
+
+        const auto start = std::chrono::steady_clock::now();
+        assert(!writer.prepareFor(start + 1ms).has_value());
+        assert(std::chrono::steady_clock::now() - start >= 1ms);
+
+        reader.release(first);
+        sample = writer.tryPrepare();
+        assert(sample.has_value());
+
+        writer.submit(*pending);
+        writer.submit(*sample);
+        reader.release(second);
+    }
+
+    // Have readers constantly hold on to samples while a writer with a spare
+    // slot keeps publishing, which must never find the channel full.
+    {
+        constexpr std::string_view channel_name{"Hold fast"};
+        constexpr std::size_t kReaderCount{4U};
+        constexpr std::size_t kIterations{10000U}; // NOLINT(*-magic-numbers)
+
+        // Each reader holds up to two samples while swapping, plus the latest, the spare and the prepared one.
+        fastipc::Writer writer{channel_name, max_payload_size,
+                               {.slot_count = (2U * kReaderCount) + 3U, .reserve_spare_slot = true}};
+
+        std::atomic_bool running{true};
+        std::vector<std::jthread> reader_threads;
+        reader_threads.reserve(kReaderCount);
+        for (std::size_t i{0U}; i < kReaderCount; ++i) {
+            reader_threads.emplace_back([&] {
+                fastipc::Reader reader{channel_name, max_payload_size};
+                auto held = reader.acquire();
+                while (running.load(std::memory_order_relaxed)) {
+                    const auto next = reader.acquire();
+                    reader.release(held);
+                    held = next;
+                }
+                reader.release(held);
+            });
+        }
+
+        std::vector<std::chrono::nanoseconds> cpu_times;
+        cpu_times.reserve(kIterations);
+        for (std::size_t i{0U}; i < kIterations; ++i) {
+            const auto start = threadCpuTime();
+            auto sample = writer.tryPrepare();
+            cpu_times.push_back(threadCpuTime() - start);
+
+            assert(sample.has_value());
+            *static_cast<int*>(sample->getPayload()) = static_cast<int>(i);
+            writer.submit(*sample);
+        }
+
+        running.store(false, std::memory_order_relaxed);
+        reader_threads.clear();
+
+        std::ranges::sort(cpu_times);
+        const auto percentile = [&](std::size_t p) { return cpu_times[(cpu_times.size() - 1U) * p / 100U]; };
+        // NOLINTNEXTLINE(*-magic-numbers)
+        std::println("prepare cpu time: p50 {}ns, p99 {}ns, max {}ns", percentile(50U).count(), percentile(99U).count(),
+                     cpu_times.back().count());
+        assert(cpu_times.back() < 1ms);
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,213 @@
+/*
+ *  bridge.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "bridge.hxx"
+#include "fastipc.hxx"
+#include "io/addr.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::string_view kRemoteTowerPath{"fastipcd-remote"};
+
+/// Waits for the latest sample of a reader to hold the given value, as its first bytes
+[[nodiscard]] bool waitForValue(const fastipc::Reader& reader, std::uint64_t value) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    // NOLINTNEXTLINE(altera-unroll-loops) Polled until the deadline
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::uint64_t latest{0U};
+        if (reader.readLatest(&latest, sizeof(latest)) != 0U && latest == value)
+            return true;
+        std::this_thread::sleep_for(1ms);
+    }
+    return false;
+}
+
+/// Mirrors channels from the local tower into the remote one, checking that the newest samples make it across
+void checkBridge(fastipc::BridgeTransport transport, std::string_view prefix, std::size_t large_payload_size) {
+    const std::string small_name = std::string{prefix} + "/small";
+    const std::string other_name = std::string{prefix} + "/other";
+    const std::string large_name = std::string{prefix} + "/large";
+    const std::string unlisted_name = std::string{prefix} + "/unlisted";
+    const std::string clashing_name = std::string{prefix} + "/clashing";
+    std::vector<fastipc::BridgedChannel> received_channels{{small_name, sizeof(std::uint64_t)},
+                                                           {other_name, sizeof(std::uint64_t)},
+                                                           {large_name, large_payload_size},
+                                                           {clashing_name, sizeof(std::uint64_t)}};
+    std::vector<fastipc::BridgedChannel> sent_channels{received_channels};
+    sent_channels.push_back({unlisted_name, sizeof(std::uint64_t)});
+
+    fastipc::Writer small{small_name, sizeof(std::uint64_t)};
+    fastipc::Writer other{other_name, sizeof(std::uint64_t)};
+    fastipc::Writer large{large_name, large_payload_size};
+    fastipc::Writer unlisted{unlisted_name, sizeof(std::uint64_t)};
+    fastipc::Writer clashing{clashing_name, sizeof(std::uint64_t)};
+
+    // The remote tower knows the clashing channel with another payload size already.
+    fastipc::Session remote{kRemoteTowerPath};
+    auto unlisted_mirror = remote.openReader(unlisted_name, sizeof(std::uint64_t));
+    auto clashing_mirror = remote.openReader(clashing_name, 2U * sizeof(std::uint64_t));
+
+    const fastipc::io::SocketAddr loopback =
+        fastipc::io::SocketAddrV4{.addr = fastipc::io::Ipv4Addr::from({127U, 0U, 0U, 1U}), .port = 0U};
+    auto receiver = fastipc::BridgeReceiver::create(kRemoteTowerPath, received_channels, loopback, transport);
+    const auto address = receiver.getAddress();
+    assert(std::get<fastipc::io::SocketAddrV4>(address).port != 0U);
+    auto sender = fastipc::BridgeSender::create("fastipcd", sent_channels, address, transport);
+
+    std::jthread receiver_thread{[&] { receiver.run(); }};
+    std::jthread sender_thread{[&] { sender.run(); }};
+
+    // Samples of channels the receiver was not given, or which its tower rejects, get dropped.
+    for (auto* const writer : {&unlisted, &clashing}) {
+        auto sample = writer->prepare();
+        *static_cast<std::uint64_t*>(sample.getPayload()) = 1U;
+        writer->submit(sample);
+    }
+
+    // Small channels share frames, and only their newest samples are bound to make it across.
+    constexpr std::uint64_t kSampleCount{2000U};
+    for (std::uint64_t i{1U}; i <= kSampleCount; ++i) {
+        auto sample = small.prepare();
+        *static_cast<std::uint64_t*>(sample.getPayload()) = i;
+        small.submit(sample);
+        if (i % 2U == 0U) {
+            auto other_sample = other.prepare();
+            *static_cast<std::uint64_t*>(other_sample.getPayload()) = i;
+            other.submit(other_sample);
+        }
+    }
+
+    auto small_mirror = remote.openReader(small_name, sizeof(std::uint64_t));
+    auto other_mirror = remote.openReader(other_name, sizeof(std::uint64_t));
+    assert(waitForValue(small_mirror, kSampleCount));
+    assert(waitForValue(other_mirror, kSampleCount));
+    assert(!unlisted_mirror.hasNewData(0U));
+    assert(!clashing_mirror.hasNewData(0U));
+
+    // Payloads keep their submitted size.
+    {
+        auto sample = large.prepare();
+        auto* const payload = static_cast<std::uint8_t*>(sample.getPayload());
+        for (std::size_t i{0U}; i < large_payload_size; ++i)
+            payload[i] = static_cast<std::uint8_t>(i * 7U); // NOLINT(*-magic-numbers)
+        *reinterpret_cast<std::uint64_t*>(payload) = 1U;
+        large.submit(sample, large_payload_size - 1U);
+    }
+    auto large_mirror = remote.openReader(large_name, large_payload_size);
+    assert(waitForValue(large_mirror, 1U));
+    const auto mirrored = large_mirror.acquire();
+    assert(mirrored.getSize() == large_payload_size - 1U);
+    const auto* const payload = static_cast<const std::uint8_t*>(mirrored.getPayload());
+    for (std::size_t i{sizeof(std::uint64_t)}; i < large_payload_size - 1U; ++i)
+        assert(payload[i] == static_cast<std::uint8_t>(i * 7U)); // NOLINT(*-magic-numbers)
+    large_mirror.release(mirrored);
+
+    sender.shutdown();
+    receiver.shutdown();
+}
+
+/// Restarts the receiver behind a TCP link, checking that samples lost along with the link make it across once back
+void checkReconnect() {
+    const std::string quiet_name{"reconnect/quiet"};
+    const std::string busy_name{"reconnect/busy"};
+    const std::vector<fastipc::BridgedChannel> channels{{quiet_name, sizeof(std::uint64_t)},
+                                                        {busy_name, sizeof(std::uint64_t)}};
+
+    fastipc::Writer quiet{quiet_name, sizeof(std::uint64_t)};
+    fastipc::Writer busy{busy_name, sizeof(std::uint64_t)};
+    const auto publish = [](fastipc::Writer& writer, std::uint64_t value) {
+        auto sample = writer.prepare();
+        *static_cast<std::uint64_t*>(sample.getPayload()) = value;
+        writer.submit(sample);
+    };
+
+    fastipc::Session remote{kRemoteTowerPath};
+    auto quiet_mirror = remote.openReader(quiet_name, sizeof(std::uint64_t));
+
+    fastipc::io::SocketAddr address =
+        fastipc::io::SocketAddrV4{.addr = fastipc::io::Ipv4Addr::from({127U, 0U, 0U, 1U}), .port = 0U};
+    std::optional<fastipc::BridgeSender> sender;
+    std::jthread sender_thread;
+    {
+        auto receiver =
+            fastipc::BridgeReceiver::create(kRemoteTowerPath, channels, address, fastipc::BridgeTransport::Tcp);
+        address = receiver.getAddress();
+        std::jthread receiver_thread{[&] { receiver.run(); }};
+        sender = fastipc::BridgeSender::create("fastipcd", channels, address, fastipc::BridgeTransport::Tcp);
+        sender_thread = std::jthread{[&] { sender->run(); }};
+
+        publish(quiet, 1U);
+        assert(waitForValue(quiet_mirror, 1U));
+        receiver.shutdown();
+    }
+
+    // The first frame sent over the broken link is lost, the next ones tell the sender it is broken.
+    publish(quiet, 2U);
+    // NOLINTNEXTLINE(altera-unroll-loops) Test setup
+    for (std::uint64_t i{1U}; i <= 10U; ++i) { // NOLINT(*-magic-numbers)
+        std::this_thread::sleep_for(20ms);
+        publish(busy, i);
+    }
+
+    auto receiver = fastipc::BridgeReceiver::create(kRemoteTowerPath, channels, address, fastipc::BridgeTransport::Tcp);
+    std::jthread receiver_thread{[&] { receiver.run(); }};
+    assert(waitForValue(quiet_mirror, 2U));
+
+    sender->shutdown();
+    sender_thread.join();
+    receiver.shutdown();
+}
+
+} // namespace
+
+int main() {
+    auto local_tower = fastipc::Tower::create("fastipcd");
+    auto remote_tower = fastipc::Tower::create(kRemoteTowerPath);
+    const std::jthread local_thread{[&] { local_tower.run(); }};
+    const std::jthread remote_thread{[&] { remote_tower.run(); }};
+
+    checkBridge(fastipc::BridgeTransport::Udp, "udp", 60000U);   // NOLINT(*-magic-numbers)
+    checkBridge(fastipc::BridgeTransport::Tcp, "tcp", 1U << 20U); // NOLINT(*-magic-numbers)
+    checkReconnect();
+
+    // Addresses parse from and format to their usual notation.
+    const auto v4 = fastipc::io::parseSocketAddr("192.168.1.2:7000");
+    assert(v4.has_value() && std::format("{}", *v4) == "192.168.1.2:7000");
+    const auto v6 = fastipc::io::parseSocketAddr("[::1]:7000");
+    assert(v6.has_value() && std::format("{}", *v6) == "[::1]:7000");
+    assert(!fastipc::io::parseSocketAddr("localhost:7000").has_value());
+    assert(!fastipc::io::parseSocketAddr("127.0.0.1").has_value());
+
+    local_tower.shutdown();
+    remote_tower.shutdown();
+}
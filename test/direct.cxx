@@ -0,0 +1,236 @@
+/*
+ *  direct.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "registry.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::string_view kChannelName{"Direct are the mailboxes"};
+constexpr std::string_view kRacedName{"Raced are the mailboxes"};
+constexpr std::string_view kTowerFirstName{"Towered are the mailboxes"};
+constexpr std::string_view kDirectFirstName{"Attached are the mailboxes"};
+constexpr std::string_view kQueueName{"Direct are the queues"};
+constexpr std::string_view kForkedName{"Forked are the mailboxes"};
+
+constexpr fastipc::ChannelOptions kDirect{.direct_attach = true};
+
+void publish(fastipc::Writer& writer, int value) {
+    auto sample = writer.prepare();
+    *static_cast<int*>(sample.getPayload()) = value;
+    writer.submit(sample);
+}
+
+[[nodiscard]] int latest(const fastipc::Reader& reader) {
+    int value{0};
+    static_cast<void>(reader.readLatest(&value, sizeof(value)));
+    return value;
+}
+
+[[nodiscard]] bool isReady(int fd) {
+    ::pollfd pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    return ::poll(&pollfd, 1U, 5000) == 1; // NOLINT(*-magic-numbers)
+}
+
+[[nodiscard]] bool isPinned(std::string_view name) {
+    const auto path = fastipc::registryPathFor("fastipcd") + "/" + *fastipc::registryFileOf(name);
+    return ::access(path.c_str(), F_OK) == 0;
+}
+
+} // namespace
+
+int main() {
+    // Records left behind are only trusted while their owner's start time matches, which is gone along with it.
+    {
+        assert(fastipc::processStartTime(::getpid()).value_or(0U) != 0U);
+        const auto child = ::fork();
+        if (child == 0)
+            ::_exit(0);
+        [[maybe_unused]] int status{0};
+        ::waitpid(child, &status, 0);
+        assert(!fastipc::processStartTime(child).has_value());
+
+        fastipc::impl::EndpointStats stats{};
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Free);
+        stats.owner_pid.store(::getpid());
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Foreign);
+        stats.owner_pid_namespace.store(fastipc::pidNamespace() + 1U);
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Foreign);
+        assert(fastipc::pidNamespace() != 0U);
+        stats.owner_pid_namespace.store(fastipc::pidNamespace());
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Live);
+        stats.owner_start_time.store(*fastipc::processStartTime(::getpid()));
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Live);
+        stats.owner_start_time.store(stats.owner_start_time.load() + 1U);
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Gone);
+        stats.owner_pid.store(child);
+        assert(fastipc::ownerState(stats) == fastipc::OwnerState::Gone);
+    }
+
+    // No tower is needed to attach directly.
+    {
+        fastipc::Writer writer{kChannelName, sizeof(int), kDirect};
+        fastipc::Reader reader{kChannelName, sizeof(int), kDirect};
+        assert(isPinned(kChannelName));
+
+        reader.armNotifications();
+        publish(writer, 1);
+        ::pollfd pollfd{.fd = reader.getNotificationFd(), .events = POLLIN, .revents = 0};
+        [[maybe_unused]] const auto ready = ::poll(&pollfd, 1U, 1000); // NOLINT(*-magic-numbers)
+        assert(ready == 1);
+        assert(latest(reader) == 1);
+        reader.disarmNotifications();
+
+        fastipc::QueueWriter queue_writer{kQueueName, sizeof(int), kDirect};
+        fastipc::QueueReader queue_reader{kQueueName, sizeof(int), kDirect};
+        auto batch = queue_writer.tryPrepareBatch(1U);
+        *static_cast<int*>(batch.getPayload(0U)) = 1;
+        queue_writer.submit(batch);
+        const auto acquired = queue_reader.acquireBatch(1U);
+        assert(acquired.size() == 1U && *static_cast<const int*>(acquired.getPayload(0U)) == 1);
+        queue_reader.releaseBatch(acquired);
+    }
+
+    // Endpoints racing to create a channel all end up on the same one.
+    {
+        constexpr std::size_t kThreadCount{8U};
+        std::barrier start{static_cast<std::ptrdiff_t>(kThreadCount)};
+        std::vector<std::jthread> threads;
+        // NOLINTNEXTLINE(altera-unroll-loops) Test setup
+        for (std::size_t i{0U}; i < kThreadCount; ++i) {
+            threads.emplace_back([&, i] {
+                start.arrive_and_wait();
+                fastipc::Writer writer{kRacedName, sizeof(int), kDirect};
+                publish(writer, static_cast<int>(i));
+            });
+        }
+        threads.clear();
+
+        const fastipc::Reader reader{kRacedName, sizeof(int), kDirect};
+        int value{0};
+        [[maybe_unused]] const auto sequence_id = reader.readLatest(&value, sizeof(value));
+        assert(sequence_id == kThreadCount);
+    }
+
+    // A tower takes over the channels created without it, freeing those nobody uses anymore.
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+    assert(!isPinned(kChannelName) && !isPinned(kRacedName) && !isPinned(kQueueName));
+
+    // Directly attached endpoints share channels with those opened through the tower, whoever comes first.
+    {
+        fastipc::Writer tower_writer{kTowerFirstName, sizeof(int)};
+        fastipc::Reader direct_reader{kTowerFirstName, sizeof(int), kDirect};
+        publish(tower_writer, 1);
+        assert(latest(direct_reader) == 1);
+
+        fastipc::Writer direct_writer{kDirectFirstName, sizeof(int), kDirect};
+        fastipc::Reader tower_reader{kDirectFirstName, sizeof(int)};
+        publish(direct_writer, 2);
+        assert(latest(tower_reader) == 2);
+
+        const auto snapshots = fastipc::inspectTower("fastipcd");
+        assert(snapshots.has_value());
+        const auto channel = std::ranges::find(*snapshots, kDirectFirstName, &fastipc::ChannelSnapshot::name);
+        assert(channel != snapshots->end() && channel->endpoints.size() == 2U);
+    }
+
+    // Notifications cross between processes whichever way their endpoints are attached, without tracing either.
+    {
+        std::array<int, 2U> to_child{};
+        std::array<int, 2U> to_parent{};
+        [[maybe_unused]] const auto piped = ::pipe(to_child.data()) == 0 && ::pipe(to_parent.data()) == 0;
+        assert(piped);
+
+        fastipc::Reader tower_reader{kForkedName, sizeof(int)};
+        tower_reader.armNotifications();
+
+        const auto child = ::fork();
+        if (child == 0) {
+            // Never outlive a failed parent, which would keep the test runner waiting on our output.
+            ::alarm(10U); // NOLINT(*-magic-numbers)
+            ::close(to_child[1]);
+            ::close(to_parent[0]);
+            char token{0};
+            {
+                fastipc::Writer direct_writer{kForkedName, sizeof(int), kDirect};
+                fastipc::Reader direct_reader{kForkedName, sizeof(int), kDirect};
+                publish(direct_writer, 1);
+
+                // Armed only once the parent got woken up, for it to be the one waking us up next.
+                const bool synced = ::read(to_child[0], &token, 1U) == 1;
+                direct_reader.armNotifications();
+                const bool woken = synced && ::write(to_parent[1], &token, 1U) == 1 &&
+                                   isReady(direct_reader.getNotificationFd()) && latest(direct_reader) == 2;
+                direct_reader.disarmNotifications();
+                if (!woken)
+                    ::_exit(1);
+            }
+            ::_exit(0);
+        }
+
+        ::close(to_child[0]);
+        ::close(to_parent[1]);
+        assert(isReady(tower_reader.getNotificationFd()) && latest(tower_reader) == 1);
+        std::uint64_t count{0U};
+        static_cast<void>(::read(tower_reader.getNotificationFd(), &count, sizeof(count)));
+        tower_reader.disarmNotifications();
+
+        char token{0};
+        [[maybe_unused]] const bool synced =
+            ::write(to_child[1], &token, 1U) == 1 && ::read(to_parent[0], &token, 1U) == 1;
+        assert(synced);
+        fastipc::Writer tower_writer{kForkedName, sizeof(int)};
+        publish(tower_writer, 2);
+
+        int status{0};
+        ::waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        ::close(to_child[1]);
+        ::close(to_parent[0]);
+    }
+
+    // Channels get freed once the last endpoint is gone, however attached.
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    // NOLINTNEXTLINE(altera-unroll-loops) Polled until the deadline
+    while ((isPinned(kTowerFirstName) || isPinned(kDirectFirstName)) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(10ms);
+    assert(!isPinned(kTowerFirstName) && !isPinned(kDirectFirstName));
+
+    tower.shutdown();
+}
@@ -0,0 +1,100 @@
+/*
+ *  history.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+int main() {
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::size_t max_payload_size{sizeof(std::uint64_t)};
+    constexpr std::size_t kDepth{4U};
+
+    const auto publish = [](fastipc::Writer& writer) {
+        auto sample = writer.tryPrepare();
+        assert(sample.has_value());
+        *static_cast<std::uint64_t*>(sample->getPayload()) = sample->getSequenceId();
+        writer.submit(*sample);
+    };
+
+    {
+        constexpr std::string_view channel_name{"Estimator input"};
+        // Room for a reader holding a whole window, plus the latest sample and one being prepared
+        fastipc::Writer writer{channel_name, max_payload_size, {.slot_count = kDepth + 2U, .history_depth = kDepth}};
+        fastipc::Reader reader{channel_name, max_payload_size};
+        std::vector<fastipc::Reader::Sample> window;
+
+        // Only the initial sample exists so far.
+        reader.acquireHistory(kDepth, window);
+        assert(window.size() == 1U && window[0U].getSequenceId() == 0U);
+        reader.release(window[0U]);
+
+        for (std::size_t i{0U}; i < 10U; ++i) // NOLINT(*-magic-numbers)
+            publish(writer);
+
+        reader.acquireHistory(kDepth + 2U, window);
+        assert(window.size() == kDepth);
+        for (std::size_t i{0U}; i < kDepth; ++i) {
+            assert(window[i].getSequenceId() == 7U + i);
+            assert(*static_cast<const std::uint64_t*>(window[i].getPayload()) == 7U + i);
+        }
+
+        // The window stays intact while the writer moves on, never running out of slots.
+        for (std::size_t i{0U}; i < 20U; ++i) // NOLINT(*-magic-numbers)
+            publish(writer);
+        for (std::size_t i{0U}; i < kDepth; ++i)
+            assert(*static_cast<const std::uint64_t*>(window[i].getPayload()) == 7U + i);
+        for (const auto& sample : window)
+            reader.release(sample);
+
+        reader.acquireHistory(2U, window);
+        assert(window.size() == 2U && window[0U].getSequenceId() == 29U && window[1U].getSequenceId() == 30U);
+        for (const auto& sample : window)
+            reader.release(sample);
+
+        // The latest sample is the newest of the history.
+        const auto latest = reader.acquire();
+        assert(latest.getSequenceId() == 30U);
+        reader.release(latest);
+    }
+
+    {
+        // Without history, only the latest sample is acquired.
+        constexpr std::string_view channel_name{"Latest only"};
+        fastipc::Writer writer{channel_name, max_payload_size};
+        fastipc::Reader reader{channel_name, max_payload_size};
+        publish(writer);
+        publish(writer);
+
+        std::vector<fastipc::Reader::Sample> window;
+        reader.acquireHistory(kDepth, window);
+        assert(window.size() == 1U && window[0U].getSequenceId() == 2U);
+        reader.release(window[0U]);
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,125 @@
+/*
+ *  incremental.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::size_t kBlockCount{16U};
+// Leave the last block partial
+constexpr std::size_t kPayloadSize{(kBlockCount * fastipc::kDirtyBlockSize) - 100U}; // NOLINT(*-magic-numbers)
+
+/// Block modified by the writer at the given step
+[[nodiscard]] constexpr std::size_t blockAt(std::size_t step) noexcept { return (step * 7U) % kBlockCount; }
+
+} // namespace
+
+int main() {
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::string_view channel_name{"Occupancy grid"};
+    // Few slots, so that prepared slots are stale by varying amounts
+    fastipc::Writer writer{channel_name, kPayloadSize, {.slot_count = 4U}};
+    fastipc::Reader reader{channel_name, kPayloadSize};
+
+    std::vector<std::byte> state(kPayloadSize);
+    std::vector<std::byte> mirror(kPayloadSize);
+    std::uint64_t mirrored_sequence_id{0U};
+    std::vector<fastipc::ByteRange> ranges;
+
+    // Let a reader mirror the state from the changed ranges alone.
+    for (std::size_t step{0U}; step < 200U; ++step) { // NOLINT(*-magic-numbers)
+        auto sample = writer.prepareFromLatest();
+        assert(std::memcmp(sample.getPayload(), state.data(), kPayloadSize) == 0);
+
+        const auto offset = (blockAt(step) * fastipc::kDirtyBlockSize) + 10U;
+        state[offset] = static_cast<std::byte>(step);
+        static_cast<std::byte*>(sample.getPayload())[offset] = state[offset];
+        writer.markDirty(sample, offset, 1U);
+        writer.submit(sample);
+
+        auto latest = reader.acquire();
+        reader.getChangedRanges(latest, mirrored_sequence_id, ranges);
+        assert(ranges.size() == 1U);
+        assert(ranges[0U].offset == blockAt(step) * fastipc::kDirtyBlockSize);
+        for (const auto& range : ranges)
+            std::memcpy(&mirror[range.offset], static_cast<const std::byte*>(latest.getPayload()) + range.offset,
+                        range.size);
+        mirrored_sequence_id = latest.getSequenceId();
+        reader.release(latest);
+
+        assert(mirror == state);
+    }
+
+    // Changes accumulate when catching up over many samples, and end at the payload's end.
+    {
+        for (std::size_t step{0U}; step < 2U; ++step) {
+            auto sample = writer.prepareFromLatest();
+            writer.markDirty(sample, kPayloadSize - 1U - step, 1U);
+            writer.markDirty(sample, step * fastipc::kDirtyBlockSize, 1U);
+            writer.submit(sample);
+        }
+
+        auto latest = reader.acquire();
+        reader.getChangedRanges(latest, mirrored_sequence_id, ranges);
+        assert(ranges.size() == 2U);
+        assert(ranges[0U].offset == 0U && ranges[0U].size == 2U * fastipc::kDirtyBlockSize);
+        assert(ranges[1U].offset + ranges[1U].size == kPayloadSize);
+        assert(ranges[1U].offset == (kBlockCount - 1U) * fastipc::kDirtyBlockSize);
+
+        reader.getChangedRanges(latest, latest.getSequenceId(), ranges);
+        assert(ranges.empty());
+        reader.release(latest);
+    }
+
+    // Samples prepared from scratch change everything.
+    {
+        auto sample = writer.prepare();
+        std::memset(sample.getPayload(), 0x5a, kPayloadSize); // NOLINT(*-magic-numbers)
+        writer.submit(sample);
+
+        auto latest = reader.acquire();
+        reader.getChangedRanges(latest, latest.getSequenceId() - 1U, ranges);
+        assert(ranges.size() == 1U && ranges[0U].offset == 0U && ranges[0U].size == kPayloadSize);
+        reader.release(latest);
+
+        // Seeding from it copies it all over, yet changes nothing.
+        sample = writer.prepareFromLatest();
+        const std::vector<std::byte> expected(kPayloadSize, std::byte{0x5a}); // NOLINT(*-magic-numbers)
+        assert(std::memcmp(sample.getPayload(), expected.data(), kPayloadSize) == 0);
+        writer.submit(sample);
+
+        latest = reader.acquire();
+        reader.getChangedRanges(latest, latest.getSequenceId() - 1U, ranges);
+        assert(ranges.empty());
+        reader.release(latest);
+    }
+
+    tower.shutdown();
+}
@@ -16,11 +16,26 @@
  *
  */
 
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "io/cursor.hxx"
+#include "channel.hxx"
 #include "fastipc.hxx"
+#include "local_proto.hxx"
 #include "tower.hxx"
 
 int main() {
@@ -31,6 +46,18 @@ int main() {
     constexpr std::string_view channel_name{"Hallowed are the Ori"};
     constexpr std::size_t max_payload_size{sizeof(int)};
 
+    // A client stalling before sending its request must not hold up others.
+    const auto stalled_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    {
+        ::sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, "fastipcd", sizeof("fastipcd"));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        [[maybe_unused]] const auto res =
+            ::connect(stalled_fd, reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr));
+        assert(res == 0);
+    }
+
     fastipc::Writer writer{channel_name, max_payload_size};
     fastipc::Reader reader{channel_name, max_payload_size};
 
@@ -54,5 +81,216 @@ int main() {
         reader.release(sample);
     }
 
+    {
+        int value{0};
+        [[maybe_unused]] const auto sequence_id = reader.readLatest(&value, sizeof(value));
+        assert(sequence_id == 1);
+        assert(value == 5);
+    }
+
+    {
+        constexpr std::string_view small_channel_name{"Hallowed are the few"};
+        fastipc::Writer small_writer{small_channel_name, max_payload_size, {.slot_count = 3U}};
+        fastipc::Reader small_reader{small_channel_name, max_payload_size};
+
+        // Keep recycling the slots around a held sample.
+        auto held = small_reader.acquire();
+        for (int i{0}; i < 10; ++i) { // NOLINT(*-magic-numbers)
+            auto sample = small_writer.prepare();
+            *static_cast<int*>(sample.getPayload()) = i;
+            small_writer.submit(sample);
+
+            auto latest = small_reader.acquire();
+            assert(latest.getSequenceId() == sample.getSequenceId());
+            assert(*static_cast<const int*>(latest.getPayload()) == i);
+            small_reader.release(latest);
+        }
+        small_reader.release(held);
+    }
+
+    {
+        constexpr std::string_view sized_channel_name{"Hallowed are the sized"};
+        constexpr std::size_t kMaxSize{std::size_t{1U} << 20U}; // NOLINT(*-magic-numbers)
+        fastipc::Writer sized_writer{sized_channel_name, kMaxSize};
+        fastipc::Reader sized_reader{sized_channel_name, kMaxSize};
+
+        auto sample = sized_writer.prepare();
+        std::memset(sample.getPayload(), 'a', 3U);
+        sized_writer.submit(sample, 3U);
+
+        auto latest = sized_reader.acquire();
+        assert(latest.getSize() == 3U);
+        sized_reader.release(latest);
+
+        // Only the submitted bytes get copied out.
+        std::array<char, 8U> copy{}; // NOLINT(*-magic-numbers)
+        copy.fill('b');
+        std::size_t payload_size{0U};
+        static_cast<void>(sized_reader.readLatest(copy.data(), copy.size(), payload_size));
+        assert(payload_size == 3U);
+        assert(std::string_view(copy.data(), copy.size()) == "aaabbbbb");
+
+        sample = sized_writer.prepare();
+        sized_writer.submit(sample);
+        static_cast<void>(sized_reader.readLatest(copy.data(), copy.size(), payload_size));
+        assert(payload_size == kMaxSize);
+    }
+
+    {
+        struct Pose {
+            double x, y, theta;
+        };
+
+        constexpr std::string_view typed_channel_name{"Hallowed are the typed"};
+        fastipc::TypedWriter<Pose> typed_writer{typed_channel_name};
+        fastipc::TypedReader<Pose> typed_reader{typed_channel_name};
+
+        auto sample = typed_writer.prepare();
+        *sample = Pose{.x = 1.0, .y = 2.0, .theta = 3.0}; // NOLINT(*-magic-numbers)
+        typed_writer.submit(sample);
+
+        auto latest = typed_reader.acquire();
+        assert(latest.getSequenceId() == sample.getSequenceId());
+        assert(latest->y == 2.0); // NOLINT(*-magic-numbers)
+        typed_reader.release(latest);
+    }
+
+    {
+        // Huge pages are likely unavailable here, which must fall back gracefully.
+        constexpr std::string_view huge_channel_name{"Hallowed are the huge"};
+        constexpr fastipc::ChannelOptions kOptions{
+            .page_backing = fastipc::PageBacking::HugeTlb, .prefault = true, .lock_memory = true};
+        fastipc::Writer huge_writer{huge_channel_name, max_payload_size, kOptions};
+        fastipc::Reader huge_reader{huge_channel_name, max_payload_size, kOptions};
+
+        auto sample = huge_writer.prepare();
+        *static_cast<int*>(sample.getPayload()) = 7; // NOLINT(*-magic-numbers)
+        huge_writer.submit(sample);
+
+        int value{0};
+        static_cast<void>(huge_reader.readLatest(&value, sizeof(value)));
+        assert(value == 7);
+    }
+
+    {
+        // More channels than fit into a single round trip.
+        constexpr std::size_t kBatchedChannelCount{100U}; // NOLINT(*-magic-numbers)
+        std::vector<std::string> names;
+        std::vector<fastipc::ChannelRequest> requests;
+        names.reserve(kBatchedChannelCount);
+        for (std::size_t i{0U}; i < kBatchedChannelCount; ++i) {
+            names.push_back(std::format("Hallowed are the batched {}", i));
+            requests.push_back({.channel_name = names.back(), .max_payload_size = max_payload_size});
+        }
+
+        fastipc::Session session;
+        auto writers = session.openWriters(requests);
+        auto readers = session.openReaders(requests);
+        assert(writers.size() == kBatchedChannelCount && readers.size() == kBatchedChannelCount);
+
+        for (std::size_t i{0U}; i < kBatchedChannelCount; ++i) {
+            auto sample = writers[i].prepare();
+            *static_cast<int*>(sample.getPayload()) = static_cast<int>(i);
+            writers[i].submit(sample);
+        }
+
+        for (std::size_t i{0U}; i < kBatchedChannelCount; ++i) {
+            int value{-1};
+            static_cast<void>(readers[i].readLatest(&value, sizeof(value)));
+            assert(value == static_cast<int>(i));
+        }
+
+        // Later opens go through the same connection.
+        auto late_reader = session.openReader(names.back(), max_payload_size);
+        int value{-1};
+        static_cast<void>(late_reader.readLatest(&value, sizeof(value)));
+        assert(value == static_cast<int>(kBatchedChannelCount - 1U));
+    }
+
+    {
+        // Channels adding up past the largest size get turned down, and the client kept.
+        fastipc::Session session;
+        auto status = fastipc::OpenStatus::Ok;
+        constexpr fastipc::ChannelOptions kOversizedOptions{.slot_count = 256U}; // NOLINT(*-magic-numbers)
+        constexpr std::string_view oversized_name{"Hallowed are the oversized"};
+        const auto oversized_writer =
+            session.tryOpenWriter(oversized_name, fastipc::impl::kMaxPayloadSize, status, kOversizedOptions);
+        assert(!oversized_writer.has_value() && status == fastipc::OpenStatus::ResourceExhausted);
+        static_cast<void>(session.openReader(channel_name, max_payload_size));
+    }
+
+    {
+        // Unversioned requests are still served, here from the stalled client.
+        std::array<std::byte, 128U> buf{}; // NOLINT(*-magic-numbers)
+        std::span<std::byte> sndbuf{buf};
+        fastipc::io::putBuf(sndbuf, fastipc::impl::kLayoutVersion);
+        fastipc::io::putBuf(sndbuf, fastipc::RequesterType::Reader);
+        fastipc::io::putBuf(sndbuf, max_payload_size);
+        fastipc::io::putBuf(sndbuf, std::uint32_t{0U});
+        fastipc::io::putBuf(sndbuf, static_cast<std::uint8_t>(channel_name.size()));
+        fastipc::io::putBuf(sndbuf, std::as_bytes(std::span{channel_name}));
+        [[maybe_unused]] const auto bytes_written = ::write(stalled_fd, buf.data(), buf.size() - sndbuf.size());
+        assert(bytes_written > 0);
+
+        fastipc::TowerReply reply{};
+        ::iovec iov{.iov_base = &reply, .iov_len = sizeof(reply)};
+        alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(2U * sizeof(int))> ctrl{};
+        ::msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.data();
+        msg.msg_controllen = ctrl.size();
+        [[maybe_unused]] const auto bytes_read = ::recvmsg(stalled_fd, &msg, 0);
+        assert(bytes_read == sizeof(reply));
+        assert(reply.status == fastipc::ReplyStatus::Ok);
+
+        std::array<int, 2U> fds{-1, -1};
+        std::memcpy(fds.data(), CMSG_DATA(CMSG_FIRSTHDR(&msg)), sizeof(fds));
+        for (const auto fd : fds)
+            ::close(fd);
+    }
+
+    {
+        // Requests asking for more history than a channel can hold get the client dropped.
+        const auto bounded_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        ::sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, "fastipcd", sizeof("fastipcd"));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        [[maybe_unused]] const auto res =
+            ::connect(bounded_fd, reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr));
+        assert(res == 0);
+
+        constexpr std::string_view deep_name{"Hallowed are the deep"};
+        std::array<std::byte, 128U> buf{}; // NOLINT(*-magic-numbers)
+        std::span<std::byte> sndbuf{buf};
+        fastipc::io::putBuf(sndbuf, fastipc::kProtocolMagic);
+        fastipc::io::putBuf(sndbuf, fastipc::kProtocolVersion);
+        fastipc::io::putBuf(sndbuf, fastipc::MessageKind::Open);
+        fastipc::io::putBuf(sndbuf, std::uint16_t{1U});
+        fastipc::io::putBuf(sndbuf, fastipc::impl::kLayoutVersion);
+        fastipc::io::putBuf(sndbuf, fastipc::RequesterType::Reader);
+        fastipc::io::putBuf(sndbuf, max_payload_size);
+        fastipc::io::putBuf(sndbuf, std::uint32_t{0U});
+        fastipc::io::putBuf(sndbuf, fastipc::PageBacking::Default);
+        fastipc::io::putBuf(sndbuf, fastipc::ChannelKind::Mailbox);
+        fastipc::io::putBuf(sndbuf, static_cast<std::uint32_t>(fastipc::impl::ChannelPage::kMaxHistoryDepth + 1U));
+        fastipc::io::putBuf(sndbuf, fastipc::ChannelClock::System);
+        fastipc::io::putBuf(sndbuf, std::uint32_t{0U});
+        fastipc::io::putBuf(sndbuf, fastipc::kNoNumaNode);
+        fastipc::io::putBuf(sndbuf, std::uint32_t{1U});
+        fastipc::io::putBuf(sndbuf, std::uint32_t{16U}); // NOLINT(*-magic-numbers)
+        fastipc::io::putBuf(sndbuf, static_cast<std::uint8_t>(deep_name.size()));
+        fastipc::io::putBuf(sndbuf, std::as_bytes(std::span{deep_name}));
+        [[maybe_unused]] const auto bytes_written = ::write(bounded_fd, buf.data(), buf.size() - sndbuf.size());
+        assert(bytes_written > 0);
+
+        fastipc::TowerReply reply{};
+        [[maybe_unused]] const auto bytes_read = ::recv(bounded_fd, &reply, sizeof(reply), 0);
+        assert(bytes_read == 0);
+        ::close(bounded_fd);
+    }
+
+    ::close(stalled_fd);
     tower.shutdown();
 }
@@ -0,0 +1,179 @@
+/*
+ *  log.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fastipc.hxx"
+#include "log_reader.hxx"
+
+namespace {
+
+/// Entries logged by the given thread of this process
+[[nodiscard]] std::vector<fastipc::LogEntry> entriesOf(const std::vector<fastipc::LogEntry>& entries,
+                                                       std::int32_t tid) {
+    std::vector<fastipc::LogEntry> found;
+    for (const auto& entry : entries) {
+        if (entry.pid == ::getpid() && entry.tid == tid)
+            found.push_back(entry);
+    }
+    return found;
+}
+
+[[nodiscard]] bool ringExists(std::int32_t tid) {
+    return std::filesystem::exists(std::format("/dev/shm/fastipc-log.{}.{}", ::getpid(), tid));
+}
+
+} // namespace
+
+int main() {
+    // Without any collector running, threads leave no ring behind.
+    {
+        std::int32_t tid{0};
+        std::jthread{[&] {
+            tid = static_cast<std::int32_t>(::gettid());
+            fastipc::Logger{"test"}.log(fastipc::LogLevel::Warning, "nobody is listening");
+            assert(!ringExists(tid));
+        }}.join();
+    }
+
+    // Warnings and errors go to stderr instead, without blocking on it.
+    {
+        std::array<int, 2U> fds{-1, -1};
+        [[maybe_unused]] const auto piped = ::pipe2(fds.data(), O_CLOEXEC | O_NONBLOCK);
+        assert(piped == 0);
+        const auto saved_stderr = ::dup(STDERR_FILENO);
+        ::dup2(fds[1], STDERR_FILENO);
+        fastipc::fallBackToStderr();
+
+        std::jthread{[] {
+            const fastipc::Logger logger{"test"};
+            logger.log(fastipc::LogLevel::Info, "nobody is listening to {}", "information");
+            logger.log(fastipc::LogLevel::Error, "somebody is listening to {} error", 1);
+        }}.join();
+
+        // The read end is left open, for the reopened stderr never to write to a pipe without readers.
+        std::array<char, 256U> buf{}; // NOLINT(*-magic-numbers)
+        const auto bytes_read = ::read(fds[0], buf.data(), buf.size());
+        assert(bytes_read > 0);
+        const std::string_view written{buf.data(), static_cast<std::size_t>(bytes_read)};
+        assert(written.starts_with("error test[") && written.ends_with("] somebody is listening to 1 error\n"));
+
+        fastipc::impl::setLogFallback(nullptr);
+        ::dup2(saved_stderr, STDERR_FILENO);
+        ::close(saved_stderr);
+        ::close(fds[1]);
+    }
+
+    fastipc::setLogLevel(fastipc::LogLevel::Debug);
+    fastipc::LogCollector collector;
+    std::vector<fastipc::LogEntry> entries;
+    std::vector<fastipc::LogDrops> drops;
+    // Start from a clean slate.
+    collector.collect(entries, drops);
+    entries.clear();
+    drops.clear();
+
+    // Arguments of every kind get formatted by the collector, per thread and in order.
+    {
+        std::int32_t tids[2]{}; // NOLINT(*-c-arrays)
+        const auto log = [&](int index) {
+            tids[index] = static_cast<std::int32_t>(::gettid());
+            const fastipc::Logger logger{"test"};
+            const std::string text{"text"};
+            logger.log(fastipc::LogLevel::Info, "thread {}: {} {} {} {:.2f} {} {}", index, true, 'c', -3, 0.5, text,
+                       std::uint64_t{42U});
+            logger.log(fastipc::LogLevel::Error, "{{escaped}} {} and {}", fastipc::LogLevel::Warning);
+            logger.log(fastipc::LogLevel::Debug, "no arguments");
+        };
+        {
+            const std::jthread first{log, 0};
+            const std::jthread second{log, 1};
+        }
+
+        collector.collect(entries, drops);
+        assert(drops.empty());
+        for (int index{0}; index < 2; ++index) {
+            const auto logged = entriesOf(entries, tids[index]);
+            assert(logged.size() == 3U);
+            assert(logged[0].level == fastipc::LogLevel::Info && logged[0].source == "test");
+            assert(logged[0].message == std::format("thread {}: true c -3 0.50 text 42", index));
+            assert(logged[1].level == fastipc::LogLevel::Error);
+            // Fields left without an argument are kept as they are.
+            assert(logged[1].message == "{escaped} 2 and {}");
+            assert(logged[2].level == fastipc::LogLevel::Debug && logged[2].message == "no arguments");
+            assert(logged[0].time <= logged[1].time && logged[1].time <= logged[2].time);
+
+            // Rings of exited threads are removed once drained.
+            assert(!ringExists(tids[index]));
+        }
+        entries.clear();
+    }
+
+    // Records below the log level are left out, without counting as dropped.
+    {
+        fastipc::setLogLevel(fastipc::LogLevel::Info);
+        std::int32_t tid{0};
+        std::jthread{[&] {
+            tid = static_cast<std::int32_t>(::gettid());
+            const fastipc::Logger logger{"test"};
+            logger.log(fastipc::LogLevel::Debug, "left out");
+            logger.log(fastipc::LogLevel::Info, "kept");
+        }}.join();
+        fastipc::setLogLevel(fastipc::LogLevel::Debug);
+
+        collector.collect(entries, drops);
+        const auto logged = entriesOf(entries, tid);
+        assert(drops.empty() && logged.size() == 1U && logged[0].message == "kept");
+        entries.clear();
+    }
+
+    // Records which find the ring full are dropped and counted, leaving those in the ring intact.
+    {
+        constexpr std::uint64_t kRecordCount{100000U};
+        std::int32_t tid{0};
+        std::jthread{[&] {
+            tid = static_cast<std::int32_t>(::gettid());
+            const fastipc::Logger logger{"flood"};
+            for (std::uint64_t i{0U}; i < kRecordCount; ++i)
+                logger.log(fastipc::LogLevel::Info, "record {} of {}", i, std::string_view{"the flood"});
+        }}.join();
+
+        // Records survive their thread until collected.
+        assert(ringExists(tid));
+        collector.collect(entries, drops);
+        assert(!ringExists(tid));
+
+        const auto logged = entriesOf(entries, tid);
+        assert(!logged.empty() && logged.size() < kRecordCount);
+        for (std::size_t i{0U}; i < logged.size(); ++i)
+            assert(logged[i].message == std::format("record {} of the flood", i));
+        assert(drops.size() == 1U && drops[0].tid == tid && drops[0].count == kRecordCount - logged.size());
+    }
+}
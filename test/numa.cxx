@@ -0,0 +1,84 @@
+/*
+ *  numa.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::string_view kBoundName{"Bound are the mailboxes"};
+constexpr std::string_view kLateName{"Late are the writers"};
+constexpr std::string_view kReaderName{"Read are the mailboxes"};
+constexpr std::string_view kMissingName{"Missing are the nodes"};
+
+/// Snapshot of a channel, which must exist
+[[nodiscard]] fastipc::ChannelSnapshot snapshotOf(std::string_view name) {
+    const auto snapshots = fastipc::inspectTower("fastipcd");
+    assert(snapshots.has_value());
+    const auto channel = std::ranges::find(*snapshots, name, &fastipc::ChannelSnapshot::name);
+    assert(channel != snapshots->end());
+    return *channel;
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // Writers get channels bound to the node they ask for, which every machine has a node 0 for.
+    {
+        const fastipc::Writer writer{kBoundName, sizeof(int), {.numa_node = 0}};
+        const auto snapshot = snapshotOf(kBoundName);
+        assert(snapshot.numa_node == 0 && snapshot.resident_node == 0);
+    }
+
+    // Channels opened by readers first get bound once a writer infers its node.
+    {
+        const fastipc::Reader reader{kLateName, sizeof(int)};
+        assert(snapshotOf(kLateName).numa_node == fastipc::kNoNumaNode);
+
+        const fastipc::Writer writer{kLateName, sizeof(int), {.numa_node = fastipc::kLocalNumaNode}};
+        assert(snapshotOf(kLateName).numa_node >= 0);
+
+        // The first writer to bind the channel wins.
+        const fastipc::Writer other_writer{kLateName, sizeof(int), {.numa_node = 1}};
+        assert(snapshotOf(kLateName).numa_node != 1);
+    }
+
+    // Readers have no say.
+    {
+        const fastipc::Reader reader{kReaderName, sizeof(int), {.numa_node = 0}};
+        assert(snapshotOf(kReaderName).numa_node == fastipc::kNoNumaNode);
+    }
+
+    // Nodes missing from the machine leave channels unbound.
+    {
+        const fastipc::Writer writer{kMissingName, sizeof(int), {.numa_node = 1000}}; // NOLINT(*-magic-numbers)
+        assert(snapshotOf(kMissingName).numa_node == fastipc::kNoNumaNode);
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,166 @@
+/*
+ *  queue.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Item {
+    std::size_t writer;
+    std::size_t index;
+};
+
+} // namespace
+
+int main() {
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // Fill a tiny queue up, and check that writers get pushed back rather than overwrite anything.
+    {
+        constexpr std::string_view channel_name{"Back pressure"};
+        fastipc::QueueWriter writer{channel_name, sizeof(Item), {.slot_count = 4U}};
+        fastipc::QueueReader reader{channel_name, sizeof(Item)};
+        assert(!reader.hasData());
+
+        auto batch = writer.tryPrepareBatch(3U);
+        assert(batch.size() == 3U);
+        for (std::size_t i{0U}; i < batch.size(); ++i) {
+            assert(batch.getSequenceId(i) == i + 1U);
+            *static_cast<Item*>(batch.getPayload(i)) = {.writer = 0U, .index = i};
+        }
+        writer.submit(batch);
+        assert(reader.hasData());
+
+        // Only one slot is left.
+        batch = writer.tryPrepareBatch(5U);
+        assert(batch.size() == 1U);
+        *static_cast<Item*>(batch.getPayload(0U)) = {.writer = 0U, .index = 3U};
+        writer.submit(batch);
+
+        assert(writer.tryPrepareBatch(1U).empty());
+        const auto start = std::chrono::steady_clock::now();
+        assert(writer.prepareBatchFor(1U, start + 1ms).empty());
+        assert(std::chrono::steady_clock::now() - start >= 1ms);
+
+        const auto first = reader.acquireBatch(2U);
+        const auto second = reader.acquireBatch(8U);
+        assert(first.size() == 2U && second.size() == 2U);
+        assert(first.getSize(0U) == sizeof(Item));
+        assert(reader.acquireBatch(1U).empty());
+        for (std::size_t i{0U}; i < 4U; ++i) {
+            const auto& held = i < 2U ? first : second;
+            assert(held.getSequenceId(i % 2U) == i + 1U);
+            assert(static_cast<const Item*>(held.getPayload(i % 2U))->index == i);
+        }
+
+        // Slots free up in order, as they get released.
+        assert(writer.tryPrepareBatch(1U).empty());
+        reader.releaseBatch(first);
+        batch = writer.tryPrepareBatch(4U);
+        assert(batch.size() == 2U && batch.getSequenceId(0U) == 5U);
+        batch.setSize(1U, sizeof(std::size_t));
+        writer.submit(batch);
+        reader.releaseBatch(second);
+
+        const auto resized = reader.acquireBatch(2U);
+        assert(resized.getSize(0U) == sizeof(Item) && resized.getSize(1U) == sizeof(std::size_t));
+        reader.releaseBatch(resized);
+    }
+
+    // Samples left unreleased by a reader get delivered to the next one.
+    {
+        constexpr std::string_view channel_name{"Hand over"};
+        fastipc::QueueWriter writer{channel_name, sizeof(Item), {.slot_count = 4U}};
+        writer.submit(writer.tryPrepareBatch(2U));
+
+        {
+            fastipc::QueueReader reader{channel_name, sizeof(Item)};
+            const auto batch = reader.acquireBatch(1U);
+            assert(batch.size() == 1U && batch.getSequenceId(0U) == 1U);
+            reader.releaseBatch(batch);
+            assert(reader.acquireBatch(1U).getSequenceId(0U) == 2U);
+        }
+
+        fastipc::QueueReader reader{channel_name, sizeof(Item)};
+        const auto batch = reader.acquireBatch(4U);
+        assert(batch.size() == 1U && batch.getSequenceId(0U) == 2U);
+        reader.releaseBatch(batch);
+    }
+
+    // Have many writers race to feed a queue, and check that every item arrives in order.
+    {
+        constexpr std::string_view channel_name{"Many to one"};
+        constexpr std::size_t kWriterCount{3U};
+        constexpr std::size_t kItemCount{20000U}; // NOLINT(*-magic-numbers)
+        constexpr std::size_t kMaxBatchSize{5U};
+
+        fastipc::QueueReader reader{channel_name, sizeof(Item), {.slot_count = 16U}};
+
+        std::vector<std::jthread> writer_threads;
+        writer_threads.reserve(kWriterCount);
+        for (std::size_t w{0U}; w < kWriterCount; ++w) {
+            writer_threads.emplace_back([&, w] {
+                fastipc::QueueWriter writer{channel_name, sizeof(Item)};
+                for (std::size_t i{0U}; i < kItemCount;) {
+                    const auto count = std::min(1U + (i % kMaxBatchSize), kItemCount - i);
+                    auto batch = writer.prepareBatchFor(count, std::chrono::steady_clock::now() + 1s);
+                    assert(!batch.empty());
+                    for (std::size_t j{0U}; j < batch.size(); ++j, ++i)
+                        *static_cast<Item*>(batch.getPayload(j)) = {.writer = w, .index = i};
+                    writer.submit(batch);
+                }
+            });
+        }
+
+        std::array<std::size_t, kWriterCount> next_index{};
+        std::uint64_t next_sequence_id{1U};
+        std::size_t received{0U};
+        while (received < kWriterCount * kItemCount) {
+            if (!reader.waitForData(1s))
+                assert(false && "writers stalled");
+
+            const auto batch = reader.acquireBatch(kMaxBatchSize);
+            for (std::size_t i{0U}; i < batch.size(); ++i) {
+                assert(batch.getSequenceId(i) == next_sequence_id++);
+                const auto& item = *static_cast<const Item*>(batch.getPayload(i));
+                assert(item.index == next_index[item.writer]);
+                ++next_index[item.writer];
+                ++received;
+            }
+            reader.releaseBatch(batch);
+        }
+    }
+
+    tower.shutdown();
+}
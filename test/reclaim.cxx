@@ -0,0 +1,134 @@
+/*
+ *  reclaim.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::string_view kMailboxName{"Reclaimed are the mailboxes"};
+constexpr std::string_view kQueueName{"Reclaimed are the queues"};
+
+/// Polls the tower's channels until the predicate holds for them
+[[nodiscard]] bool inspectUntil(const std::function<bool(const std::vector<fastipc::ChannelSnapshot>&)>& predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    // NOLINTNEXTLINE(altera-unroll-loops) Retry loops should not be unrolled
+    for (;;) {
+        const auto snapshots = fastipc::inspectTower("fastipcd");
+        assert(snapshots.has_value());
+        if (predicate(*snapshots))
+            return true;
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(10ms);
+    }
+}
+
+[[nodiscard]] const fastipc::ChannelSnapshot* find(const std::vector<fastipc::ChannelSnapshot>& snapshots,
+                                                   std::string_view name) {
+    const auto channel = std::ranges::find(snapshots, name, &fastipc::ChannelSnapshot::name);
+    return channel == snapshots.end() ? nullptr : &*channel;
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    {
+        fastipc::Writer writer{kMailboxName, sizeof(int), {.slot_count = 3U}};
+        fastipc::QueueWriter queue_writer{kQueueName, sizeof(int), {.slot_count = 4U}};
+
+        // Have a process die with samples, notifications, the reading end of the queue and queue positions held.
+        const auto child = ::fork();
+        if (child == 0) {
+            fastipc::Reader reader{kMailboxName, sizeof(int)};
+            fastipc::Writer child_writer{kMailboxName, sizeof(int)};
+            static_cast<void>(reader.acquire());
+            static_cast<void>(child_writer.prepare());
+            reader.armNotifications();
+
+            fastipc::QueueReader queue_reader{kQueueName, sizeof(int)};
+            fastipc::QueueWriter child_queue_writer{kQueueName, sizeof(int)};
+            if (child_queue_writer.tryPrepareBatch(2U).size() != 2U)
+                ::_exit(EXIT_FAILURE);
+
+            // Skip every destructor.
+            ::_exit(EXIT_SUCCESS);
+        }
+
+        int status{0};
+        [[maybe_unused]] const auto waited = ::waitpid(child, &status, 0);
+        assert(waited == child && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+        // Only our own endpoints are left, and with them the latest sample.
+        [[maybe_unused]] const bool reclaimed = inspectUntil([&](const auto& snapshots) {
+            const auto* const mailbox = find(snapshots, kMailboxName);
+            const auto* const queue = find(snapshots, kQueueName);
+            return mailbox != nullptr && queue != nullptr && mailbox->endpoints.size() == 1U &&
+                   queue->endpoints.size() == 1U;
+        });
+        assert(reclaimed);
+        const auto mailbox = *find(*fastipc::inspectTower("fastipcd"), kMailboxName);
+        assert(mailbox.occupied_slots == 1U);
+        assert(mailbox.armed_count == 0U);
+
+        auto first = writer.tryPrepare();
+        auto second = writer.tryPrepare();
+        assert(first.has_value() && second.has_value());
+        writer.submit(*first);
+        writer.submit(*second);
+
+        // The queue takes a new reader, and moves past the positions abandoned as empty samples.
+        fastipc::QueueReader queue_reader{kQueueName, sizeof(int)};
+        auto batch = queue_writer.tryPrepareBatch(1U);
+        assert(batch.size() == 1U && batch.getSequenceId(0U) == 3U);
+        *static_cast<int*>(batch.getPayload(0U)) = 3;
+        queue_writer.submit(batch);
+
+        const auto received = queue_reader.acquireBatch(4U);
+        assert(received.size() == 3U);
+        assert(received.getSize(0U) == 0U && received.getSize(1U) == 0U);
+        assert(received.getSize(2U) == sizeof(int) && *static_cast<const int*>(received.getPayload(2U)) == 3);
+        queue_reader.releaseBatch(received);
+    }
+
+    // Channels nobody has open get freed.
+    [[maybe_unused]] const bool freed = inspectUntil([](const auto& snapshots) {
+        return find(snapshots, kMailboxName) == nullptr && find(snapshots, kQueueName) == nullptr;
+    });
+    assert(freed);
+
+    tower.shutdown();
+}
@@ -0,0 +1,114 @@
+/*
+ *  restart.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::string_view kChannelName{"Restarted are the mailboxes"};
+constexpr std::string_view kQueueName{"Restarted are the queues"};
+
+void publish(fastipc::Writer& writer, int value) {
+    auto sample = writer.prepare();
+    *static_cast<int*>(sample.getPayload()) = value;
+    writer.submit(sample);
+}
+
+} // namespace
+
+int main() {
+    std::optional<fastipc::Writer> writer;
+    std::optional<fastipc::Reader> reader;
+    std::optional<fastipc::QueueWriter> queue_writer;
+
+    {
+        auto tower = fastipc::Tower::create("fastipcd");
+        const std::jthread tower_thread{[&] { tower.run(); }};
+
+        writer.emplace(kChannelName, sizeof(int));
+        reader.emplace(kChannelName, sizeof(int));
+        reader->armNotifications();
+        publish(*writer, 1);
+
+        queue_writer.emplace(kQueueName, sizeof(int));
+        auto batch = queue_writer->tryPrepareBatch(1U);
+        *static_cast<int*>(batch.getPayload(0U)) = 1;
+        queue_writer->submit(batch);
+
+        // Take the tower down along with its descriptors, as would a crash.
+        tower.shutdown();
+    }
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // New endpoints attach to the channels pinned by the previous tower, missing nothing published through them.
+    {
+        fastipc::Reader late_reader{kChannelName, sizeof(int)};
+        int value{0};
+        static_cast<void>(late_reader.readLatest(&value, sizeof(value)));
+        assert(value == 1);
+
+        fastipc::QueueReader queue_reader{kQueueName, sizeof(int)};
+        const auto batch = queue_reader.acquireBatch(2U);
+        assert(batch.size() == 1U && *static_cast<const int*>(batch.getPayload(0U)) == 1);
+        queue_reader.releaseBatch(batch);
+    }
+
+    // Writers opened since still wake up the readers armed before.
+    {
+        std::uint64_t count{0U};
+        [[maybe_unused]] const auto drained = ::read(reader->getNotificationFd(), &count, sizeof(count));
+        assert(drained == sizeof(count));
+
+        fastipc::Writer late_writer{kChannelName, sizeof(int)};
+        publish(late_writer, 2);
+
+        ::pollfd pollfd{.fd = reader->getNotificationFd(), .events = POLLIN, .revents = 0};
+        [[maybe_unused]] const auto ready = ::poll(&pollfd, 1U, 1000); // NOLINT(*-magic-numbers)
+        assert(ready == 1);
+
+        int value{0};
+        static_cast<void>(reader->readLatest(&value, sizeof(value)));
+        assert(value == 2);
+    }
+
+    // The endpoints of before are still accounted for.
+    const auto snapshots = fastipc::inspectTower("fastipcd");
+    assert(snapshots.has_value());
+    const auto channel = std::ranges::find(*snapshots, kChannelName, &fastipc::ChannelSnapshot::name);
+    assert(channel != snapshots->end() && channel->endpoints.size() == 2U);
+    assert(channel->latest_sequence_id == 2U);
+
+    reader.reset();
+    writer.reset();
+    queue_writer.reset();
+    tower.shutdown();
+}
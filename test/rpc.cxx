@@ -0,0 +1,148 @@
+/*
+ *  rpc.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::string_view kChannelName{"Called are the services"};
+
+/// Serves requests holding a number with its double until asked to stop
+void serve(const std::stop_token& stop) {
+    fastipc::RpcServer server{kChannelName, sizeof(std::uint64_t)};
+    // NOLINTNEXTLINE(altera-unroll-loops) Serving loop
+    while (!stop.stop_requested()) {
+        if (!server.waitForRequests(10ms))
+            continue;
+        // NOLINTNEXTLINE(altera-unroll-loops) Drains the pending requests
+        while (auto call = server.tryAccept()) {
+            assert(call->getSize() == sizeof(std::uint64_t));
+            std::uint64_t value{0U};
+            std::memcpy(&value, call->getPayload(), sizeof(value));
+            value *= 2U;
+            std::memcpy(call->getPayload(), &value, sizeof(value));
+            server.reply(*call, sizeof(value));
+        }
+    }
+}
+
+[[nodiscard]] fastipc::RpcClient::Call prepareValue(fastipc::RpcClient& client, std::uint64_t value) {
+    auto call = client.prepare();
+    std::memcpy(call.getPayload(), &value, sizeof(value));
+    return call;
+}
+
+[[nodiscard]] std::uint64_t replyOf(const fastipc::RpcClient::Call& call) {
+    assert(!call.isDropped() && call.getSize() == sizeof(std::uint64_t));
+    std::uint64_t value{0U};
+    std::memcpy(&value, call.getPayload(), sizeof(value));
+    return value;
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // Concurrent clients get their own replies, correlated to their requests.
+    {
+        fastipc::RpcClient pipelining{kChannelName, sizeof(std::uint64_t)};
+        std::jthread server_thread{[](const std::stop_token& stop) { serve(stop); }};
+
+        constexpr std::size_t kClientCount{4U};
+        constexpr std::uint64_t kCallCount{1000U};
+        std::vector<std::jthread> clients;
+        // NOLINTNEXTLINE(altera-unroll-loops) Test setup
+        for (std::size_t i{0U}; i < kClientCount; ++i) {
+            clients.emplace_back([i] {
+                fastipc::RpcClient client{kChannelName, sizeof(std::uint64_t)};
+                std::uint64_t last_correlation_id{0U};
+                // NOLINTNEXTLINE(altera-unroll-loops) Test loop
+                for (std::uint64_t n{0U}; n < kCallCount; ++n) {
+                    const auto value = (i * kCallCount) + n;
+                    const auto call = prepareValue(client, value);
+                    assert(call.getCorrelationId() > last_correlation_id);
+                    last_correlation_id = call.getCorrelationId();
+
+                    [[maybe_unused]] const bool replied = client.call(call, sizeof(value), 5s);
+                    assert(replied && replyOf(call) == value * 2U);
+                    client.release(call);
+                }
+            });
+        }
+        clients.clear();
+
+        // Calls may be in flight together.
+        std::array<std::optional<fastipc::RpcClient::Call>, 3U> calls{};
+        for (std::uint64_t i{0U}; i < calls.size(); ++i) {
+            calls[i] = prepareValue(pipelining, i + 1U);
+            pipelining.post(*calls[i], sizeof(std::uint64_t));
+        }
+        for (std::uint64_t i{0U}; i < calls.size(); ++i) {
+            [[maybe_unused]] const bool replied = pipelining.waitForReply(*calls[i], 5s);
+            assert(replied && replyOf(*calls[i]) == (i + 1U) * 2U);
+            pipelining.release(*calls[i]);
+        }
+    }
+
+    fastipc::RpcClient client{kChannelName, sizeof(std::uint64_t)};
+
+    // Requests nobody serves time out, and get withdrawn on release.
+    {
+        const auto call = prepareValue(client, 1U);
+        [[maybe_unused]] const bool replied = client.call(call, sizeof(std::uint64_t), 10ms);
+        assert(!replied);
+        client.release(call);
+
+        const fastipc::RpcServer server{kChannelName, sizeof(std::uint64_t)};
+        assert(!server.hasRequests());
+    }
+
+    // Calls left unanswered by a server going away get dropped, waking up their client.
+    {
+        const auto call = prepareValue(client, 1U);
+        client.post(call, sizeof(std::uint64_t));
+        {
+            fastipc::RpcServer server{kChannelName, sizeof(std::uint64_t)};
+            assert(server.hasRequests());
+            [[maybe_unused]] const auto accepted = server.tryAccept();
+            assert(accepted.has_value() && accepted->getCorrelationId() == call.getCorrelationId());
+        }
+        [[maybe_unused]] const bool settled = client.waitForReply(call, 1s);
+        assert(settled && call.isDropped());
+        client.release(call);
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,121 @@
+/*
+ *  stats.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::string_view kChannelName{"Counted are the samples"};
+
+/// Snapshots the channel, unless the tower freed it already
+[[nodiscard]] std::optional<fastipc::ChannelSnapshot> findChannel() {
+    const auto snapshots = fastipc::inspectTower("fastipcd");
+    assert(snapshots.has_value());
+    const auto channel = std::ranges::find(*snapshots, kChannelName, &fastipc::ChannelSnapshot::name);
+    if (channel == snapshots->end())
+        return std::nullopt;
+    return *channel;
+}
+
+[[nodiscard]] fastipc::ChannelSnapshot inspectChannel() {
+    auto channel = findChannel();
+    assert(channel.has_value());
+    return *channel;
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    std::jthread tower_thread{[&] { tower.run(); }};
+
+    {
+        fastipc::Writer writer{kChannelName, sizeof(int), {.slot_count = 3U}};
+        fastipc::Reader reader{kChannelName, sizeof(int)};
+
+        const auto held = reader.acquire();
+
+        for (int i{0}; i < 5; ++i) { // NOLINT(*-magic-numbers)
+            auto sample = writer.prepare();
+            *static_cast<int*>(sample.getPayload()) = i;
+            writer.submit(sample);
+        }
+
+        // Only observing the last of five samples
+        reader.release(reader.acquire());
+
+        // The held sample, the latest one and this one take up all slots.
+        const auto prepared = writer.prepare();
+        assert(!writer.tryPrepare().has_value());
+
+        const auto channel = inspectChannel();
+        assert(channel.slot_count == 3U);
+        assert(channel.occupied_slots == 3U);
+        assert(channel.latest_sequence_id == 5U);
+        assert(channel.endpoints.size() == 2U);
+
+        for (const auto& endpoint : channel.endpoints) {
+            assert(endpoint.alive);
+            if (endpoint.role == fastipc::RequesterType::Writer) {
+                assert(endpoint.prepares == 6U);
+                assert(endpoint.submits == 5U);
+                assert(endpoint.prepare_retries == 1U);
+                assert(endpoint.heldSlots() == 1U);
+            } else {
+                assert(endpoint.acquires == 2U);
+                assert(endpoint.releases == 1U);
+                assert(endpoint.skipped_sequence_ids == 4U);
+                assert(endpoint.heldSlots() == 1U);
+            }
+        }
+
+        writer.submit(prepared);
+        reader.release(held);
+    }
+
+    // Records are given back on destruction, leaving the channel unused.
+    const auto channel = findChannel();
+    assert(!channel.has_value() || channel->endpoints.empty());
+
+    {
+        // Replies count the snapshots left out for their size, for the next page to start after the last one kept.
+        std::vector<fastipc::ChannelSnapshot> snapshots(3U);
+        snapshots[0].name = "Paged are the first";
+        snapshots[1].name = "Paged are the second";
+        snapshots[2].name = "Paged are the third";
+        const auto whole = fastipc::writeChannelSnapshots(snapshots, fastipc::kMaxInspectReplySize);
+        const auto paged = fastipc::writeChannelSnapshots(snapshots, (whole.size() * 2U) / 3U);
+
+        const auto whole_page = fastipc::readChannelSnapshots(whole);
+        assert(whole_page.has_value() && whole_page->channels.size() == 3U && whole_page->remaining_count == 0U);
+        const auto first_page = fastipc::readChannelSnapshots(paged);
+        assert(first_page.has_value() && first_page->channels.size() == 2U && first_page->remaining_count == 1U);
+        assert(first_page->channels.back().name == snapshots[1].name);
+    }
+
+    tower.shutdown();
+}
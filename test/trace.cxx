@@ -0,0 +1,148 @@
+/*
+ *  trace.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+[[nodiscard]] fastipc::ChannelSnapshot inspectChannel(std::string_view name) {
+    const auto snapshots = fastipc::inspectTower("fastipcd");
+    assert(snapshots.has_value());
+    const auto channel = std::ranges::find(*snapshots, name, &fastipc::ChannelSnapshot::name);
+    assert(channel != snapshots->end());
+    return *channel;
+}
+
+[[nodiscard]] std::chrono::nanoseconds steadyNow() { return std::chrono::steady_clock::now().time_since_epoch(); }
+
+/// Whether a latency summary looks like a distribution of the given number of samples
+[[nodiscard]] bool isDistribution(const fastipc::LatencySummary& summary, std::uint64_t count) {
+    return summary.count == count && summary.median <= summary.p99 && summary.p99 <= summary.max;
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // Time stamp counter timestamps are comparable with the steady clock, whether or not the counter is fit for it.
+    {
+        constexpr std::string_view channel_name{"Counted in ticks"};
+        constexpr std::size_t kTraceDepth{8U};
+        const fastipc::ChannelOptions options{.clock = fastipc::ChannelClock::Tsc, .trace_depth = kTraceDepth};
+        fastipc::Writer writer{channel_name, sizeof(int), options};
+        fastipc::Reader reader{channel_name, sizeof(int)};
+
+        for (int i{0}; i < 20; ++i) { // NOLINT(*-magic-numbers)
+            const auto before = steadyNow();
+            auto sample = writer.prepare();
+            *static_cast<int*>(sample.getPayload()) = i;
+            writer.submit(sample);
+            const auto after = steadyNow();
+
+            const auto acquired = reader.acquire();
+            // Leave room for the calibration being off by a little.
+            assert(acquired.getClockTimestamp() >= before - 1ms && acquired.getClockTimestamp() <= after + 1ms);
+            assert(reader.getClockTime() >= acquired.getClockTimestamp());
+            reader.release(acquired);
+        }
+
+        // Only the newest sequence ids remain traced, each acquired once submitted.
+        const auto channel = inspectChannel(channel_name);
+        assert(channel.clock == fastipc::ChannelClock::Tsc || channel.clock == fastipc::ChannelClock::Steady);
+        assert(isDistribution(channel.fill_latency, kTraceDepth));
+        assert(isDistribution(channel.delivery_latency, kTraceDepth));
+        assert(channel.delivery_latency.max < std::chrono::nanoseconds{1s}.count());
+    }
+
+    // Copy-out reads count as acquisitions, and samples left unread only have their fill latency traced.
+    {
+        constexpr std::string_view channel_name{"Read in passing"};
+        fastipc::Writer writer{channel_name, sizeof(int), {.clock = fastipc::ChannelClock::Steady, .trace_depth = 4U}};
+        fastipc::Reader reader{channel_name, sizeof(int)};
+
+        for (int i{0}; i < 3; ++i)
+            writer.submit(writer.prepare());
+        int value{0};
+        assert(reader.readLatest(&value, sizeof(value)) == 3U);
+        writer.submit(writer.prepare());
+
+        const auto channel = inspectChannel(channel_name);
+        assert(channel.clock == fastipc::ChannelClock::Steady);
+        assert(isDistribution(channel.fill_latency, 4U));
+        assert(isDistribution(channel.delivery_latency, 1U));
+
+        // Steady timestamps still convert to the system clock.
+        const auto acquired = reader.acquire();
+        assert(acquired.getClockTimestamp() <= steadyNow());
+        assert(std::chrono::abs(std::chrono::system_clock::now() - acquired.getTimestamp()) < 1s);
+        reader.release(acquired);
+    }
+
+    // The system clock remains the default, and tracing costs nothing unless asked for.
+    {
+        constexpr std::string_view channel_name{"Wall clock"};
+        fastipc::Writer writer{channel_name, sizeof(int)};
+        fastipc::Reader reader{channel_name, sizeof(int)};
+
+        const auto before = std::chrono::system_clock::now();
+        writer.submit(writer.prepare());
+        const auto acquired = reader.acquire();
+        assert(acquired.getTimestamp() >= before && acquired.getTimestamp() <= std::chrono::system_clock::now());
+        assert(acquired.getClockTimestamp() == acquired.getTimestamp().time_since_epoch());
+        reader.release(acquired);
+
+        const auto channel = inspectChannel(channel_name);
+        assert(channel.clock == fastipc::ChannelClock::System);
+        assert(channel.fill_latency.count == 0U && channel.delivery_latency.count == 0U);
+    }
+
+    // Queues trace every sample they deliver.
+    {
+        constexpr std::string_view channel_name{"Traced queue"};
+        fastipc::QueueWriter writer{channel_name, sizeof(int),
+                                    {.clock = fastipc::ChannelClock::Tsc, .trace_depth = 16U}};
+        fastipc::QueueReader reader{channel_name, sizeof(int)};
+
+        const auto before = steadyNow();
+        writer.submit(writer.tryPrepareBatch(3U));
+        const auto batch = reader.acquireBatch(4U);
+        assert(batch.size() == 3U);
+        assert(batch.getClockTimestamp(0U) >= before - 1ms && batch.getClockTimestamp(2U) <= reader.getClockTime());
+        reader.releaseBatch(batch);
+
+        const auto channel = inspectChannel(channel_name);
+        assert(isDistribution(channel.fill_latency, 3U));
+        assert(isDistribution(channel.delivery_latency, 3U));
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,116 @@
+/*
+ *  wakeup.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "tower.hxx"
+
+using namespace std::chrono_literals;
+
+int main() {
+
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    constexpr std::string_view channel_name{"Indeed"};
+    constexpr std::size_t max_payload_size{sizeof(std::chrono::steady_clock::rep)};
+    constexpr std::size_t kIterations{1000U}; // NOLINT(*-magic-numbers)
+
+    fastipc::Writer writer{channel_name, max_payload_size};
+    fastipc::Reader reader{channel_name, max_payload_size};
+
+    // Nothing gets published, so the wait must time out.
+    {
+        const auto start = std::chrono::steady_clock::now();
+        assert(!reader.waitForNewData(0U, 1ms));
+        assert(std::chrono::steady_clock::now() - start >= 1ms);
+    }
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    latencies.reserve(kIterations);
+
+    std::jthread reader_thread{[&] {
+        std::uint64_t sequence_id{0U};
+        for (std::size_t i{0U}; i < kIterations; ++i) {
+            const bool has_new_data = reader.waitForNewData(sequence_id, 1s);
+            const auto now = std::chrono::steady_clock::now();
+            assert(has_new_data);
+            static_cast<void>(has_new_data);
+
+            auto sample = reader.acquire();
+            const auto ticks = *static_cast<const std::chrono::steady_clock::rep*>(sample.getPayload());
+            const auto sent = std::chrono::steady_clock::time_point{std::chrono::steady_clock::duration{ticks}};
+            latencies.push_back(now - sent);
+            assert(sample.getSequenceId() > sequence_id);
+            sequence_id = sample.getSequenceId();
+            reader.release(sample);
+        }
+    }};
+
+    for (std::size_t i{0U}; i < kIterations; ++i) {
+        // Give the reader time to park itself.
+        std::this_thread::sleep_for(100us);
+
+        auto sample = writer.prepare();
+        *static_cast<std::chrono::steady_clock::rep*>(sample.getPayload()) =
+            std::chrono::steady_clock::now().time_since_epoch().count();
+        writer.submit(sample);
+    }
+
+    reader_thread.join();
+
+    std::ranges::sort(latencies);
+    const auto percentile = [&](std::size_t p) { return latencies[(latencies.size() - 1U) * p / 100U]; };
+    std::println("wake-up latency: p50 {}ns, p99 {}ns, max {}ns", percentile(50U).count(), // NOLINT(*-magic-numbers)
+                 percentile(99U).count(), latencies.back().count());                      // NOLINT(*-magic-numbers)
+
+    // Wait on several channels at once through their notification descriptors.
+    {
+        std::vector<fastipc::Writer> writers;
+        std::vector<fastipc::Reader> readers;
+        fastipc::WaitSet wait_set;
+        for (const std::string_view name : {"Kree", "Shol va", "Jaffa"}) {
+            writers.emplace_back(name, max_payload_size);
+            readers.emplace_back(name, max_payload_size);
+        }
+        for (auto& set_reader : readers)
+            wait_set.add(set_reader);
+
+        assert(wait_set.wait(1ms).empty());
+
+        auto sample = writers[1].prepare();
+        writers[1].submit(sample);
+
+        const auto& ready = wait_set.wait(1s);
+        assert(ready.size() == 1U && ready.front() == 1U);
+        assert(readers[1].hasNewData(0U));
+
+        assert(wait_set.wait(1ms).empty());
+    }
+
+    tower.shutdown();
+}
@@ -0,0 +1,127 @@
+/*
+ *  writers.cxx
+ *  Copyright 2025-2026 ItJustWorksTM
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fastipc.hxx"
+#include "inspect.hxx"
+#include "tower.hxx"
+
+namespace {
+
+constexpr std::string_view kOrderedName{"Ordered are the mailboxes"};
+constexpr std::string_view kLanedName{"Laned are the mailboxes"};
+constexpr std::string_view kSparseName{"Sparse are the lanes"};
+
+void publish(fastipc::Writer& writer, fastipc::Writer::Sample sample) {
+    *static_cast<std::uint64_t*>(sample.getPayload()) = sample.getSequenceId();
+    writer.submit(sample);
+}
+
+} // namespace
+
+int main() {
+    auto tower = fastipc::Tower::create("fastipcd");
+    const std::jthread tower_thread{[&] { tower.run(); }};
+
+    // Samples submitted after newer ones get dropped rather than taking their place.
+    {
+        fastipc::Writer slow_writer{kOrderedName, sizeof(std::uint64_t), {.slot_count = 3U}};
+        fastipc::Writer fast_writer{kOrderedName, sizeof(std::uint64_t)};
+        const fastipc::Reader reader{kOrderedName, sizeof(std::uint64_t)};
+
+        const auto slow_sample = slow_writer.prepare();
+        const auto fast_sample = fast_writer.prepare();
+        assert(slow_sample.getSequenceId() < fast_sample.getSequenceId());
+        publish(fast_writer, fast_sample);
+        publish(slow_writer, slow_sample);
+
+        std::uint64_t value{0U};
+        [[maybe_unused]] const auto sequence_id = reader.readLatest(&value, sizeof(value));
+        assert(sequence_id == fast_sample.getSequenceId() && value == sequence_id);
+
+        // The dropped sample's slot is given back, leaving all but the latest free.
+        [[maybe_unused]] const auto first_free = slow_writer.tryPrepare();
+        [[maybe_unused]] const auto second_free = fast_writer.tryPrepare();
+        assert(first_free.has_value() && second_free.has_value() && !slow_writer.tryPrepare().has_value());
+    }
+
+    // Writers on lanes of their own never have readers see time going backwards.
+    {
+        constexpr std::size_t kWriterCount{8U};
+        constexpr std::uint64_t kSubmitCount{20000U};
+
+        const fastipc::Reader reader{kLanedName, sizeof(std::uint64_t), {.writer_lanes = kWriterCount}};
+        const auto snapshots = fastipc::inspectTower("fastipcd");
+        assert(snapshots.has_value());
+        const auto channel = std::ranges::find(*snapshots, kLanedName, &fastipc::ChannelSnapshot::name);
+        // Lanes split the requested slots rather than adding to them.
+        assert(channel != snapshots->end() && channel->slot_count == fastipc::ChannelOptions{}.slot_count);
+
+        std::atomic_bool done{false};
+        std::jthread checker{[&] {
+            std::uint64_t last_sequence_id{0U};
+            // NOLINTNEXTLINE(altera-unroll-loops) Polled until the writers are done
+            while (!done.load(std::memory_order_relaxed)) {
+                std::uint64_t value{0U};
+                const auto sequence_id = reader.readLatest(&value, sizeof(value));
+                assert(sequence_id >= last_sequence_id && value == sequence_id);
+                last_sequence_id = sequence_id;
+            }
+        }};
+
+        std::vector<std::jthread> writers;
+        // NOLINTNEXTLINE(altera-unroll-loops) Test setup
+        for (std::size_t i{0U}; i < kWriterCount; ++i) {
+            writers.emplace_back([] {
+                fastipc::Writer writer{kLanedName, sizeof(std::uint64_t)};
+                // NOLINTNEXTLINE(altera-unroll-loops) Test loop
+                for (std::uint64_t n{0U}; n < kSubmitCount; ++n)
+                    publish(writer, writer.prepare());
+            });
+        }
+        writers.clear();
+        done.store(true, std::memory_order_relaxed);
+    }
+
+    // Lanes beyond the slot count stay empty, their writers claiming slots from the other lanes.
+    {
+        fastipc::Writer first_writer{kSparseName, sizeof(std::uint64_t), {.slot_count = 4U, .writer_lanes = 8U}};
+        fastipc::Writer last_writer{kSparseName, sizeof(std::uint64_t)};
+        const auto snapshots = fastipc::inspectTower("fastipcd");
+        assert(snapshots.has_value());
+        const auto channel = std::ranges::find(*snapshots, kSparseName, &fastipc::ChannelSnapshot::name);
+        assert(channel != snapshots->end() && channel->slot_count == 4U && channel->occupied_slots == 1U);
+
+        // All but the latest sample are free to prepare, whichever lane the writer got.
+        [[maybe_unused]] const auto first_sample = first_writer.tryPrepare();
+        [[maybe_unused]] const auto second_sample = last_writer.tryPrepare();
+        [[maybe_unused]] const auto third_sample = last_writer.tryPrepare();
+        assert(first_sample.has_value() && second_sample.has_value() && third_sample.has_value());
+        assert(!first_writer.tryPrepare().has_value());
+    }
+
+    tower.shutdown();
+}